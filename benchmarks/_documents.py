@@ -0,0 +1,109 @@
+"""Synthetic TOML documents shared by the benchmarks."""
+
+from __future__ import annotations
+
+import random
+
+
+def config_document(instances: int, seed: int = 0) -> str:
+    """A generated service config: comments, strings, numbers, dates and arrays."""
+    rng = random.Random(seed)
+    lines = ["# generated service configuration", ""]
+    for i in range(instances):
+        lines += [
+            "[[servers.instances]]",
+            f"# instance {i}",
+            f'name = "srv-{i:06d}"  # the name',
+            f"port = {1000 + i}",
+            f"weight = {rng.random():.6f}",
+            f"ratio = {rng.uniform(-1e6, 1e6)!r}",
+            f"enabled = {'true' if i % 2 else 'false'}",
+            f"created = 2023-{1 + i % 12:02d}-{1 + i % 28:02d}T{i % 24:02d}:{i % 60:02d}:00Z",
+            f"tags = [\"a\", \"b\", 'c', {i}]",
+            f'meta = {{ owner = "team-{i % 7}", id = 0x{i:04X} }}',
+            "",
+        ]
+    return "\n".join(lines)
+
+
+def numeric_document(rows: int, seed: int = 0) -> str:
+    """Arrays of floats in fixed, scientific and full-precision notation."""
+    rng = random.Random(seed)
+    lines = []
+    for i in range(rows):
+        fixed = ", ".join(f"{rng.uniform(-1e3, 1e3):.4f}" for _ in range(8))
+        sci = ", ".join(f"{rng.uniform(-1, 1) * 10 ** rng.randint(-30, 30):.6e}" for _ in range(8))
+        full = ", ".join(repr(rng.random()) for _ in range(8))
+        lines += [f"[series.s{i}]", f"fixed = [{fixed}]", f"sci = [{sci}]", f"full = [{full}]", ""]
+    return "\n".join(lines)
+
+
+def array_table_document(entries: int) -> str:
+    """Many `[[a.b]]` entries, each with a sub-table and dotted keys."""
+    lines = []
+    for i in range(entries):
+        lines += [
+            "[[servers.instances]]",
+            f'name = "srv-{i:06d}"',
+            f"net.port = {1000 + i % 60000}",
+            f'net.host = "10.0.{i // 256 % 256}.{i % 256}"',
+            "[servers.instances.meta]",
+            f'owner = "team-{i % 7}"',
+            "",
+        ]
+    return "\n".join(lines)
+
+
+def pyproject_document(tools: int) -> str:
+    """A shared pyproject-style file: `[project]`, many `[tool.*]` sections and one `[tool.ourapp]`."""
+    lines = ["[project]", 'name = "shared"', 'version = "1.0"', ""]
+    for i in range(tools):
+        lines += [
+            f"[tool.t{i}]",
+            f'name = "tool {i}"',
+            "items = [",
+            '  "a",',
+            '  ["b", 1],',
+            "]",
+            'text = """',
+            "[not.a.table]",
+            '"""',
+            "nested = { a = 1, b = [1, 2] }",
+            "",
+        ]
+        if i == tools // 2:
+            lines += ["[tool.ourapp]", 'key = "value"', "paths = [\"src\", \"tests\"]", ""]
+    return "\n".join(lines)
+
+
+def registry_document(packages: int) -> str:
+    """A package registry: one top-level `[pkgN]` table, with sub-tables and releases, per package."""
+    lines = ['title = "registry"', ""]
+    for i in range(packages):
+        lines += [
+            f"# package {i}",
+            f"[pkg{i}]",
+            f'name = "pkg{i}"',
+            f'version = "1.{i % 50}.0"',
+            f"deps = [{', '.join(f'{chr(34)}pkg{j}{chr(34)}' for j in range(i % 7))}]",
+            "",
+            f"[pkg{i}.meta]",
+            'description = """',
+            "[not.a.table]",
+            '"""',
+            f"updated = 2024-01-{1 + i % 28:02d}T10:00:00Z",
+            "",
+        ]
+        for r in range(3):
+            lines += [f"[[pkg{i}.release]]", f"version = {r}", f'notes = "release {r}"', ""]
+    return "\n".join(lines)
+
+
+def nested_document(depth: int, width: int) -> str:
+    """Tables nested `depth` levels deep as `[n0.n1...]`, each with `width` keys `k0`, `k1`, ..."""
+    lines = []
+    for d in range(1, depth + 1):
+        lines.append(f"[{'.'.join(f'n{i}' for i in range(d))}]")
+        lines += [f"k{k} = {d * width + k}" for k in range(width)]
+        lines.append("")
+    return "\n".join(lines)
@@ -0,0 +1,39 @@
+"""Time Array.insert(0, ...) and Array.pop(0) on arrays whose elements all have live wrappers.
+
+Usage: python benchmarks/bench_array_insert.py [--sizes N ...] [--number K]
+"""
+
+from __future__ import annotations
+
+import argparse
+import timeit
+
+from _documents import array_table_document
+
+import pytoml11
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--sizes", type=int, nargs="+", default=[1_000, 10_000, 100_000])
+    parser.add_argument("--number", type=int, default=200)
+    args = parser.parse_args()
+
+    for size in args.sizes:
+        doc = pytoml11.loads(array_table_document(size))
+        array = doc["servers"]["instances"]
+        wrappers = [list(entry.value.values()) for entry in array.value]
+
+        def insert_pop() -> None:
+            array.insert(0, pytoml11.Integer(0))
+            array.pop(0)
+
+        elapsed = timeit.timeit(insert_pop, number=args.number)
+        print(  # noqa: T201
+            f"{size:7d} elements, {sum(map(len, wrappers))} live wrappers: "
+            f"{elapsed / args.number * 1e6:.1f} us per insert + pop"
+        )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,33 @@
+"""Time pytoml11.loads on a document with many `[[array.of.tables]]` entries.
+
+Usage: python benchmarks/bench_array_tables.py [--entries N] [--repeat R]
+"""
+
+from __future__ import annotations
+
+import argparse
+import timeit
+
+from _documents import array_table_document
+
+import pytoml11
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--entries", type=int, default=100_000)
+    parser.add_argument("--repeat", type=int, default=3)
+    args = parser.parse_args()
+
+    text = array_table_document(args.entries)
+    size_mb = len(text.encode()) / 1e6
+
+    best = min(timeit.repeat(lambda: pytoml11.loads(text), number=1, repeat=args.repeat))
+    print(  # noqa: T201
+        f"loads: {args.entries} entries, {size_mb:.1f} MB in {best * 1e3:.1f} ms "
+        f"({args.entries / best / 1e3:.0f}k entries/s)"
+    )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,38 @@
+"""Time pytoml11.load_binary against pytoml11.loads on the same document.
+
+Usage: python benchmarks/bench_binary.py [--packages N] [--number K]
+"""
+
+from __future__ import annotations
+
+import argparse
+import timeit
+
+from _documents import registry_document
+
+import pytoml11
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--packages", type=int, default=2000)
+    parser.add_argument("--number", type=int, default=20)
+    args = parser.parse_args()
+
+    text = registry_document(args.packages)
+    data = pytoml11.dump_binary(pytoml11.loads(text))
+    assert pytoml11.dumps(pytoml11.load_binary(data)) == pytoml11.dumps(pytoml11.loads(text))
+
+    parse = timeit.timeit(lambda: pytoml11.loads(text), number=args.number)
+    decode = timeit.timeit(lambda: pytoml11.load_binary(data), number=args.number)
+
+    size_kb = len(text.encode()) / 1e3
+    print(f"loads:       {size_kb:.0f} kB in {parse / args.number * 1e3:.2f} ms")  # noqa: T201
+    print(  # noqa: T201
+        f"load_binary: {len(data) / 1e3:.0f} kB in {decode / args.number * 1e3:.2f} ms"
+        f" ({parse / decode:.1f}x faster)"
+    )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,47 @@
+"""Time repeated pytoml11.load calls on one file with and without the parse cache.
+
+Usage: python benchmarks/bench_cache.py [--packages N] [--number K]
+"""
+
+from __future__ import annotations
+
+import argparse
+import os
+import tempfile
+import timeit
+
+from _documents import registry_document
+
+import pytoml11
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--packages", type=int, default=200)
+    parser.add_argument("--number", type=int, default=200)
+    args = parser.parse_args()
+
+    text = registry_document(args.packages)
+    size_kb = len(text.encode()) / 1e3
+
+    with tempfile.NamedTemporaryFile("w", suffix=".toml", delete=False) as f:
+        f.write(text)
+    try:
+        uncached = timeit.timeit(lambda: pytoml11.load(f.name), number=args.number)
+        pytoml11.set_cache_limit(256 << 20)
+        cached = timeit.timeit(lambda: pytoml11.load(f.name), number=args.number)
+        info = pytoml11.cache_info()
+    finally:
+        pytoml11.set_cache_limit(0)
+        os.unlink(f.name)
+
+    per_call = uncached / args.number * 1e3
+    print(f"load, no cache: {size_kb:.0f} kB in {per_call:.2f} ms")  # noqa: T201
+    print(  # noqa: T201
+        f"load, cached:   {size_kb:.0f} kB in {cached / args.number * 1e3:.2f} ms"
+        f" ({uncached / cached:.1f}x faster, {info.hits} hits, {info.bytes / 1e3:.0f} kB held)"
+    )
+
+
+if __name__ == "__main__":
+    main()
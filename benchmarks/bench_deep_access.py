@@ -0,0 +1,38 @@
+"""Time reading .value of an Integer held at increasing depths in a document.
+
+Usage: python benchmarks/bench_deep_access.py [--depth N] [--width W] [--number K]
+"""
+
+from __future__ import annotations
+
+import argparse
+import timeit
+
+from _documents import nested_document
+
+import pytoml11
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--depth", type=int, default=16)
+    parser.add_argument("--width", type=int, default=12)
+    parser.add_argument("--number", type=int, default=1_000_000)
+    args = parser.parse_args()
+
+    doc = pytoml11.loads(nested_document(args.depth, args.width))
+    key = f"k{args.width - 1}"
+
+    table = doc
+    for d in range(args.depth):
+        table = table[f"n{d}"]
+        if d in (0, args.depth // 2, args.depth - 1):
+            item = table[key]
+            elapsed = timeit.timeit(lambda: item.value, number=args.number)
+            print(  # noqa: T201
+                f"depth {d + 1:3d}: {elapsed / args.number * 1e9:.0f} ns per .value"
+            )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,33 @@
+"""Time deleting every key of a Table, one by one, as the table grows.
+
+Usage: python benchmarks/bench_delitem.py [--sizes N ...]
+"""
+
+from __future__ import annotations
+
+import argparse
+import time
+
+import pytoml11
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--sizes", type=int, nargs="+", default=[1_000, 4_000, 16_000])
+    args = parser.parse_args()
+
+    for size in args.sizes:
+        text = "\n".join(f"[t{i}]\nname = 'entry {i}'\nvalues = [1, 2, 3]\n" for i in range(size))
+        table = pytoml11.loads(text)
+
+        start = time.perf_counter()
+        for i in range(size):
+            del table[f"t{i}"]
+        elapsed = time.perf_counter() - start
+        print(  # noqa: T201
+            f"{size:6d} keys: {elapsed * 1e3:.1f} ms ({elapsed / size * 1e6:.2f} us per delete)"
+        )
+
+
+if __name__ == "__main__":
+    main()
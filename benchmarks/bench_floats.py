@@ -0,0 +1,37 @@
+"""Time pytoml11.loads and pytoml11.dumps on a float-heavy document.
+
+Usage: python benchmarks/bench_floats.py [--rows N] [--repeat R]
+"""
+
+from __future__ import annotations
+
+import argparse
+import timeit
+
+from _documents import numeric_document
+
+import pytoml11
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--rows", type=int, default=20_000)
+    parser.add_argument("--repeat", type=int, default=5)
+    args = parser.parse_args()
+
+    text = numeric_document(args.rows)
+    size_mb = len(text.encode()) / 1e6
+    doc = pytoml11.loads(text)
+
+    best = min(timeit.repeat(lambda: pytoml11.loads(text), number=1, repeat=args.repeat))
+    print(  # noqa: T201
+        f"loads: {size_mb:.1f} MB in {best * 1e3:.1f} ms ({size_mb / best:.1f} MB/s)"
+    )
+    best = min(timeit.repeat(lambda: pytoml11.dumps(doc), number=1, repeat=args.repeat))
+    print(  # noqa: T201
+        f"dumps: {size_mb:.1f} MB in {best * 1e3:.1f} ms ({size_mb / best:.1f} MB/s)"
+    )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,53 @@
+"""Time pytoml11.load(lazy=True) against a full load of a large registry-style file.
+
+Usage: python benchmarks/bench_lazy.py [--packages N] [--repeat R]
+"""
+
+from __future__ import annotations
+
+import argparse
+import os
+import tempfile
+import timeit
+
+from _documents import registry_document
+
+import pytoml11
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--packages", type=int, default=20_000)
+    parser.add_argument("--repeat", type=int, default=5)
+    args = parser.parse_args()
+
+    text = registry_document(args.packages)
+    size_mb = len(text.encode()) / 1e6
+    wanted = f"pkg{args.packages // 2}"
+
+    def read_one() -> None:
+        pytoml11.load(f.name, lazy=True)[wanted]["meta"]
+
+    def read_all() -> None:
+        pytoml11.load(f.name, lazy=True).value
+
+    with tempfile.NamedTemporaryFile("w", suffix=".toml", delete=False) as f:
+        f.write(text)
+    try:
+        full = min(timeit.repeat(lambda: pytoml11.load(f.name), number=1, repeat=args.repeat))
+        one = min(timeit.repeat(read_one, number=1, repeat=args.repeat))
+        every = min(timeit.repeat(read_all, number=1, repeat=args.repeat))
+    finally:
+        os.unlink(f.name)
+
+    print(f"load:                     {size_mb:.1f} MB in {full * 1e3:.1f} ms")  # noqa: T201
+    print(  # noqa: T201
+        f"load(lazy=True), 1 table: {size_mb:.1f} MB in {one * 1e3:.1f} ms ({full / one:.1f}x faster)"
+    )
+    print(  # noqa: T201
+        f"load(lazy=True), all:     {size_mb:.1f} MB in {every * 1e3:.1f} ms"
+    )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,56 @@
+"""Time pytoml11.load_many against a pytoml11.load loop over a directory of generated files.
+
+Usage: python benchmarks/bench_load_many.py [--files F] [--instances N] [--threads T] [--repeat R]
+"""
+
+from __future__ import annotations
+
+import argparse
+import tempfile
+import timeit
+from pathlib import Path
+
+from _documents import config_document
+
+import pytoml11
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--files", type=int, default=2_000)
+    parser.add_argument("--instances", type=int, default=20)
+    parser.add_argument("--threads", type=int, default=None)
+    parser.add_argument("--repeat", type=int, default=3)
+    args = parser.parse_args()
+
+    text = config_document(args.instances)
+    size_mb = len(text.encode()) * args.files / 1e6
+
+    with tempfile.TemporaryDirectory() as tmp:
+        paths = [Path(tmp) / f"config{i}.toml" for i in range(args.files)]
+        for path in paths:
+            path.write_text(text)
+
+        best = min(
+            timeit.repeat(lambda: [pytoml11.load(p) for p in paths], number=1, repeat=args.repeat)
+        )
+        print(  # noqa: T201
+            f"load loop: {args.files} files, {size_mb:.1f} MB in {best * 1e3:.1f} ms "
+            f"({size_mb / best:.1f} MB/s)"
+        )
+
+        best = min(
+            timeit.repeat(
+                lambda: pytoml11.load_many(paths, threads=args.threads),
+                number=1,
+                repeat=args.repeat,
+            )
+        )
+        print(  # noqa: T201
+            f"load_many: {args.files} files, {size_mb:.1f} MB in {best * 1e3:.1f} ms "
+            f"({size_mb / best:.1f} MB/s)"
+        )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,50 @@
+"""Time pytoml11.loads (str and bytes) and pytoml11.load on a generated configuration document.
+
+Usage: python benchmarks/bench_loads.py [--instances N] [--repeat R]
+"""
+
+from __future__ import annotations
+
+import argparse
+import os
+import tempfile
+import timeit
+
+from _documents import config_document
+
+import pytoml11
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--instances", type=int, default=20_000)
+    parser.add_argument("--repeat", type=int, default=5)
+    args = parser.parse_args()
+
+    text = config_document(args.instances)
+    size_mb = len(text.encode()) / 1e6
+
+    best = min(timeit.repeat(lambda: pytoml11.loads(text), number=1, repeat=args.repeat))
+    print(  # noqa: T201
+        f"loads: {size_mb:.1f} MB in {best * 1e3:.1f} ms ({size_mb / best:.1f} MB/s)"
+    )
+
+    data = text.encode()
+    best = min(timeit.repeat(lambda: pytoml11.loads(data), number=1, repeat=args.repeat))
+    print(  # noqa: T201
+        f"loads(bytes): {size_mb:.1f} MB in {best * 1e3:.1f} ms ({size_mb / best:.1f} MB/s)"
+    )
+
+    with tempfile.NamedTemporaryFile("w", suffix=".toml", delete=False) as f:
+        f.write(text)
+    try:
+        best = min(timeit.repeat(lambda: pytoml11.load(f.name), number=1, repeat=args.repeat))
+    finally:
+        os.unlink(f.name)
+    print(  # noqa: T201
+        f"load:  {size_mb:.1f} MB in {best * 1e3:.1f} ms ({size_mb / best:.1f} MB/s)"
+    )
+
+
+if __name__ == "__main__":
+    main()
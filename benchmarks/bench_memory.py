@@ -0,0 +1,77 @@
+"""Measure the resident memory held by a document after pytoml11.load, and the peak
+memory of loading from a file object versus reading it into a str first.
+
+Usage: python benchmarks/bench_memory.py [--instances N]
+"""
+
+from __future__ import annotations
+
+import argparse
+import gc
+import resource
+import sys
+import tempfile
+from pathlib import Path
+
+from _documents import config_document
+
+import pytoml11
+
+
+def peak_mb() -> float:
+    peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    return peak / 1e6 if sys.platform == "darwin" else peak / 1e3
+
+
+def resident_mb() -> float:
+    """Current resident set size. Falls back to the peak where /proc is missing."""
+    statm = Path("/proc/self/statm")
+    if statm.exists():
+        pages = int(statm.read_text().split()[1])
+        return pages * resource.getpagesize() / 1e6
+    return peak_mb()
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--instances", type=int, default=20_000)
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as tmp:
+        path = Path(tmp) / "config.toml"
+        path.write_text(config_document(args.instances))
+        size_mb = path.stat().st_size / 1e6
+
+        # the peak only ever grows: measure the leaner path first, and both
+        # before anything else raises it.
+        before = peak_mb()
+        with path.open("rb") as f:
+            doc = pytoml11.load(f)
+        print(  # noqa: T201
+            f"load(file object): peak grew by {peak_mb() - before:.1f} MB"
+        )
+        del doc
+        gc.collect()
+
+        before = peak_mb()
+        with path.open() as f:
+            doc = pytoml11.loads(f.read())
+        print(  # noqa: T201
+            f"loads(f.read()):   peak grew by {peak_mb() - before:.1f} MB"
+        )
+        del doc
+        gc.collect()
+
+        before = resident_mb()
+        doc = pytoml11.load(str(path))
+        gc.collect()
+        after = resident_mb()
+
+    print(  # noqa: T201
+        f"load: {size_mb:.1f} MB document holds {after - before:.1f} MB resident"
+    )
+    del doc
+
+
+if __name__ == "__main__":
+    main()
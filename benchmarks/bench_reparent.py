@@ -0,0 +1,37 @@
+"""Time moving a table whose descendants all have live wrappers out of a document and back.
+
+Usage: python benchmarks/bench_reparent.py [--sizes N ...] [--number K]
+"""
+
+from __future__ import annotations
+
+import argparse
+import timeit
+
+from _documents import array_table_document
+
+import pytoml11
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--sizes", type=int, nargs="+", default=[1_000, 10_000, 100_000])
+    parser.add_argument("--number", type=int, default=200)
+    args = parser.parse_args()
+
+    for size in args.sizes:
+        doc = pytoml11.loads(array_table_document(size))
+        wrappers = [list(entry.value.values()) for entry in doc["servers"]["instances"].value]
+
+        def pop_setitem() -> None:
+            doc["servers"] = doc.pop("servers")
+
+        elapsed = timeit.timeit(pop_setitem, number=args.number)
+        print(  # noqa: T201
+            f"{size:7d} elements, {sum(map(len, wrappers))} live wrappers: "
+            f"{elapsed / args.number * 1e6:.1f} us per pop + setitem"
+        )
+
+
+if __name__ == "__main__":
+    main()
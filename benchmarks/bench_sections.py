@@ -0,0 +1,46 @@
+"""Time pytoml11.load with only=[...] against a full load of a large pyproject-style file.
+
+Usage: python benchmarks/bench_sections.py [--tools N] [--repeat R]
+"""
+
+from __future__ import annotations
+
+import argparse
+import os
+import tempfile
+import timeit
+
+from _documents import pyproject_document
+
+import pytoml11
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--tools", type=int, default=20_000)
+    parser.add_argument("--repeat", type=int, default=5)
+    args = parser.parse_args()
+
+    text = pyproject_document(args.tools)
+    size_mb = len(text.encode()) / 1e6
+
+    with tempfile.NamedTemporaryFile("w", suffix=".toml", delete=False) as f:
+        f.write(text)
+    try:
+        full = min(timeit.repeat(lambda: pytoml11.load(f.name), number=1, repeat=args.repeat))
+        only = min(
+            timeit.repeat(
+                lambda: pytoml11.load(f.name, only=["tool.ourapp"]), number=1, repeat=args.repeat
+            )
+        )
+    finally:
+        os.unlink(f.name)
+
+    print(f"load:              {size_mb:.1f} MB in {full * 1e3:.1f} ms")  # noqa: T201
+    print(  # noqa: T201
+        f"load(only=[...]): {size_mb:.1f} MB in {only * 1e3:.1f} ms ({full / only:.1f}x faster)"
+    )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,36 @@
+"""Time replacing one existing key of a Table as the table grows.
+
+The cost of `table[key] = value` on an existing key should not depend on the
+number or the size of the other entries.
+
+Usage: python benchmarks/bench_setitem.py [--sizes N ...] [--number K]
+"""
+
+from __future__ import annotations
+
+import argparse
+import timeit
+
+import pytoml11
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--sizes", type=int, nargs="+", default=[100, 1_000, 10_000])
+    parser.add_argument("--number", type=int, default=2_000)
+    args = parser.parse_args()
+
+    for size in args.sizes:
+        text = "\n".join(f"[t{i}]\nname = 'entry {i}'\nvalues = [1, 2, 3]\n" for i in range(size))
+        table = pytoml11.loads(text)
+        key = f"t{size // 2}"
+
+        def replace() -> None:
+            table[key] = pytoml11.Integer(1)
+
+        elapsed = timeit.timeit(replace, number=args.number)
+        print(f"{size:6d} keys: {elapsed / args.number * 1e6:.2f} us per replace")  # noqa: T201
+
+
+if __name__ == "__main__":
+    main()
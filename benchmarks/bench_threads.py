@@ -0,0 +1,48 @@
+"""Time concurrent pytoml11.loads calls on a thread pool to show how parsing scales with threads.
+
+Usage: python benchmarks/bench_threads.py [--instances N] [--documents D] [--threads T] [--repeat R]
+"""
+
+from __future__ import annotations
+
+import argparse
+import os
+import timeit
+from concurrent.futures import ThreadPoolExecutor
+
+from _documents import config_document
+
+import pytoml11
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--instances", type=int, default=2_000)
+    parser.add_argument("--documents", type=int, default=64)
+    parser.add_argument("--threads", type=int, default=os.cpu_count() or 1)
+    parser.add_argument("--repeat", type=int, default=3)
+    args = parser.parse_args()
+
+    text = config_document(args.instances)
+    size_mb = len(text.encode()) * args.documents / 1e6
+
+    counts = [1 << i for i in range(args.threads.bit_length()) if 1 << i < args.threads]
+    single = None
+    for threads in [*counts, args.threads]:
+        with ThreadPoolExecutor(max_workers=threads) as pool:
+
+            def run(pool: ThreadPoolExecutor = pool) -> None:
+                list(pool.map(pytoml11.loads, [text] * args.documents))
+
+            run()  # start the workers outside the timed region
+            best = min(timeit.repeat(run, number=1, repeat=args.repeat))
+
+        single = single or best
+        print(  # noqa: T201
+            f"{threads:3d} threads: {size_mb:.1f} MB in {best * 1e3:.1f} ms "
+            f"({size_mb / best:.1f} MB/s, {single / best:.2f}x)"
+        )
+
+
+if __name__ == "__main__":
+    main()
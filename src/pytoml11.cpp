@@ -3,14 +3,33 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
 #include <filesystem>
+#include <functional>
 #include <iostream>
+#include <istream>
+#include <list>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <streambuf>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#endif
+
 namespace py = pybind11;
 
 class Item;
@@ -41,23 +60,99 @@ class Key {
     Key(std::string key) : index(0), key(key), is_key(true) {}
 };
 
-typedef std::vector<Key> keypath;
+// A document shared by all the Items that point into it. `generation` is
+// bumped by every change that can move, replace or remove a node, which
+// invalidates the node addresses Items cache.
+struct Document {
+    template <typename... Args>
+    explicit Document(Args &&...args) : value(std::forward<Args>(args)...) {}
 
-AnyItem to_py_value(std::shared_ptr<toml::ordered_value> root, keypath &path);
-Item *cast_anyitem_to_item(AnyItem &item);
+    toml::ordered_value value;
+    std::uint64_t generation = 0;
 
-toml::ordered_value *resolve(std::shared_ptr<toml::ordered_value> root, keypath &path) {
-    toml::ordered_value *v = root.get();
-    for (auto &key : path) {
-        if (key.is_key) {
-            v = &v->as_table().at(key.key);
-        } else {
-            v = &v->as_array().at(key.index);
+    // dump() and dumps() format the document with the GIL released, holding
+    // this shared through a DocumentReader. Everything that modifies it holds
+    // it exclusively through a MutationGuard.
+    std::shared_mutex mutex;
+};
+
+// Where an Item is: the root of a document, or a key below the node of its
+// parent. Every Item owns its Location and its children point at it, so
+// moving an Item to another parent or document moves everything below it.
+struct Location {
+    explicit Location(std::shared_ptr<Document> document)
+        : parent(), key(size_t(0)), document(std::move(document)) {}
+    Location(std::shared_ptr<Location> parent, Key key)
+        : parent(std::move(parent)), key(std::move(key)), document() {}
+
+    std::shared_ptr<Location> parent;
+    Key key;
+    std::shared_ptr<Document> document; // at the root only
+
+    Location *root() {
+        Location *l = this;
+        while (l->parent) {
+            l = l->parent.get();
         }
+        return l;
+    }
+
+    Document *root_document() { return root()->document.get(); }
+
+    // Bumped whenever an Item moves. Items below it cannot tell otherwise
+    // that the document they cached a node of may no longer be theirs.
+    static inline std::uint64_t moves = 0;
+};
+
+AnyItem to_py_value(std::shared_ptr<Location> location);
+Item *cast_anyitem_to_item(AnyItem &item);
+
+toml::ordered_value *resolve(const Location &location) {
+    if (!location.parent) {
+        return &location.document->value;
+    }
+    toml::ordered_value *v = resolve(*location.parent);
+    if (location.key.is_key) {
+        return &v->as_table().at(location.key.key);
     }
-    return v;
+    return &v->as_array().at(location.key.index);
 }
 
+// Mutators run with the GIL held, so they never race each other; the lock only
+// waits for formatters of the same document that are already running. A guard
+// must not release the GIL, or another mutator would block on the lock while
+// holding it, so lazy sections are loaded before one is taken. Guards nest:
+// the documents locked are tracked per thread, so a guard never mistakes
+// another thread's lock for its own.
+class MutationGuard {
+  public:
+    explicit MutationGuard(std::shared_ptr<Document> document) {
+        if (std::find(locked.begin(), locked.end(), document.get()) != locked.end()) {
+            return;
+        }
+        document->mutex.lock();
+        locked.push_back(document.get());
+        this->document = std::move(document);
+    }
+    ~MutationGuard() {
+        if (document) {
+            locked.erase(std::find(locked.begin(), locked.end(), document.get()));
+            document->mutex.unlock();
+        }
+    }
+
+    MutationGuard(const MutationGuard &) = delete;
+    MutationGuard &operator=(const MutationGuard &) = delete;
+
+  private:
+    std::shared_ptr<Document> document; // null if an outer guard holds the lock
+
+    static inline thread_local std::vector<Document *> locked;
+};
+
+// The TomlError type registered by the module, for returning errors as values.
+py::handle toml_error_type;
+
 constexpr toml::spec default_spec() {
     toml::spec spec = toml::spec::v(1, 1, 0);
     spec.ext_null_value = true;
@@ -66,17 +161,33 @@ constexpr toml::spec default_spec() {
 
 class Item : public std::enable_shared_from_this<Item> {
   public:
-    std::shared_ptr<toml::ordered_value> root;
-    keypath path;
+    std::shared_ptr<Location> location;
+
+    explicit Item(std::shared_ptr<Location> location) : location(std::move(location)) {}
 
-    explicit Item(std::shared_ptr<toml::ordered_value> root, keypath &path)
-        : root(root), path(path) {}
+    explicit Item(std::shared_ptr<Document> root)
+        : location(std::make_shared<Location>(std::move(root))) {}
 
-    explicit Item(std::shared_ptr<toml::ordered_value> root) : root(root), path({}) {}
+    bool owned() { return location->parent != nullptr; }
 
-    bool owned() { return !path.empty(); }
+    std::shared_ptr<Document> document() { return location->root()->document; }
 
-    toml::ordered_value *toml_value() { return resolve(root, path); }
+    // The node of this Item, resolved again only after an Item moved or the
+    // structure of the document changed. Code running without the GIL must
+    // call resolve() instead, since this updates the cached node.
+    toml::ordered_value *toml_value() {
+        if (node == nullptr || node_moves != Location::moves ||
+            node_generation != node_document->generation) {
+            node_document = location->root_document();
+            node = resolve(*location);
+            node_generation = node_document->generation;
+            node_moves = Location::moves;
+        }
+        return node;
+    }
+
+    // Called after adding, replacing or removing nodes of the document.
+    void structure_changed() { ++location->root_document()->generation; }
 
     std::vector<std::string> const get_comments() {
         std::vector<std::string> the_comments;
@@ -86,18 +197,52 @@ class Item : public std::enable_shared_from_this<Item> {
     }
 
     void set_comments(std::vector<std::string> the_comments) {
+        MutationGuard guard(document());
         toml_value()->comments().clear();
         std::for_each(the_comments.begin(), the_comments.end(),
                       [&](auto &v) { toml_value()->comments().push_back(v); });
     }
 
-    virtual void rewrite(std::shared_ptr<toml::ordered_value> new_root, keypath new_path) {
-        root = new_root;
-        path = new_path;
+    // Whether `other` is this Item or anything below it. Checked before moving
+    // a value into `other`, which would otherwise make the value its own child.
+    bool contains(const Item &other) {
+        for (Location *l = other.location.get(); l != nullptr; l = l->parent.get()) {
+            if (l == location.get()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Moves this Item, with everything below it, to `key` below `parent`.
+    // The node must already be there.
+    void attach(std::shared_ptr<Location> parent, Key key) {
+        location->parent = std::move(parent);
+        location->key = std::move(key);
+        location->document.reset();
+        ++Location::moves;
     }
 
+    // Makes this Item, with everything below it, the root of `document`.
+    void detach(std::shared_ptr<Document> document) {
+        location->parent.reset();
+        location->key = Key(size_t(0));
+        location->document = std::move(document);
+        ++Location::moves;
+    }
+
+    // Parses whatever a document loaded with lazy=True has left unparsed, before
+    // the whole value is read, copied or moved into another document.
+    virtual void materialize() {}
+
     virtual ~Item() = default;
     virtual std::string repr() { return "Item()"; };
+
+  protected:
+    toml::ordered_value *node = nullptr;
+    Document *node_document = nullptr;
+    std::uint64_t node_generation = 0;
+    std::uint64_t node_moves = 0;
 };
 
 class Boolean : public std::enable_shared_from_this<Boolean>, public Item {
@@ -106,14 +251,14 @@ class Boolean : public std::enable_shared_from_this<Boolean>, public Item {
 
     const bool value() { return toml_value()->as_boolean(); }
     std::shared_ptr<Boolean> copy() {
-        std::shared_ptr<toml::ordered_value> value =
-            std::make_shared<toml::ordered_value>(*toml_value());
+        std::shared_ptr<Document> value =
+            std::make_shared<Document>(*toml_value());
         return std::make_shared<Boolean>(value);
     }
 
     static std::shared_ptr<Boolean> from_value(bool value) {
-        std::shared_ptr<toml::ordered_value> toml_value =
-            std::make_shared<toml::ordered_value>(value);
+        std::shared_ptr<Document> toml_value =
+            std::make_shared<Document>(value);
         return std::make_shared<Boolean>(toml_value);
     }
 
@@ -126,14 +271,14 @@ class Integer : public std::enable_shared_from_this<Integer>, public Item {
 
     const std::int64_t value() { return toml_value()->as_integer(); }
     std::shared_ptr<Integer> copy() {
-        std::shared_ptr<toml::ordered_value> value =
-            std::make_shared<toml::ordered_value>(*toml_value());
+        std::shared_ptr<Document> value =
+            std::make_shared<Document>(*toml_value());
         return std::make_shared<Integer>(value);
     }
 
     static std::shared_ptr<Integer> from_value(std::int64_t value) {
-        std::shared_ptr<toml::ordered_value> toml_value =
-            std::make_shared<toml::ordered_value>(value);
+        std::shared_ptr<Document> toml_value =
+            std::make_shared<Document>(value);
         return std::make_shared<Integer>(toml_value);
     }
 
@@ -146,14 +291,14 @@ class Float : public std::enable_shared_from_this<Float>, public Item {
 
     const double value() { return toml_value()->as_floating(); }
     std::shared_ptr<Float> copy() {
-        std::shared_ptr<toml::ordered_value> value =
-            std::make_shared<toml::ordered_value>(*toml_value());
+        std::shared_ptr<Document> value =
+            std::make_shared<Document>(*toml_value());
         return std::make_shared<Float>(value);
     }
 
     static std::shared_ptr<Float> from_value(double value) {
-        std::shared_ptr<toml::ordered_value> toml_value =
-            std::make_shared<toml::ordered_value>(value);
+        std::shared_ptr<Document> toml_value =
+            std::make_shared<Document>(value);
         return std::make_shared<Float>(toml_value);
     }
 
@@ -170,14 +315,14 @@ class String : public std::enable_shared_from_this<String>, public Item {
 
     const std::string value() { return toml_value()->as_string(); }
     std::shared_ptr<String> copy() {
-        std::shared_ptr<toml::ordered_value> value =
-            std::make_shared<toml::ordered_value>(*toml_value());
+        std::shared_ptr<Document> value =
+            std::make_shared<Document>(*toml_value());
         return std::make_shared<String>(value);
     }
 
     static std::shared_ptr<String> from_value(std::string value) {
-        std::shared_ptr<toml::ordered_value> toml_value =
-            std::make_shared<toml::ordered_value>(value);
+        std::shared_ptr<Document> toml_value =
+            std::make_shared<Document>(value);
         return std::make_shared<String>(toml_value);
     }
 
@@ -197,17 +342,16 @@ class Date : public std::enable_shared_from_this<Date>, public Item {
     using Item::Item;
 
     py::object value() {
+        const auto &date = toml_value()->as_local_date();
         return py::module::import("datetime")
-            .attr("date")(toml_value()->as_local_date().year,
-                          1 + toml_value()
-                                  ->as_local_date()
-                                  .month, // month_t is 0-indexed, python is 1-indexed
-                          toml_value()->as_local_date().day);
+            .attr("date")(date.year,
+                          1 + date.month, // month_t is 0-indexed, python is 1-indexed
+                          date.day);
     }
 
     std::shared_ptr<Date> copy() {
-        std::shared_ptr<toml::ordered_value> value =
-            std::make_shared<toml::ordered_value>(*toml_value());
+        std::shared_ptr<Document> value =
+            std::make_shared<Document>(*toml_value());
         return std::make_shared<Date>(value);
     }
 
@@ -216,7 +360,7 @@ class Date : public std::enable_shared_from_this<Date>, public Item {
             throw py::type_error("Value is not a datetime.date object");
         }
 
-        std::shared_ptr<toml::ordered_value> toml_value = std::make_shared<toml::ordered_value>(
+        std::shared_ptr<Document> toml_value = std::make_shared<Document>(
             toml::local_date(value.attr("year").cast<int>(),
                              (toml::month_t)(value.attr("month").cast<int>() -
                                              1), // month_t is 0-indexed, python is 1-indexed
@@ -225,11 +369,11 @@ class Date : public std::enable_shared_from_this<Date>, public Item {
     }
 
     std::string repr() {
+        const auto &date = toml_value()->as_local_date();
         std::ostringstream oss;
-        oss << "Date(" << std::to_string(toml_value()->as_local_date().year) << "-" << std::setw(2)
-            << std::setfill('0') << std::to_string(toml_value()->as_local_date().month + 1) << "-"
-            << std::setw(2) << std::setfill('0')
-            << std::to_string(toml_value()->as_local_date().day) << ")";
+        oss << "Date(" << std::to_string(date.year) << "-" << std::setw(2) << std::setfill('0')
+            << std::to_string(date.month + 1) << "-" << std::setw(2) << std::setfill('0')
+            << std::to_string(date.day) << ")";
         return oss.str();
     }
 };
@@ -239,18 +383,17 @@ class Time : public std::enable_shared_from_this<Time>, public Item {
     using Item::Item;
 
     py::object value() {
+        const auto &time = toml_value()->as_local_time();
         return py::module::import("datetime")
-            .attr("time")(toml_value()->as_local_time().hour, toml_value()->as_local_time().minute,
-                          toml_value()->as_local_time().second,
-                          ((uint32_t)toml_value()->as_local_time().millisecond) * 1000 +
-                              ((uint32_t)toml_value()->as_local_time().microsecond));
+            .attr("time")(time.hour, time.minute, time.second,
+                          ((uint32_t)time.millisecond) * 1000 + ((uint32_t)time.microsecond));
     }
 
     uint16_t nanoseconds() { return toml_value()->as_local_time().nanosecond; }
 
     std::shared_ptr<Time> copy() {
-        std::shared_ptr<toml::ordered_value> value =
-            std::make_shared<toml::ordered_value>(*toml_value());
+        std::shared_ptr<Document> value =
+            std::make_shared<Document>(*toml_value());
         return std::make_shared<Time>(value);
     }
 
@@ -259,8 +402,8 @@ class Time : public std::enable_shared_from_this<Time>, public Item {
             throw py::type_error("Value is not a datetime.time object");
         }
 
-        std::shared_ptr<toml::ordered_value> toml_value =
-            std::make_shared<toml::ordered_value>(toml::local_time(
+        std::shared_ptr<Document> toml_value =
+            std::make_shared<Document>(toml::local_time(
                 value.attr("hour").cast<int>(), value.attr("minute").cast<int>(),
                 value.attr("second").cast<int>(), value.attr("microsecond").cast<int>() / 1000,
                 value.attr("microsecond").cast<int>() % 1000));
@@ -273,8 +416,8 @@ class Time : public std::enable_shared_from_this<Time>, public Item {
             throw py::type_error("Value is not a datetime.time object");
         }
 
-        std::shared_ptr<toml::ordered_value> toml_value =
-            std::make_shared<toml::ordered_value>(toml::local_time(
+        std::shared_ptr<Document> toml_value =
+            std::make_shared<Document>(toml::local_time(
                 value.attr("hour").cast<int>(), value.attr("minute").cast<int>(),
                 value.attr("second").cast<int>(), value.attr("microsecond").cast<int>() / 1000,
                 value.attr("microsecond").cast<int>() % 1000, nanoseconds));
@@ -296,43 +439,37 @@ class DateTime : public std::enable_shared_from_this<DateTime>, public Item {
         using namespace pybind11::literals;
         py::object datetime_ = py::module_::import("datetime");
 
-        if (toml_value()->is_offset_datetime()) {
-            py::object py_offset = datetime_.attr("timedelta")(
-                "hours"_a = toml_value()->as_offset_datetime().offset.hour,
-                "minutes"_a = toml_value()->as_offset_datetime().offset.minute);
+        toml::ordered_value *v = toml_value();
+        if (v->is_offset_datetime()) {
+            const auto &dt = v->as_offset_datetime();
+            py::object py_offset = datetime_.attr("timedelta")("hours"_a = dt.offset.hour,
+                                                               "minutes"_a = dt.offset.minute);
             return datetime_.attr("datetime")(
-                toml_value()->as_offset_datetime().date.year,
-                toml_value()->as_offset_datetime().date.month +
-                    1, // month_t is 0-indexed, python is 1-indexed
-                toml_value()->as_offset_datetime().date.day,
-                toml_value()->as_offset_datetime().time.hour,
-                toml_value()->as_offset_datetime().time.minute,
-                toml_value()->as_offset_datetime().time.second,
-                ((uint32_t)toml_value()->as_offset_datetime().time.millisecond) * 1000 +
-                    ((uint32_t)toml_value()->as_offset_datetime().time.microsecond),
+                dt.date.year,
+                dt.date.month + 1, // month_t is 0-indexed, python is 1-indexed
+                dt.date.day, dt.time.hour, dt.time.minute, dt.time.second,
+                ((uint32_t)dt.time.millisecond) * 1000 + ((uint32_t)dt.time.microsecond),
                 "tzinfo"_a = datetime_.attr("timezone")(py_offset));
         }
+        const auto &dt = v->as_local_datetime();
         return datetime_.attr("datetime")(
-            toml_value()->as_local_datetime().date.year,
-            toml_value()->as_local_datetime().date.month +
-                1, // month_t is 0-indexed, python is 1-indexed
-            toml_value()->as_local_datetime().date.day, toml_value()->as_local_datetime().time.hour,
-            toml_value()->as_local_datetime().time.minute,
-            toml_value()->as_local_datetime().time.second,
-            ((uint32_t)toml_value()->as_local_datetime().time.millisecond) * 1000 +
-                ((uint32_t)toml_value()->as_local_datetime().time.microsecond));
+            dt.date.year,
+            dt.date.month + 1, // month_t is 0-indexed, python is 1-indexed
+            dt.date.day, dt.time.hour, dt.time.minute, dt.time.second,
+            ((uint32_t)dt.time.millisecond) * 1000 + ((uint32_t)dt.time.microsecond));
     }
 
     uint16_t nanoseconds() {
-        if (toml_value()->is_offset_datetime()) {
-            return toml_value()->as_offset_datetime().time.nanosecond;
+        toml::ordered_value *v = toml_value();
+        if (v->is_offset_datetime()) {
+            return v->as_offset_datetime().time.nanosecond;
         }
-        return toml_value()->as_local_datetime().time.nanosecond;
+        return v->as_local_datetime().time.nanosecond;
     }
 
     std::shared_ptr<DateTime> copy() {
-        std::shared_ptr<toml::ordered_value> value =
-            std::make_shared<toml::ordered_value>(*toml_value());
+        std::shared_ptr<Document> value =
+            std::make_shared<Document>(*toml_value());
         return std::make_shared<DateTime>(value);
     }
 
@@ -352,8 +489,8 @@ class DateTime : public std::enable_shared_from_this<DateTime>, public Item {
                 throw py::value_error("Cannot represent this timezone.");
             }
 
-            std::shared_ptr<toml::ordered_value> toml_value =
-                std::make_shared<toml::ordered_value>(toml::offset_datetime(
+            std::shared_ptr<Document> toml_value =
+                std::make_shared<Document>(toml::offset_datetime(
                     toml::local_date(
                         value.attr("year").cast<int>(),
                         (toml::month_t)(value.attr("month").cast<uint8_t>() -
@@ -369,8 +506,8 @@ class DateTime : public std::enable_shared_from_this<DateTime>, public Item {
             return std::make_shared<DateTime>(toml_value);
         }
 
-        std::shared_ptr<toml::ordered_value> toml_value =
-            std::make_shared<toml::ordered_value>(toml::local_datetime(
+        std::shared_ptr<Document> toml_value =
+            std::make_shared<Document>(toml::local_datetime(
                 toml::local_date(value.attr("year").cast<int>(),
                                  (toml::month_t)(value.attr("month").cast<uint8_t>() -
                                                  1), // month_t is 0-indexed, python is 1-indexed
@@ -395,52 +532,117 @@ class DateTime : public std::enable_shared_from_this<DateTime>, public Item {
     }
 };
 
+// The top-level tables of a document loaded with lazy=True. The root table
+// holds an empty placeholder for each pending one until it is first read.
+class PendingSections {
+  public:
+    explicit PendingSections(toml::section_index<toml::ordered_type_config> &&index)
+        : index(std::move(index)) {
+        for (size_t i = 0; i < this->index.sections.size(); ++i) {
+            pending.insert({this->index.sections[i].key, i});
+        }
+    }
+
+    toml::section_index<toml::ordered_type_config> index;
+    std::map<std::string, size_t> pending;
+};
+
 class Table : public std::enable_shared_from_this<Table>, public Item {
   protected:
     std::map<std::string, AnyItem> cached_items;
+    std::shared_ptr<PendingSections> lazy;
+
+    // Replaces the placeholder of a pending section with its contents.
+    void load_section(const std::string &key) {
+        auto sections = lazy;
+        auto it = sections->pending.find(key);
+        if (it == sections->pending.end()) {
+            return;
+        }
+        const auto &section = sections->index.sections[it->second];
 
-    void ensure_acceptable_formatting() {
-        bool contains_non_table_value = false;
+        toml::ordered_value value;
+        {
+            py::gil_scoped_release release;
+            value = toml::parse_section(sections->index, section);
+        }
+
+        MutationGuard guard(document());
+        // Another thread may have loaded, replaced or deleted it meanwhile.
+        if (lazy != sections || !forget_section(key)) {
+            return;
+        }
+        toml_value()->as_table().at(key) = std::move(value);
+        structure_changed();
+    }
+
+    // Returns whether the key was pending.
+    bool forget_section(const std::string &key) {
+        if (!lazy || lazy->pending.erase(key) == 0) {
+            return false;
+        }
+        if (lazy->pending.empty()) {
+            lazy.reset();
+        }
+        return true;
+    }
+
+    // Callers that just added a value other than a table pass true, which
+    // saves looking through the others.
+    // Only takes the lock when the format has to change, so constructing
+    // Items never waits for a formatter.
+    void ensure_acceptable_formatting(bool contains_non_table_value = false) {
         bool has_more_than_one_key = toml_value()->as_table().size() > 1;
 
-        for (auto &kv : toml_value()->as_table()) {
-            if (kv.second.type() != toml::value_t::table) {
-                contains_non_table_value = true;
-                break;
+        if (!contains_non_table_value) {
+            for (auto &kv : toml_value()->as_table()) {
+                if (kv.second.type() != toml::value_t::table) {
+                    contains_non_table_value = true;
+                    break;
+                }
             }
         }
 
         auto &formatting = toml_value()->as_table_fmt();
+        auto fmt = formatting.fmt;
 
-        if (formatting.fmt == toml::table_format::implicit && contains_non_table_value) {
-            formatting.fmt = toml::table_format::multiline;
-        } else if (formatting.fmt == toml::table_format::multiline && !contains_non_table_value) {
-            formatting.fmt = toml::table_format::implicit;
+        if (fmt == toml::table_format::implicit && contains_non_table_value) {
+            fmt = toml::table_format::multiline;
+        } else if (fmt == toml::table_format::multiline && !contains_non_table_value) {
+            fmt = toml::table_format::implicit;
+        }
+        if (fmt != formatting.fmt) {
+            MutationGuard guard(document());
+            formatting.fmt = fmt;
         }
     }
 
   public:
-    explicit Table(std::shared_ptr<toml::ordered_value> root, keypath &path)
-        : Item(root, path), cached_items() {
+    explicit Table(std::shared_ptr<Location> location)
+        : Item(location), cached_items() {
             ensure_acceptable_formatting();
         }
 
-    explicit Table(std::shared_ptr<toml::ordered_value> root) : Item(root), cached_items() {
+    explicit Table(std::shared_ptr<Document> root) : Item(root), cached_items() {
         ensure_acceptable_formatting();
     }
 
-    virtual void rewrite(std::shared_ptr<toml::ordered_value> new_root, keypath new_path) {
-        root = new_root;
-        path = new_path;
+    explicit Table(std::shared_ptr<Document> root,
+                   std::shared_ptr<PendingSections> pending)
+        : Table(root) {
+        if (!pending->pending.empty()) {
+            lazy = pending;
+        }
+    }
 
-        for (auto &kv : cached_items) {
-            auto p = keypath(path);
-            p.emplace_back(kv.first);
-            cast_anyitem_to_item(kv.second)->rewrite(root, p);
+    virtual void materialize() {
+        while (lazy) {
+            load_section(lazy->pending.begin()->first);
         }
     }
 
     py::dict value() {
+        materialize();
         py::dict result = py::dict();
         for (
             auto it = toml_value()->as_table().begin();
@@ -453,6 +655,9 @@ class Table : public std::enable_shared_from_this<Table>, public Item {
     }
 
     AnyItem getitem(const std::string &key) {
+        if (lazy) {
+            load_section(key);
+        }
         auto *table = &toml_value()->as_table();
         if (table->find(key) == table->end()) {
             throw py::key_error("Key not found");
@@ -460,9 +665,7 @@ class Table : public std::enable_shared_from_this<Table>, public Item {
         if (cached_items.find(key) != cached_items.end()) {
             return cached_items.at(key);
         }
-        auto p = keypath(path);
-        p.emplace_back(std::string(key));
-        cached_items.insert({key, to_py_value(root, p)});
+        cached_items.insert({key, to_py_value(std::make_shared<Location>(location, Key(key)))});
         return cached_items.at(key);
     }
 
@@ -472,66 +675,58 @@ class Table : public std::enable_shared_from_this<Table>, public Item {
         if (aitem->owned()) {
             throw py::type_error("Value is attached, copy first");
         }
+        if (aitem->contains(*this)) {
+            throw py::value_error("Cannot insert a value into itself");
+        }
+        aitem->materialize();
 
+        MutationGuard guard(document());
+        MutationGuard moved_guard(aitem->document());
+        bool is_table = aitem->toml_value()->is_table();
         auto *table = &toml_value()->as_table();
-        if (table->find(key) != table->end()) {
-            // Need swapping approach to avoid messing up the dict order
+        auto found = table->find(key);
+        if (found != table->end()) {
+            forget_section(key);
+            // The replaced value moves out to the Item that was handed out
+            // for it, if any; the new one takes its place in the order.
             auto itt = cached_items.find(key);
             if (itt != cached_items.end()) {
-                std::shared_ptr<toml::ordered_value> val =
-                    std::make_shared<toml::ordered_value>(table->at(key));
-                Item *aitem = cast_anyitem_to_item(itt->second);
-                aitem->rewrite(val, keypath({}));
+                std::shared_ptr<Document> val =
+                    std::make_shared<Document>(std::move(found->second));
+                cast_anyitem_to_item(itt->second)->detach(val);
                 cached_items.erase(itt);
             }
-
-            toml::ordered_map<std::string, toml::ordered_value> new_table;
-            for (auto &kv : *table) {
-                if (kv.first != key) {
-                    new_table.insert(kv);
-                } else {
-                    new_table.insert({key, std::move(*aitem->root)});
-                }
-            }
-            /// swap
-            table->swap(new_table);
+            found->second = std::move(*aitem->toml_value());
         } else {
-            toml_value()->as_table().push_back({key, std::move(*aitem->root)});
+            table->push_back({key, std::move(*aitem->toml_value())});
         }
+        structure_changed();
 
-        auto p = keypath(path);
-        p.emplace_back(key);
-        aitem->rewrite(root, p);
+        aitem->attach(location, Key(key));
         cached_items.insert({key, item});
-        ensure_acceptable_formatting();
+        ensure_acceptable_formatting(!is_table);
     }
 
     void delitem(const std::string &key) {
+        MutationGuard guard(document());
         auto *table = &toml_value()->as_table();
-        if (table->find(key) == table->end()) {
+        auto found = table->find(key);
+        if (found == table->end()) {
             throw py::key_error("Key not found");
         }
+        forget_section(key);
 
+        // The value moves out to the Item that was handed out for it, if any.
         auto itt = cached_items.find(key);
         if (itt != cached_items.end()) {
-            std::shared_ptr<toml::ordered_value> val =
-                std::make_shared<toml::ordered_value>(table->at(key));
-            Item *aitem = cast_anyitem_to_item(itt->second);
-            aitem->rewrite(val, keypath({}));
+            std::shared_ptr<Document> val =
+                std::make_shared<Document>(std::move(found->second));
+            cast_anyitem_to_item(itt->second)->detach(val);
             cached_items.erase(itt);
         }
 
-        // This function is slightly painful, since erase/remove are not implemented
-        // on the ordered_map. We have to pop_back till we find the key, then push
-        // the popped values back without the key in question.
-        toml::ordered_map<std::string, toml::ordered_value> new_table;
-        for (auto &kv : *table) {
-            if (kv.first != key) {
-                new_table.insert(kv);
-            }
-        }
-        /// swap
-        table->swap(new_table);
+        table->erase(found);
+        structure_changed();
         ensure_acceptable_formatting();
     }
 
@@ -555,7 +750,15 @@ class Table : public std::enable_shared_from_this<Table>, public Item {
                 oss << kv.first;
                 throw py::value_error(oss.str());
             }
+            if (cast_anyitem_to_item(kv.second)->contains(*this)) {
+                throw py::value_error("Cannot insert a value into itself");
+            }
         }
+        for (auto &kv : items) {
+            cast_anyitem_to_item(kv.second)->materialize();
+        }
+
+        MutationGuard guard(document());
         for (auto &kv : items) {
             setitem(kv.first, kv.second);
         }
@@ -565,8 +768,9 @@ class Table : public std::enable_shared_from_this<Table>, public Item {
     size_t size() { return toml_value()->as_table().size(); }
 
     std::shared_ptr<Table> copy() {
-        std::shared_ptr<toml::ordered_value> value =
-            std::make_shared<toml::ordered_value>(*toml_value());
+        materialize();
+        std::shared_ptr<Document> value =
+            std::make_shared<Document>(*toml_value());
         return std::make_shared<Table>(value);
     }
 
@@ -584,7 +788,7 @@ class Table : public std::enable_shared_from_this<Table>, public Item {
         }
 
         std::shared_ptr<Table> table = std::make_shared<Table>(
-            std::make_shared<toml::ordered_value>(std::map<std::string, toml::ordered_value>()));
+            std::make_shared<Document>(std::map<std::string, toml::ordered_value>()));
 
         for (auto v : items) {
             table->setitem(v.first, v.second);
@@ -594,6 +798,7 @@ class Table : public std::enable_shared_from_this<Table>, public Item {
     }
 
     std::string repr() {
+        materialize();
         if (size() == 0) {
             return "Table({})";
         }
@@ -613,8 +818,28 @@ class Table : public std::enable_shared_from_this<Table>, public Item {
 
 class Array : public std::enable_shared_from_this<Array>, public Item {
   protected:
-    std::map<size_t, AnyItem> cached_items;
+    // The wrappers handed out for the elements, by position; null where there
+    // is none. It is either empty or as long as the array.
+    std::vector<AnyItem> cached_items;
 
+    void fill_cache() {
+        if (cached_items.empty()) {
+            cached_items.resize(size());
+        }
+    }
+
+    // Gives the wrappers from `first` on their current positions. The items
+    // below them locate themselves through these, so they are not visited.
+    void renumber(size_t first) {
+        for (size_t i = first; i < cached_items.size(); ++i) {
+            if (Item *child = cast_anyitem_to_item(cached_items[i])) {
+                child->location->key.index = i;
+            }
+        }
+    }
+
+    // Only takes the lock when the format has to change, so constructing
+    // Items never waits for a formatter.
     void ensure_acceptable_formatting() {
         bool contains_non_table_value = false;
         for (auto &kv : toml_value()->as_array()) {
@@ -627,31 +852,21 @@ class Array : public std::enable_shared_from_this<Array>, public Item {
         auto &formatting = toml_value()->as_array_fmt();
 
         if (formatting.fmt == toml::array_format::array_of_tables && contains_non_table_value) {
+            MutationGuard guard(document());
             formatting.fmt = toml::array_format::default_format;
         }
     }
 
   public:
-    explicit Array(std::shared_ptr<toml::ordered_value> root, keypath &path)
-        : Item(root, path), cached_items() {
+    explicit Array(std::shared_ptr<Location> location)
+        : Item(location), cached_items() {
             ensure_acceptable_formatting();
         }
 
-    explicit Array(std::shared_ptr<toml::ordered_value> root) : Item(root), cached_items() {
+    explicit Array(std::shared_ptr<Document> root) : Item(root), cached_items() {
         ensure_acceptable_formatting();
     }
 
-    virtual void rewrite(std::shared_ptr<toml::ordered_value> new_root, keypath new_path) {
-        root = new_root;
-        path = new_path;
-
-        for (auto &kv : cached_items) {
-            auto p = keypath(path);
-            p.emplace_back(kv.first);
-            cast_anyitem_to_item(kv.second)->rewrite(root, p);
-        }
-    }
-
     const std::vector<AnyItem> value() {
         std::vector<AnyItem> result;
         for (size_t i = 0; i < size(); i++) {
@@ -664,13 +879,11 @@ class Array : public std::enable_shared_from_this<Array>, public Item {
         if (index >= size()) {
             throw py::index_error("Index out of range");
         }
-        if (cached_items.find(index) != cached_items.end()) {
-            return cached_items.at(index);
+        fill_cache();
+        if (cast_anyitem_to_item(cached_items[index]) == nullptr) {
+            cached_items[index] = to_py_value(std::make_shared<Location>(location, Key(index)));
         }
-        auto p = keypath(path);
-        p.emplace_back(index);
-        cached_items.insert({index, to_py_value(root, p)});
-        return cached_items.at(index);
+        return cached_items[index];
     }
 
     void append(AnyItem item) {
@@ -678,12 +891,20 @@ class Array : public std::enable_shared_from_this<Array>, public Item {
         if (aitem->owned()) {
             throw py::type_error("Value is attached, copy first");
         }
+        if (aitem->contains(*this)) {
+            throw py::value_error("Cannot insert a value into itself");
+        }
+        aitem->materialize();
+
+        MutationGuard guard(document());
+        MutationGuard moved_guard(aitem->document());
 
-        cached_items.insert({size(), item});
-        auto p = keypath(path);
-        p.emplace_back(size());
-        toml_value()->as_array().emplace_back(*aitem->root);
-        aitem->rewrite(root, p);
+        fill_cache();
+        cached_items.push_back(item);
+        size_t index = size();
+        toml_value()->as_array().emplace_back(std::move(*aitem->toml_value()));
+        structure_changed();
+        aitem->attach(location, Key(index));
         ensure_acceptable_formatting();
     }
 
@@ -692,6 +913,9 @@ class Array : public std::enable_shared_from_this<Array>, public Item {
             if (cast_anyitem_to_item(v)->owned()) {
                 throw py::value_error("Extending list contains owned value");
             }
+            if (cast_anyitem_to_item(v)->contains(*this)) {
+                throw py::value_error("Cannot insert a value into itself");
+            }
         }
 
         for (auto &v : values)
@@ -707,81 +931,59 @@ class Array : public std::enable_shared_from_this<Array>, public Item {
         if (aitem->owned()) {
             throw py::type_error("Value is attached, copy first");
         }
-
-        // Weird loop eh? But:
-        //   Safe when index == 0
-        //   Shifts cache up post insert index
-        //   Modifies path of contained items.
-        for (size_t i = size(); i >= index + 1; --i) {
-            auto it = cached_items.find(i - 1);
-            if (it == cached_items.end())
-                continue;
-
-            auto p = keypath(path);
-            p.emplace_back(i);
-            cast_anyitem_to_item(it->second)->rewrite(root, p);
-            cached_items.insert({i, it->second});
-            cached_items.erase(i - 1);
+        if (aitem->contains(*this)) {
+            throw py::value_error("Cannot insert a value into itself");
         }
-
-        cached_items.insert({index, item});
-        auto p = keypath(path);
-        p.emplace_back(index);
-        toml_value()->as_array().insert(toml_value()->as_array().begin() + index, *aitem->root);
-        aitem->rewrite(root, p);
+        aitem->materialize();
+
+        MutationGuard guard(document());
+        MutationGuard moved_guard(aitem->document());
+
+        fill_cache();
+        cached_items.insert(cached_items.begin() + index, item);
+        renumber(index + 1);
+        toml_value()->as_array().insert(toml_value()->as_array().begin() + index,
+                                        std::move(*aitem->toml_value()));
+        structure_changed();
+        aitem->attach(location, Key(index));
         ensure_acceptable_formatting();
     }
 
     void clear() {
-        for (size_t i = 0; i < size(); ++i) {
-            auto it = cached_items.find(i);
-            if (it == cached_items.end())
-                continue;
-
-            cast_anyitem_to_item(it->second)->rewrite(
-                std::make_shared<toml::ordered_value>(toml_value()->as_array().at(i)),
-                {}
-            );
+        MutationGuard guard(document());
+        auto &vec = toml_value()->as_array();
+        for (size_t i = 0; i < cached_items.size(); ++i) {
+            if (Item *child = cast_anyitem_to_item(cached_items[i])) {
+                child->detach(std::make_shared<Document>(std::move(vec.at(i))));
+            }
         }
         cached_items.clear();
-        toml_value()->as_array().clear();
+        vec.clear();
+        structure_changed();
         ensure_acceptable_formatting();
     }
 
     AnyItem pop(size_t index) {
+        MutationGuard guard(document());
         if (index >= size()) {
             throw py::index_error("Index out of range");
         }
 
         auto *vec = &toml_value()->as_array();
-        AnyItem ret;
+        auto value = std::make_shared<Document>(std::move(vec->at(index)));
+        fill_cache();
+        AnyItem ret = cached_items[index];
 
-        auto it = cached_items.find(index);
-        if (it == cached_items.end()) {
-            auto value = std::make_shared<toml::ordered_value>(std::move(vec->at(index)));
-
-            auto p = keypath({});
-            ret = to_py_value(value, p);
+        if (cast_anyitem_to_item(ret) == nullptr) {
+            ret = to_py_value(std::make_shared<Location>(value));
         } else {
-            auto value = std::make_shared<toml::ordered_value>(std::move(vec->at(index)));
-            ret = it->second;
-            cast_anyitem_to_item(ret)->rewrite(value, {});
-            cached_items.erase(index);
-        }
-
-        for (size_t i = index + 1; i < size(); ++i) {
-            auto it = cached_items.find(i);
-            if (it == cached_items.end())
-                continue;
-
-            auto p = keypath(path);
-            p.emplace_back(i - 1);
-            cast_anyitem_to_item(it->second)->rewrite(root, p);
-            cached_items.insert({i - 1, it->second});
-            cached_items.erase(i);
+            cast_anyitem_to_item(ret)->detach(value);
         }
+        cached_items.erase(cached_items.begin() + index);
+        renumber(index);
 
         vec->erase(vec->begin() + index);
+        structure_changed();
         ensure_acceptable_formatting();
         return ret;
     }
@@ -789,8 +991,8 @@ class Array : public std::enable_shared_from_this<Array>, public Item {
     size_t size() { return toml_value()->as_array().size(); }
 
     std::shared_ptr<Array> copy() {
-        std::shared_ptr<toml::ordered_value> value =
-            std::make_shared<toml::ordered_value>(*toml_value());
+        std::shared_ptr<Document> value =
+            std::make_shared<Document>(*toml_value());
         return std::make_shared<Array>(value);
     }
 
@@ -803,7 +1005,7 @@ class Array : public std::enable_shared_from_this<Array>, public Item {
         }
 
         std::shared_ptr<Array> array = std::make_shared<Array>(
-            std::make_shared<toml::ordered_value>(std::vector<toml::ordered_value>()));
+            std::make_shared<Document>(std::vector<toml::ordered_value>()));
 
         for (auto v : value) {
             array->append(v);
@@ -830,96 +1032,829 @@ class Null : public std::enable_shared_from_this<Null>, public Item {
     using Item::Item;
 
     std::shared_ptr<Null> copy() {
-        std::shared_ptr<toml::ordered_value> value =
-            std::make_shared<toml::ordered_value>(*toml_value());
+        std::shared_ptr<Document> value =
+            std::make_shared<Document>(*toml_value());
         return std::make_shared<Null>(value);
     }
 
     py::none value() { return py::none(); }
 
     static std::shared_ptr<Null> from_value(py::none) {
-        std::shared_ptr<toml::ordered_value> toml_value = std::make_shared<toml::ordered_value>();
+        std::shared_ptr<Document> toml_value = std::make_shared<Document>();
         return std::make_shared<Null>(toml_value);
     }
 
     static std::shared_ptr<Null> from_nothing() {
-        std::shared_ptr<toml::ordered_value> toml_value = std::make_shared<toml::ordered_value>();
+        std::shared_ptr<Document> toml_value = std::make_shared<Document>();
         return std::make_shared<Null>(toml_value);
     }
 
     std::string repr() { return "Null()"; }
 };
 
-AnyItem to_py_value(std::shared_ptr<toml::ordered_value> root, keypath &path) {
-    switch (resolve(root, path)->type()) {
+AnyItem to_py_value(std::shared_ptr<Location> location) {
+    switch (resolve(*location)->type()) {
     case toml::value_t::empty:
-        return {std::make_shared<Null>(root, path)};
+        return {std::make_shared<Null>(location)};
     case toml::value_t::boolean:
-        return {std::make_shared<Boolean>(root, path)};
+        return {std::make_shared<Boolean>(location)};
     case toml::value_t::integer:
-        return {std::make_shared<Integer>(root, path)};
+        return {std::make_shared<Integer>(location)};
     case toml::value_t::floating:
-        return {std::make_shared<Float>(root, path)};
+        return {std::make_shared<Float>(location)};
     case toml::value_t::string:
-        return {std::make_shared<String>(root, path)};
+        return {std::make_shared<String>(location)};
     case toml::value_t::offset_datetime:
-        return {std::make_shared<DateTime>(root, path)};
+        return {std::make_shared<DateTime>(location)};
     case toml::value_t::local_datetime:
-        return {std::make_shared<DateTime>(root, path)};
+        return {std::make_shared<DateTime>(location)};
     case toml::value_t::local_date:
-        return {std::make_shared<Date>(root, path)};
+        return {std::make_shared<Date>(location)};
     case toml::value_t::local_time:
-        return {std::make_shared<Time>(root, path)};
+        return {std::make_shared<Time>(location)};
     case toml::value_t::array:
-        return {std::make_shared<Array>(root, path)};
+        return {std::make_shared<Array>(location)};
     case toml::value_t::table:
-        return {std::make_shared<Table>(root, path)};
+        return {std::make_shared<Table>(location)};
     default:
-        return {std::make_shared<Null>(root, path)};
+        return {std::make_shared<Null>(location)};
     }
 }
 
-AnyItem load(std::string filename) {
-    std::shared_ptr<toml::ordered_value> root = std::make_shared<toml::ordered_value>(
-        std::move(toml::parse<toml::ordered_type_config>(filename, default_spec())));
+// Reading and parsing touch no Python objects, so they run with the GIL
+// released; only wrapping the finished root needs it back.
+AnyItem wrap_document(toml::ordered_value &&value) {
+    std::shared_ptr<Document> root =
+        std::make_shared<Document>(std::move(value));
+    return to_py_value(std::make_shared<Location>(root));
+}
+
+typedef std::vector<std::vector<std::string>> section_list;
+
+// Turns load(..., only=["tool.ourapp"]) into key paths. Entries are dotted
+// keys as written in a TOML file, so `tool."our.app"` works too.
+section_list parse_only(const std::optional<std::vector<std::string>> &only) {
+    section_list result;
+    if (!only) {
+        return result;
+    }
+    if (only->empty()) {
+        throw py::value_error("only must name at least one table");
+    }
+    toml::detail::context<toml::ordered_type_config> ctx(default_spec());
+    for (const auto &entry : *only) {
+        auto loc = toml::detail::make_temporary_location(entry);
+        auto key = toml::detail::parse_key(loc, ctx);
+        if (key.is_err() || !loc.eof()) {
+            throw py::value_error("Invalid key in only: " + entry);
+        }
+        result.push_back(std::move(key.unwrap().first));
+    }
+    return result;
+}
+
+// Parses the key-value pairs of the root table and only locates the others;
+// each top-level table is parsed when Table.__getitem__ first reads it.
+AnyItem load_lazy(std::string filename) {
+    toml::section_index<toml::ordered_type_config> index;
+    {
+        py::gil_scoped_release release;
+        index = toml::index_sections<toml::ordered_type_config>(filename, default_spec());
+    }
+    std::shared_ptr<Document> root =
+        std::make_shared<Document>(std::move(index.root));
+    return {std::make_shared<Table>(root, std::make_shared<PendingSections>(std::move(index)))};
+}
+
+// Tells whether a file changed since it was last seen, without reading it. A
+// file that was replaced or rewritten gets another identity.
+struct FileIdentity {
+    std::uint64_t device = 0;
+    std::uint64_t inode = 0;
+    std::uint64_t size = 0;
+    std::int64_t mtime_ns = 0;
+
+    bool operator==(const FileIdentity &) const = default;
+};
+
+std::optional<FileIdentity> file_identity(const std::filesystem::path &path) {
+#if defined(__unix__) || defined(__APPLE__)
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return std::nullopt;
+    }
+#if defined(__APPLE__)
+    const auto &mtime = st.st_mtimespec;
+#else
+    const auto &mtime = st.st_mtim;
+#endif
+    return FileIdentity{static_cast<std::uint64_t>(st.st_dev),
+                        static_cast<std::uint64_t>(st.st_ino),
+                        static_cast<std::uint64_t>(st.st_size),
+                        static_cast<std::int64_t>(mtime.tv_sec) * 1000000000 + mtime.tv_nsec};
+#else
+    // No inode here; the size and modification time have to do.
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    const auto mtime = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    return FileIdentity{
+        0, 0, static_cast<std::uint64_t>(size),
+        std::chrono::duration_cast<std::chrono::nanoseconds>(mtime.time_since_epoch()).count()};
+#endif
+}
 
-    auto p = keypath({});
-    return std::move(to_py_value(root, p));
+// Roughly the memory held by the nodes and strings of a document. The source
+// text it points into is counted separately.
+std::size_t approximate_size(const toml::ordered_value &value) {
+    std::size_t size = sizeof(toml::ordered_value);
+    for (const auto &comment : value.comments()) {
+        size += sizeof(std::string) + comment.capacity();
+    }
+    if (value.is_string()) {
+        size += value.as_string().capacity();
+    } else if (value.is_array()) {
+        for (const auto &v : value.as_array()) {
+            size += approximate_size(v);
+        }
+    } else if (value.is_table()) {
+        for (const auto &kv : value.as_table()) {
+            size += sizeof(std::string) + kv.first.capacity() + approximate_size(kv.second);
+        }
+    }
+    return size;
 }
 
-AnyItem loads(std::string data) {
-    std::shared_ptr<toml::ordered_value> root = std::make_shared<toml::ordered_value>(
-        std::move(toml::parse_str<toml::ordered_type_config>(data, default_spec())));
+struct CacheInfo {
+    std::size_t hits;
+    std::size_t misses;
+    std::size_t entries;
+    std::size_t bytes;
+    std::size_t max_bytes;
+};
+
+// Parsed files, least recently used first out, for load() to hand out again.
+// It is off until a limit is set. An entry is used only while the file keeps
+// the identity it had when it was parsed, and every hit returns a copy, so
+// documents never share nodes. Callers need not hold the GIL.
+class ParseCache {
+  public:
+    bool enabled() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return max_bytes != 0;
+    }
+
+    std::shared_ptr<const toml::ordered_value> find(const std::string &key,
+                                                    const FileIdentity &id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it == index.end() || it->second->id != id) {
+            misses++;
+            return nullptr;
+        }
+        entries.splice(entries.begin(), entries, it->second);
+        hits++;
+        return it->second->value;
+    }
+
+    void insert(const std::string &key, const FileIdentity &id,
+                std::shared_ptr<const toml::ordered_value> value, std::size_t size) {
+        std::lock_guard<std::mutex> lock(mutex);
+        remove(key);
+        if (size > max_bytes) {
+            return;
+        }
+        entries.push_front({key, id, std::move(value), size});
+        index[key] = entries.begin();
+        bytes += size;
+        shrink(max_bytes);
+    }
 
-    auto p = keypath({});
-    return std::move(to_py_value(root, p));
+    void set_limit(std::size_t limit) {
+        std::lock_guard<std::mutex> lock(mutex);
+        max_bytes = limit;
+        shrink(max_bytes);
+    }
+
+    void invalidate(const std::string &key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        remove(key);
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        shrink(0);
+        hits = 0;
+        misses = 0;
+    }
+
+    CacheInfo info() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return {hits, misses, entries.size(), bytes, max_bytes};
+    }
+
+  private:
+    struct Entry {
+        std::string key;
+        FileIdentity id;
+        std::shared_ptr<const toml::ordered_value> value;
+        std::size_t size;
+    };
+
+    void remove(const std::string &key) {
+        auto it = index.find(key);
+        if (it != index.end()) {
+            bytes -= it->second->size;
+            entries.erase(it->second);
+            index.erase(it);
+        }
+    }
+
+    void shrink(std::size_t limit) {
+        while (bytes > limit) {
+            remove(entries.back().key);
+        }
+    }
+
+    std::mutex mutex;
+    std::list<Entry> entries; // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    std::size_t bytes = 0;
+    std::size_t max_bytes = 0;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+};
+
+// Never destroyed: worker threads may still use it during exit.
+ParseCache &parse_cache() {
+    static ParseCache *cache = new ParseCache();
+    return *cache;
 }
 
-AnyItem load_from_path(std::filesystem::path path) {
-    std::ifstream file(path);
-    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    return loads(data);
+std::string cache_key(const std::filesystem::path &path) {
+    std::error_code ec;
+    auto absolute = std::filesystem::absolute(path, ec);
+    return (ec ? path : absolute).lexically_normal().string();
 }
 
-void dump(AnyItem item, std::string filename) {
-    Item *aitem = cast_anyitem_to_item(item);
+// Parses a file, or copies it out of the parse cache. Call with the GIL
+// released.
+toml::ordered_value parse_path(const std::filesystem::path &path) {
+    ParseCache &cache = parse_cache();
+    std::optional<FileIdentity> id;
+    if (!cache.enabled() || !(id = file_identity(path))) {
+        return toml::parse<toml::ordered_type_config>(path, default_spec());
+    }
+
+    const std::string key = cache_key(path);
+    if (auto cached = cache.find(key, *id)) {
+        return *cached;
+    }
+    // The identity was taken before reading, so a file that changes while
+    // it is parsed is parsed again next time.
+    auto value = std::make_shared<const toml::ordered_value>(
+        toml::parse<toml::ordered_type_config>(path, default_spec()));
+    cache.insert(key, *id, value, static_cast<std::size_t>(id->size) + approximate_size(*value));
+    return *value;
+}
+
+void set_cache_limit(std::size_t max_bytes) { parse_cache().set_limit(max_bytes); }
+
+void clear_cache(std::optional<std::filesystem::path> path) {
+    if (path) {
+        parse_cache().invalidate(cache_key(*path));
+    } else {
+        parse_cache().clear();
+    }
+}
+
+CacheInfo cache_info() { return parse_cache().info(); }
+
+AnyItem load(std::string filename, std::optional<std::vector<std::string>> only, bool lazy) {
+    if (lazy) {
+        if (only) {
+            throw py::value_error("only and lazy cannot be combined");
+        }
+        return load_lazy(filename);
+    }
+    section_list selected = parse_only(only);
+    toml::ordered_value value;
+    {
+        py::gil_scoped_release release;
+        if (selected.empty()) {
+            value = parse_path(filename);
+        } else {
+            value = toml::parse_sections<toml::ordered_type_config>(
+                filename, std::move(selected), default_spec());
+        }
+    }
+    return wrap_document(std::move(value));
+}
+
+// A document in memory owned by a Python object. `owner` keeps the object
+// referenced until the document and every error pointing into it are gone.
+struct BorrowedSource {
+    const char *data;
+    Py_ssize_t size;
+    std::shared_ptr<const void> owner;
+    std::string name;
+};
+
+BorrowedSource borrow_str(py::str data) {
+    // the UTF-8 form is cached in, and owned by, the str object.
+    Py_ssize_t size = 0;
+    const char *utf8 = PyUnicode_AsUTF8AndSize(data.ptr(), &size);
+    if (utf8 == nullptr) {
+        throw py::error_already_set();
+    }
+    std::shared_ptr<const void> owner(new py::object(data), [](py::object *o) {
+        py::gil_scoped_acquire gil;
+        delete o;
+    });
+    return {utf8, size, std::move(owner), "<string>"};
+}
+
+BorrowedSource borrow_buffer(py::buffer data) {
+    // bytes, bytearray, memoryview, ... anything C-contiguous.
+    Py_buffer *view = new Py_buffer();
+    if (PyObject_GetBuffer(data.ptr(), view, PyBUF_SIMPLE) != 0) {
+        delete view;
+        throw py::error_already_set();
+    }
+    if (!view->readonly) {
+        // A bytearray or writable memoryview is often a buffer the caller
+        // reuses, and it cannot be resized while exported. Copy it instead.
+        const char *first = static_cast<const char *>(view->buf);
+        auto copy = std::make_shared<const std::vector<char>>(first, first + view->len);
+        PyBuffer_Release(view);
+        delete view;
+        return {copy->data(), static_cast<Py_ssize_t>(copy->size()), copy, "<bytes>"};
+    }
+    std::shared_ptr<const void> owner(view, [](Py_buffer *v) {
+        py::gil_scoped_acquire gil;
+        PyBuffer_Release(v);
+        delete v;
+    });
+    return {static_cast<const char *>(view->buf), view->len, std::move(owner), "<bytes>"};
+}
+
+// Parses the source in place; call with the GIL released.
+toml::ordered_value parse_borrowed(BorrowedSource source) {
+    return toml::parse<toml::ordered_type_config>(
+        reinterpret_cast<const unsigned char *>(source.data),
+        static_cast<std::size_t>(source.size), std::move(source.owner), std::move(source.name),
+        default_spec());
+}
+
+AnyItem loads_in_place(BorrowedSource source) {
+    toml::ordered_value value;
+    {
+        py::gil_scoped_release release;
+        value = parse_borrowed(std::move(source));
+    }
+    return wrap_document(std::move(value));
+}
+
+AnyItem loads(py::str data) { return loads_in_place(borrow_str(data)); }
+
+AnyItem loads_buffer(py::buffer data) { return loads_in_place(borrow_buffer(data)); }
+
+AnyItem load_from_path(std::filesystem::path path, std::optional<std::vector<std::string>> only,
+                       bool lazy) {
+    if (only || lazy) {
+        return load(path.string(), std::move(only), lazy);
+    }
+    toml::ordered_value value;
+    {
+        py::gil_scoped_release release;
+        value = parse_path(path);
+    }
+    return wrap_document(std::move(value));
+}
+
+// Streams a Python file object into the parser. Binary files are read with
+// readinto(), directly into the memory the parser asks to fill; anything else
+// falls back to read(), encoding str chunks as UTF-8. The stream is read
+// with the GIL released, so it is taken back for every chunk.
+class FileObjectBuf : public std::streambuf {
+  public:
+    explicit FileObjectBuf(py::object file) {
+        if (py::hasattr(file, "readinto")) {
+            readinto = file.attr("readinto");
+        } else if (py::hasattr(file, "read")) {
+            read = file.attr("read");
+        } else {
+            throw py::type_error("Expected a path or a file object with read() or readinto()");
+        }
+    }
+
+  protected:
+    std::streamsize xsgetn(char *s, std::streamsize n) override {
+        std::streamsize total = 0;
+        if (gptr() < egptr()) {
+            total = std::min<std::streamsize>(n, egptr() - gptr());
+            std::memcpy(s, gptr(), static_cast<std::size_t>(total));
+            gbump(static_cast<int>(total));
+        }
+        while (total < n) {
+            std::streamsize got = fill(s + total, n - total);
+            if (got == 0) {
+                break;
+            }
+            total += got;
+        }
+        return total;
+    }
+
+    int_type underflow() override {
+        std::streamsize got = fill(chunk, sizeof(chunk));
+        if (got == 0) {
+            return traits_type::eof();
+        }
+        setg(chunk, chunk, chunk + got);
+        return traits_type::to_int_type(chunk[0]);
+    }
+
+  private:
+    std::streamsize fill(char *s, std::streamsize n) {
+        py::gil_scoped_acquire gil;
+        if (readinto) {
+            auto view = py::memoryview::from_memory(s, static_cast<py::ssize_t>(n));
+            py::object got;
+            try {
+                got = readinto(view);
+            } catch (...) {
+                view.attr("release")();
+                throw;
+            }
+            // the file object must not keep a view of memory it does not own.
+            view.attr("release")();
+            if (got.is_none()) {
+                throw py::value_error("Cannot load from a non-blocking stream with no data");
+            }
+            return got.cast<std::streamsize>();
+        }
+
+        if (pending.empty()) {
+            py::object got = read(n);
+            if (got.is_none()) {
+                throw py::value_error("Cannot load from a non-blocking stream with no data");
+            }
+            pending = got.cast<std::string>();
+        }
+        std::streamsize count = std::min<std::streamsize>(n, pending.size());
+        std::memcpy(s, pending.data(), static_cast<std::size_t>(count));
+        pending.erase(0, static_cast<std::size_t>(count));
+        return count;
+    }
+
+    py::object readinto;
+    py::object read;
+    std::string pending;
+    char chunk[4096];
+};
+
+// A file object can be read only once, so lazy=True needs a path.
+AnyItem load_from_file(py::object file, std::optional<std::vector<std::string>> only) {
+    std::string name = "<stream>";
+    if (py::hasattr(file, "name") && py::isinstance<py::str>(file.attr("name"))) {
+        name = file.attr("name").cast<std::string>();
+    }
+
+    section_list selected = parse_only(only);
+    FileObjectBuf buf(file);
+    toml::ordered_value value;
+    {
+        py::gil_scoped_release release;
+        std::istream stream(&buf);
+        if (selected.empty()) {
+            value = toml::parse<toml::ordered_type_config>(stream, name, default_spec());
+        } else {
+            value = toml::parse_sections<toml::ordered_type_config>(
+                stream, name, std::move(selected), default_spec());
+        }
+    }
+    return wrap_document(std::move(value));
+}
+
+// Parses every file on a pool of native threads and wraps the results in
+// input order. A file that fails to load yields a TomlError in its slot
+// instead of failing the whole batch.
+py::list load_many(std::vector<std::filesystem::path> paths, std::optional<int> threads) {
+    if (threads && *threads < 1) {
+        throw py::value_error("threads must be at least 1");
+    }
+
+    std::vector<toml::ordered_value> documents(paths.size());
+    std::vector<std::exception_ptr> errors(paths.size());
+    {
+        py::gil_scoped_release release;
+
+        std::atomic<std::size_t> next(0);
+        auto work = [&]() {
+            for (std::size_t i = next++; i < paths.size(); i = next++) {
+                try {
+                    documents[i] = parse_path(paths[i]);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            }
+        };
+
+        std::size_t workers = threads ? static_cast<std::size_t>(*threads)
+                                      : std::max(1u, std::thread::hardware_concurrency());
+        workers = std::min(workers, paths.size());
+
+        // this thread is a worker too; if a thread cannot be started the
+        // remaining ones simply pick up more files.
+        std::vector<std::thread> pool;
+        for (std::size_t i = 1; i < workers; ++i) {
+            try {
+                pool.emplace_back(work);
+            } catch (const std::system_error &) {
+                break;
+            }
+        }
+        work();
+        for (auto &t : pool) {
+            t.join();
+        }
+    }
+
+    py::list result(paths.size());
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        if (errors[i]) {
+            // Anything else, e.g. reading a directory or running out of memory
+            // for one huge file, fails only its own slot too.
+            try {
+                std::rethrow_exception(errors[i]);
+            } catch (const toml::exception &e) {
+                result[i] = toml_error_type(e.what());
+            } catch (const std::exception &e) {
+                result[i] = toml_error_type(paths[i].string() + ": " + e.what());
+            } catch (...) {
+                result[i] = toml_error_type(paths[i].string() + ": unknown error");
+            }
+        } else {
+            result[i] = py::cast(wrap_document(std::move(documents[i])));
+        }
+    }
+    return result;
+}
+
+// Holds the document of an Item shared, so that its node can be read with
+// the GIL released. Must be made with the GIL held: mutators only lock a
+// document while holding the GIL, so this never waits, and the node cannot
+// move before the lock is held.
+class DocumentReader {
+  public:
+    explicit DocumentReader(Item *item)
+        : document(item->document()), lock(document->mutex), node(item->toml_value()) {}
+
+    const toml::ordered_value &value() const { return *node; }
+
+  private:
+    std::shared_ptr<Document> document;
+    std::shared_lock<std::shared_mutex> lock;
+    const toml::ordered_value *node;
+};
+
+std::string format_document(const DocumentReader &reader) {
+    return toml::format<toml::ordered_type_config>(reader.value(), default_spec());
+}
+
+void write_document(const DocumentReader &reader, const std::filesystem::path &path) {
     std::ofstream file;
-    file.open(filename);
-    file << toml::format<toml::ordered_type_config>(*aitem->toml_value(), default_spec());
+    file.open(path);
+    file << format_document(reader);
     file.close();
 }
 
+void dump(AnyItem item, std::string filename) {
+    Item *aitem = cast_anyitem_to_item(item);
+    aitem->materialize();
+    DocumentReader reader(aitem);
+    py::gil_scoped_release release;
+    write_document(reader, filename);
+}
+
 std::string dumps(AnyItem item) {
     Item *aitem = cast_anyitem_to_item(item);
-    return toml::format<toml::ordered_type_config>(*aitem->toml_value(), default_spec());
+    aitem->materialize();
+    DocumentReader reader(aitem);
+    py::gil_scoped_release release;
+    return format_document(reader);
 }
 
 void dump_to_path(AnyItem item, std::filesystem::path path) {
     Item *aitem = cast_anyitem_to_item(item);
-    std::ofstream file;
-    file.open(path);
-    file << toml::format<toml::ordered_type_config>(*aitem->toml_value(), default_spec());
-    file.close();
+    aitem->materialize();
+    DocumentReader reader(aitem);
+    py::gil_scoped_release release;
+    write_document(reader, path);
+}
+
+py::bytes dump_binary(AnyItem item) {
+    Item *aitem = cast_anyitem_to_item(item);
+    aitem->materialize();
+    std::vector<unsigned char> buf;
+    {
+        DocumentReader reader(aitem);
+        py::gil_scoped_release release;
+        buf = toml::encode_binary(reader.value());
+    }
+    return py::bytes(reinterpret_cast<const char *>(buf.data()), buf.size());
+}
+
+AnyItem load_binary(py::buffer data) {
+    BorrowedSource source = borrow_buffer(data);
+    toml::ordered_value value;
+    {
+        py::gil_scoped_release release;
+        value = toml::decode_binary<toml::ordered_type_config>(
+            reinterpret_cast<const unsigned char *>(source.data),
+            static_cast<std::size_t>(source.size));
+    }
+    return wrap_document(std::move(value));
+}
+
+// Native threads for the *_async functions. Tasks run without the GIL and
+// take it back only to hand their result to the event loop. Threads are
+// started on demand, up to one per core, and joined at interpreter exit.
+class TaskPool {
+  public:
+    void submit(std::function<void()> task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            throw std::runtime_error("pytoml11: interpreter is shutting down");
+        }
+        tasks.push_back(std::move(task));
+        std::size_t limit = std::max(1u, std::thread::hardware_concurrency());
+        if (tasks.size() > threads.size() - busy && threads.size() < limit) {
+            try {
+                threads.emplace_back([this]() { run(); });
+            } catch (const std::system_error &) {
+                if (threads.empty()) {
+                    tasks.pop_back();
+                    throw;
+                }
+            }
+        }
+        ready.notify_one();
+    }
+
+    // Called with the GIL held. Running tasks are allowed to finish; queued
+    // ones are dropped, which is also why the GIL must be held here.
+    void shutdown() {
+        std::deque<std::function<void()>> dropped;
+        std::vector<std::thread> workers;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            dropped.swap(tasks);
+            workers.swap(threads);
+        }
+        ready.notify_all();
+
+        py::gil_scoped_release release;
+        for (auto &t : workers) {
+            t.join();
+        }
+    }
+
+  private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            ready.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            std::function<void()> task = std::move(tasks.front());
+            tasks.pop_front();
+            ++busy;
+            lock.unlock();
+            task();
+            // captured sources may take the GIL when released, so never
+            // destroy a task while holding the mutex.
+            task = nullptr;
+            lock.lock();
+            --busy;
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread> threads;
+    std::size_t busy = 0;
+    bool stopping = false;
+};
+
+// Never destroyed: worker threads may still reference it during exit.
+TaskPool &task_pool() {
+    static TaskPool *pool = new TaskPool();
+    return *pool;
+}
+
+// Runs on the event loop thread. A future that was cancelled while its
+// task was running simply drops the result.
+void settle_future(py::object future, py::object value, py::object error) {
+    if (future.attr("done")().cast<bool>()) {
+        return;
+    }
+    if (error.is_none()) {
+        future.attr("set_result")(value);
+    } else {
+        future.attr("set_exception")(error);
+    }
+}
+
+// Returns an asyncio future on the running loop that resolves to
+// `finish(work())`. `work` runs on the task pool without the GIL; `finish`
+// runs on the same thread with the GIL held.
+template <typename Work, typename Finish> py::object run_async(Work work, Finish finish) {
+    py::object loop = py::module_::import("asyncio").attr("get_running_loop")();
+    py::object future = loop.attr("create_future")();
+
+    task_pool().submit([loop, future, work, finish]() mutable {
+        std::optional<decltype(work())> result;
+        std::exception_ptr error;
+        try {
+            result.emplace(work());
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        py::gil_scoped_acquire gil;
+        // moved out so that nothing Python-owned outlives the GIL.
+        py::object the_loop = std::move(loop);
+        py::object the_future = std::move(future);
+        py::object value = py::none();
+        py::object exc = py::none();
+        try {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            value = finish(std::move(*result));
+        } catch (py::error_already_set &e) {
+            exc = e.value();
+        } catch (const toml::exception &e) {
+            exc = toml_error_type(e.what());
+        } catch (const std::exception &e) {
+            exc = py::reinterpret_borrow<py::object>(PyExc_RuntimeError)(e.what());
+        }
+        result.reset();
+
+        try {
+            the_loop.attr("call_soon_threadsafe")(py::cpp_function(&settle_future), the_future,
+                                                  value, exc);
+        } catch (py::error_already_set &) {
+            // the loop was closed while the task ran; nobody is waiting.
+        }
+    });
+    return future;
+}
+
+py::object load_async(std::filesystem::path path) {
+    return run_async(
+        [path]() { return parse_path(path); },
+        [](toml::ordered_value &&value) { return py::cast(wrap_document(std::move(value))); });
+}
+
+py::object loads_async_in_place(BorrowedSource source) {
+    return run_async([source]() { return parse_borrowed(source); },
+                     [](toml::ordered_value &&value) {
+                         return py::cast(wrap_document(std::move(value)));
+                     });
+}
+
+py::object loads_async(py::str data) { return loads_async_in_place(borrow_str(data)); }
+
+py::object loads_async_buffer(py::buffer data) {
+    return loads_async_in_place(borrow_buffer(data));
+}
+
+py::object dump_async(AnyItem item, std::filesystem::path path) {
+    cast_anyitem_to_item(item)->materialize();
+    return run_async(
+        [item, path]() mutable {
+            // The worker has to hold the lock itself, so it takes the GIL
+            // just long enough to make the reader.
+            std::optional<DocumentReader> reader;
+            {
+                py::gil_scoped_acquire gil;
+                reader.emplace(cast_anyitem_to_item(item));
+            }
+            write_document(*reader, path);
+            return true;
+        },
+        [](bool) { return py::object(py::none()); });
 }
 
 Item *cast_anyitem_to_item(AnyItem &item) {
@@ -929,6 +1864,8 @@ Item *cast_anyitem_to_item(AnyItem &item) {
 bool items_equal(AnyItem &a, AnyItem &b) {
     Item *item_a = cast_anyitem_to_item(a);
     Item *item_b = cast_anyitem_to_item(b);
+    item_a->materialize();
+    item_b->materialize();
     return *item_a->toml_value() == *item_b->toml_value();
 }
 
@@ -1106,12 +2043,44 @@ PYBIND11_MODULE(_value, m) {
         .def_property_readonly("nanoseconds", &DateTime::nanoseconds)
         .def("copy", &DateTime::copy);
 
-    m.def("load", &load);
-    m.def("load", &load_from_path);
+    py::class_<CacheInfo>(m, "CacheInfo")
+        .def_readonly("hits", &CacheInfo::hits)
+        .def_readonly("misses", &CacheInfo::misses)
+        .def_readonly("entries", &CacheInfo::entries)
+        .def_readonly("bytes", &CacheInfo::bytes)
+        .def_readonly("max_bytes", &CacheInfo::max_bytes)
+        .def("__repr__", [](const CacheInfo &info) {
+            return "CacheInfo(hits=" + std::to_string(info.hits) +
+                   ", misses=" + std::to_string(info.misses) +
+                   ", entries=" + std::to_string(info.entries) +
+                   ", bytes=" + std::to_string(info.bytes) +
+                   ", max_bytes=" + std::to_string(info.max_bytes) + ")";
+        });
+
+    m.def("load", &load, py::arg("fp"), py::kw_only(), py::arg("only") = py::none(),
+          py::arg("lazy") = false);
+    m.def("load", &load_from_path, py::arg("fp"), py::kw_only(), py::arg("only") = py::none(),
+          py::arg("lazy") = false);
+    m.def("load", &load_from_file, py::arg("fp"), py::kw_only(), py::arg("only") = py::none());
     m.def("loads", &loads);
+    m.def("loads", &loads_buffer);
     m.def("dump", &dump);
     m.def("dump", &dump_to_path);
     m.def("dumps", &dumps);
-
-    py::register_exception<toml::exception>(m, "TomlError");
+    m.def("dump_binary", &dump_binary, py::arg("obj"));
+    m.def("load_binary", &load_binary, py::arg("b"));
+    m.def("load_async", &load_async);
+    m.def("loads_async", &loads_async);
+    m.def("loads_async", &loads_async_buffer);
+    m.def("dump_async", &dump_async);
+    m.def("load_many", &load_many, py::arg("paths"), py::kw_only(),
+          py::arg("threads") = py::none());
+    m.def("set_cache_limit", &set_cache_limit, py::arg("max_bytes"));
+    m.def("clear_cache", &clear_cache, py::arg("path") = py::none());
+    m.def("cache_info", &cache_info);
+
+    toml_error_type = py::register_exception<toml::exception>(m, "TomlError");
+
+    py::module_::import("atexit").attr("register")(
+        py::cpp_function([]() { task_pool().shutdown(); }));
 }
\ No newline at end of file
@@ -3,6 +3,7 @@ from __future__ import annotations
 from ._value import (
     Array,
     Boolean,
+    CacheInfo,
     Date,
     DateTime,
     Float,
@@ -13,15 +14,25 @@ from ._value import (
     Table,
     Time,
     TomlError,
+    cache_info,
+    clear_cache,
     dump,
+    dump_async,
+    dump_binary,
     dumps,
     load,
+    load_async,
+    load_binary,
+    load_many,
     loads,
+    loads_async,
+    set_cache_limit,
 )
 
 __all__ = [
     "Array",
     "Boolean",
+    "CacheInfo",
     "Date",
     "DateTime",
     "Float",
@@ -32,8 +43,17 @@ __all__ = [
     "Table",
     "Time",
     "TomlError",
+    "cache_info",
+    "clear_cache",
     "dump",
+    "dump_async",
+    "dump_binary",
     "dumps",
     "load",
+    "load_async",
+    "load_binary",
+    "load_many",
     "loads",
+    "loads_async",
+    "set_cache_limit",
 ]
@@ -161,6 +161,19 @@ class Boolean(Item):
     @property
     def value(self) -> bool: ...
 
+class CacheInfo:
+    """Counters and size of the parse cache, see set_cache_limit."""
+    @property
+    def hits(self) -> int: ...
+    @property
+    def misses(self) -> int: ...
+    @property
+    def entries(self) -> int: ...
+    @property
+    def bytes(self) -> int: ...
+    @property
+    def max_bytes(self) -> int: ...
+
 class Date(Item):
     """A TOML date value."""
     def __init__(self, value: date) -> None: ...
@@ -357,20 +370,94 @@ def dumps(
     | Time
     | DateTime,
 ) -> str: ...
+@typing.overload
 def load(
     fp: str | PathLike | Path,
+    *,
+    only: typing.Sequence[str] | None = None,
+    lazy: bool = False,
+) -> (
+    Boolean | Integer | Float | String | Table | Array | Null | Date | Time | DateTime
+): ...
+@typing.overload
+def load(
+    fp: typing.BinaryIO | typing.TextIO,
+    *,
+    only: typing.Sequence[str] | None = None,
 ) -> (
     Boolean | Integer | Float | String | Table | Array | Null | Date | Time | DateTime
 ): ...
 def loads(
-    s: str,
+    s: str | bytes | bytearray | memoryview,
+) -> (
+    Boolean | Integer | Float | String | Table | Array | Null | Date | Time | DateTime
+): ...
+def load_async(
+    fp: str | PathLike | Path,
+) -> typing.Awaitable[
+    Boolean | Integer | Float | String | Table | Array | Null | Date | Time | DateTime
+]: ...
+def loads_async(
+    s: str | bytes | bytearray | memoryview,
+) -> typing.Awaitable[
+    Boolean | Integer | Float | String | Table | Array | Null | Date | Time | DateTime
+]: ...
+def dump_async(
+    obj: Boolean
+    | Integer
+    | Float
+    | String
+    | Table
+    | Array
+    | Null
+    | Date
+    | Time
+    | DateTime,
+    fp: str | PathLike | Path,
+) -> typing.Awaitable[None]: ...
+def load_many(
+    paths: typing.Sequence[str | PathLike | Path],
+    *,
+    threads: int | None = None,
+) -> list[
+    Boolean
+    | Integer
+    | Float
+    | String
+    | Table
+    | Array
+    | Null
+    | Date
+    | Time
+    | DateTime
+    | TomlError
+]: ...
+def dump_binary(
+    obj: Boolean
+    | Integer
+    | Float
+    | String
+    | Table
+    | Array
+    | Null
+    | Date
+    | Time
+    | DateTime,
+) -> bytes: ...
+def load_binary(
+    b: bytes | bytearray | memoryview,
 ) -> (
     Boolean | Integer | Float | String | Table | Array | Null | Date | Time | DateTime
 ): ...
 
+def set_cache_limit(max_bytes: int) -> None: ...
+def clear_cache(path: str | PathLike | Path | None = None) -> None: ...
+def cache_info() -> CacheInfo: ...
+
 __all__ = [
     "Array",
     "Boolean",
+    "CacheInfo",
     "Date",
     "DateTime",
     "Float",
@@ -381,8 +468,17 @@ __all__ = [
     "Table",
     "Time",
     "TomlError",
+    "cache_info",
+    "clear_cache",
     "dump",
+    "dump_async",
+    "dump_binary",
     "dumps",
     "load",
+    "load_async",
+    "load_binary",
+    "load_many",
     "loads",
+    "loads_async",
+    "set_cache_limit",
 ]
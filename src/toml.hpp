@@ -83,6 +83,17 @@
 #  endif
 #endif
 
+// SSE2 is always available on x86-64. AVX2 kernels are compiled with the
+// target attribute and selected at runtime, so it requires GCC or clang.
+#ifndef TOML11_DISABLE_SIMD
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define TOML11_HAS_SSE2 1
+#  endif
+#  if defined(TOML11_HAS_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#    define TOML11_HAS_RUNTIME_AVX2 1
+#  endif
+#endif
+
 #if defined(TOML11_COMPILE_SOURCES)
 #  define TOML11_INLINE
 #else
@@ -1643,6 +1654,20 @@ U bit_cast(const T& x) noexcept
 } // cxx
 } // toml
 
+// ---------------------------------------------------------------------------
+// C++17 floating point std::from_chars and std::to_chars
+
+#if TOML11_CPLUSPLUS_STANDARD_VERSION >= TOML11_CXX17_VALUE
+#  if __has_include(<charconv>)
+#    include <charconv>
+#    if defined(__cpp_lib_to_chars)
+#      if __cpp_lib_to_chars >= 201611L
+#        define TOML11_HAS_FLOAT_CHARCONV 1
+#      endif
+#    endif
+#  endif
+#endif
+
 // ---------------------------------------------------------------------------
 // C++20 remove_cvref_t
 
@@ -3215,7 +3240,9 @@ struct spec
 #define TOML11_ORDERED_MAP_HPP
 
 #include <algorithm>
+#include <functional>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -3231,6 +3258,11 @@ struct ordered_map_ebo_container
 };
 } // detail
 
+// ordered_map keeps the insertion order in a vector. Lookup is a linear scan
+// while the map is small. Once it has `index_threshold` elements or more, it
+// also keeps a hash index (an open-addressing table of positions in the
+// vector) if the comparator is std::equal_to. Note that keys must not be
+// modified through iterators.
 template<typename Key, typename Val, typename Cmp = std::equal_to<Key>,
          typename Allocator = std::allocator<std::pair<Key, Val>>>
 class ordered_map : detail::ordered_map_ebo_container<Cmp>
@@ -3257,6 +3289,12 @@ class ordered_map : detail::ordered_map_ebo_container<Cmp>
 
     using ebo_base = detail::ordered_map_ebo_container<Cmp>;
 
+    // slot -> (position in container_) + 1. 0 means an empty slot.
+    using index_type = std::vector<std::size_t>;
+    using use_index  = std::is_same<Cmp, std::equal_to<Key>>;
+
+    enum : std::size_t { index_threshold = 16 };
+
   public:
 
     ordered_map() = default;
@@ -3267,10 +3305,10 @@ class ordered_map : detail::ordered_map_ebo_container<Cmp>
     ordered_map& operator=(ordered_map&&)      = default;
 
     ordered_map(const ordered_map& other, const Allocator& alloc)
-        : container_(other.container_, alloc)
+        : container_(other.container_, alloc), index_(other.index_)
     {}
     ordered_map(ordered_map&& other, const Allocator& alloc)
-        : container_(std::move(other.container_), alloc)
+        : container_(std::move(other.container_), alloc), index_(std::move(other.index_))
     {}
 
     explicit ordered_map(const Cmp& cmp, const Allocator& alloc = Allocator())
@@ -3283,21 +3321,30 @@ class ordered_map : detail::ordered_map_ebo_container<Cmp>
     template<typename InputIterator>
     ordered_map(InputIterator first, InputIterator last, const Cmp& cmp = Cmp(), const Allocator& alloc = Allocator())
         : ebo_base{cmp}, container_(first, last, alloc)
-    {}
+    {
+        this->rebuild_index();
+    }
     template<typename InputIterator>
     ordered_map(InputIterator first, InputIterator last, const Allocator& alloc)
         : container_(first, last, alloc)
-    {}
+    {
+        this->rebuild_index();
+    }
 
     ordered_map(std::initializer_list<value_type> v, const Cmp& cmp = Cmp(), const Allocator& alloc = Allocator())
         : ebo_base{cmp}, container_(std::move(v), alloc)
-    {}
+    {
+        this->rebuild_index();
+    }
     ordered_map(std::initializer_list<value_type> v, const Allocator& alloc)
         : container_(std::move(v), alloc)
-    {}
+    {
+        this->rebuild_index();
+    }
     ordered_map& operator=(std::initializer_list<value_type> v)
     {
         this->container_ = std::move(v);
+        this->rebuild_index();
         return *this;
     }
 
@@ -3312,7 +3359,8 @@ class ordered_map : detail::ordered_map_ebo_container<Cmp>
     std::size_t size()     const noexcept {return container_.size();}
     std::size_t max_size() const noexcept {return container_.max_size();}
 
-    void clear() {container_.clear();}
+    void clear() {container_.clear(); index_.clear();}
+    void reserve(std::size_t n) {container_.reserve(n);}
 
     void push_back(const value_type& v)
     {
@@ -3321,6 +3369,7 @@ class ordered_map : detail::ordered_map_ebo_container<Cmp>
             throw std::out_of_range("ordered_map: value already exists");
         }
         container_.push_back(v);
+        this->index_back();
     }
     void push_back(value_type&& v)
     {
@@ -3329,6 +3378,7 @@ class ordered_map : detail::ordered_map_ebo_container<Cmp>
             throw std::out_of_range("ordered_map: value already exists");
         }
         container_.push_back(std::move(v));
+        this->index_back();
     }
     void emplace_back(key_type k, mapped_type v)
     {
@@ -3337,8 +3387,13 @@ class ordered_map : detail::ordered_map_ebo_container<Cmp>
             throw std::out_of_range("ordered_map: value already exists");
         }
         container_.emplace_back(std::move(k), std::move(v));
+        this->index_back();
+    }
+    void pop_back()
+    {
+        this->unindex(container_.size() - 1);
+        container_.pop_back();
     }
-    void pop_back()  {container_.pop_back();}
 
     void insert(value_type kv)
     {
@@ -3347,6 +3402,7 @@ class ordered_map : detail::ordered_map_ebo_container<Cmp>
             throw std::out_of_range("ordered_map: value already exists");
         }
         container_.push_back(std::move(kv));
+        this->index_back();
     }
     void emplace(key_type k, mapped_type v)
     {
@@ -3355,6 +3411,26 @@ class ordered_map : detail::ordered_map_ebo_container<Cmp>
             throw std::out_of_range("ordered_map: value already exists");
         }
         container_.emplace_back(std::move(k), std::move(v));
+        this->index_back();
+    }
+
+    // removes an element. the order of the rest is kept.
+    iterator erase(const_iterator pos)
+    {
+        const auto n = static_cast<std::size_t>(std::distance(this->cbegin(), pos));
+        this->unindex(n);
+        return container_.erase(std::next(container_.begin(),
+                                          static_cast<difference_type>(n)));
+    }
+    std::size_t erase(const key_type& key)
+    {
+        const auto iter = this->find(key);
+        if(iter == this->end())
+        {
+            return 0;
+        }
+        this->erase(iter);
+        return 1;
     }
 
     std::size_t count(const key_type& key) const
@@ -3374,13 +3450,11 @@ class ordered_map : detail::ordered_map_ebo_container<Cmp>
     }
     iterator find(const key_type& key) noexcept
     {
-        return std::find_if(this->begin(), this->end(),
-            [&key, this](const value_type& v) {return this->cmp_(v.first, key);});
+        return std::next(this->begin(), static_cast<difference_type>(this->find_position(key)));
     }
     const_iterator find(const key_type& key) const noexcept
     {
-        return std::find_if(this->begin(), this->end(),
-            [&key, this](const value_type& v) {return this->cmp_(v.first, key);});
+        return std::next(this->begin(), static_cast<difference_type>(this->find_position(key)));
     }
 
     mapped_type&       at(const key_type& k)
@@ -3408,6 +3482,7 @@ class ordered_map : detail::ordered_map_ebo_container<Cmp>
         if(iter == this->end())
         {
             this->container_.emplace_back(k, mapped_type{});
+            this->index_back();
             return this->container_.back().second;
         }
         return iter->second;
@@ -3428,11 +3503,151 @@ class ordered_map : detail::ordered_map_ebo_container<Cmp>
     void swap(ordered_map& other)
     {
         container_.swap(other.container_);
+        index_.swap(other.index_);
+    }
+
+  private:
+
+    // returns the position of the key, or size() if not found.
+    std::size_t find_position(const key_type& key) const noexcept
+    {
+        if( ! this->index_.empty())
+        {
+            const auto pos = this->index_[this->find_slot(key)];
+            return pos == 0 ? this->container_.size() : pos - 1;
+        }
+        const auto iter = std::find_if(this->begin(), this->end(),
+            [&key, this](const value_type& v) {return this->cmp_(v.first, key);});
+        return static_cast<std::size_t>(std::distance(this->begin(), iter));
+    }
+
+    // ------------------------------------------------------------------------
+    // hash index
+
+    static std::size_t hash_key(const key_type& key) noexcept
+    {
+        return hash_key_impl(key, use_index{});
+    }
+    static std::size_t hash_key_impl(const key_type& key, std::true_type) noexcept
+    {
+        return std::hash<key_type>{}(key);
+    }
+    static std::size_t hash_key_impl(const key_type&, std::false_type) noexcept
+    {
+        return 0; // never called. the index is not built.
+    }
+
+    // returns the slot that has `key`, or an empty slot where it should be.
+    std::size_t find_slot(const key_type& key) const noexcept
+    {
+        const std::size_t mask = this->index_.size() - 1;
+        std::size_t slot = hash_key(key) & mask;
+        while(this->index_[slot] != 0 &&
+              ! this->cmp_(this->container_[this->index_[slot] - 1].first, key))
+        {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    void rebuild_index()
+    {
+        this->index_.clear();
+        if( ! use_index::value || this->container_.size() < index_threshold)
+        {
+            return;
+        }
+        // keep the load factor <= 0.5
+        std::size_t capacity = 2 * index_threshold;
+        while(capacity < 2 * this->container_.size())
+        {
+            capacity *= 2;
+        }
+        this->index_.assign(capacity, 0);
+        for(std::size_t i=0; i<this->container_.size(); ++i)
+        {
+            const auto slot = this->find_slot(this->container_[i].first);
+            if(this->index_[slot] == 0) // the first one wins, as linear search
+            {
+                this->index_[slot] = i + 1;
+            }
+        }
+    }
+
+    // called after an element is appended to container_
+    void index_back()
+    {
+        if(this->index_.empty() || this->index_.size() < 2 * this->container_.size())
+        {
+            this->rebuild_index();
+            return;
+        }
+        const auto slot = this->find_slot(this->container_.back().first);
+        this->index_[slot] = this->container_.size();
+    }
+
+    // backward shift deletion for linear probing
+    void erase_slot(std::size_t hole) noexcept
+    {
+        const std::size_t mask = this->index_.size() - 1;
+        this->index_[hole] = 0;
+
+        std::size_t slot = hole;
+        while(true)
+        {
+            slot = (slot + 1) & mask;
+            if(this->index_[slot] == 0)
+            {
+                break;
+            }
+            const auto home = hash_key(this->container_[this->index_[slot] - 1].first) & mask;
+            // move it if `home` is not in the cyclic range (hole, slot]
+            const bool stays = (hole <= slot) ? (hole < home && home <= slot) :
+                                                (hole < home || home <= slot);
+            if( ! stays)
+            {
+                this->index_[hole] = this->index_[slot];
+                this->index_[slot] = 0;
+                hole = slot;
+            }
+        }
+        return;
+    }
+
+    // called before the element at `pos` is removed from container_
+    void unindex(const std::size_t pos)
+    {
+        if(this->index_.empty())
+        {
+            return;
+        }
+        if(this->container_.size() <= index_threshold)
+        {
+            this->index_.clear(); // it becomes small enough
+            return;
+        }
+
+        // a duplicated key given to the range constructor is not indexed
+        const auto slot = this->find_slot(this->container_[pos].first);
+        if(this->index_[slot] == pos + 1)
+        {
+            this->erase_slot(slot);
+        }
+
+        // the elements after `pos` will be shifted by one
+        if(pos + 1 != this->container_.size())
+        {
+            for(auto& i : this->index_)
+            {
+                if(pos + 1 < i) {i -= 1;}
+            }
+        }
     }
 
   private:
 
     container_type container_;
+    index_type     index_;
 };
 
 template<typename K, typename V, typename C, typename A>
@@ -4423,7 +4638,10 @@ string_conv(const char (&s)[N])
 #define TOML11_LOCATION_FWD_HPP
 
 
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -4434,6 +4652,117 @@ namespace detail
 
 class region; // fwd decl
 
+//
+// A read-only sequence of input bytes. The memory is kept alive by `owner`,
+// that is a std::vector or memory borrowed from the caller, so that the parser
+// can read a buffer without copying it.
+//
+class source_buffer
+{
+  public:
+
+    using value_type             = unsigned char;
+    using size_type              = std::size_t;
+    using difference_type        = std::ptrdiff_t;
+    using const_iterator         = value_type const*;
+    using iterator               = const_iterator;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  public:
+
+    explicit source_buffer(std::shared_ptr<const std::vector<value_type>> v)
+        : data_(v ? v->data() : nullptr), size_(v ? v->size() : 0),
+          owner_(std::move(v))
+    {}
+    source_buffer(const value_type* data, const size_type size,
+                  std::shared_ptr<const void> owner)
+        : data_(data), size_(size), owner_(std::move(owner))
+    {}
+    ~source_buffer() = default;
+    source_buffer(const source_buffer&) = delete;
+    source_buffer(source_buffer&&)      = delete;
+    source_buffer& operator=(const source_buffer&) = delete;
+    source_buffer& operator=(source_buffer&&)      = delete;
+
+    value_type const* data()  const noexcept {return this->data_;}
+    size_type         size()  const noexcept {return this->size_;}
+    bool              empty() const noexcept {return this->size_ == 0;}
+
+    value_type operator[](const size_type i) const noexcept {return this->data_[i];}
+    value_type back() const noexcept {return this->data_[this->size_ - 1];}
+
+    value_type at(const size_type i) const
+    {
+        if(this->size_ <= i)
+        {
+            throw std::out_of_range("toml::detail::source_buffer::at: index "
+                + std::to_string(i) + " exceeds size " + std::to_string(this->size_));
+        }
+        return this->data_[i];
+    }
+
+    const_iterator begin()  const noexcept {return this->data_;}
+    const_iterator end()    const noexcept {return this->data_ + this->size_;}
+    const_iterator cbegin() const noexcept {return this->data_;}
+    const_iterator cend()   const noexcept {return this->data_ + this->size_;}
+
+    const_reverse_iterator rbegin()  const noexcept {return const_reverse_iterator(this->end());}
+    const_reverse_iterator rend()    const noexcept {return const_reverse_iterator(this->begin());}
+    const_reverse_iterator crbegin() const noexcept {return const_reverse_iterator(this->cend());}
+    const_reverse_iterator crend()   const noexcept {return const_reverse_iterator(this->cbegin());}
+
+  private:
+
+    value_type const*           data_;
+    size_type                   size_;
+    std::shared_ptr<const void> owner_;
+};
+
+//
+// An input and its name. All the locations and regions that point the same
+// input share one source_info, so that a region only needs to store offsets.
+// Line heads are indexed when a line or column number is requested for the
+// first time. Until then, the parser only needs byte offsets.
+//
+class source_info
+{
+  public:
+
+    using char_type      = unsigned char;
+    using source_ptr     = std::shared_ptr<const source_buffer>;
+
+  public:
+
+    source_info(source_ptr src, std::string name)
+        : source_(std::move(src)), name_(std::move(name))
+    {}
+    ~source_info() = default;
+    source_info(const source_info&) = delete;
+    source_info(source_info&&)      = delete;
+    source_info& operator=(const source_info&) = delete;
+    source_info& operator=(source_info&&)      = delete;
+
+    source_ptr  const& source() const noexcept {return this->source_;}
+    std::string const& name()   const noexcept {return this->name_;}
+
+    // 1-origin line number of the character at `pos`. 0 if the input is empty.
+    std::size_t line_number(const std::size_t pos) const;
+    // 1-origin column number of the character at `pos`. 0 if the input is empty.
+    std::size_t column_number(const std::size_t pos) const;
+
+  private:
+
+    // returns the index of the line that contains `pos`. 0-origin.
+    std::size_t find_line(const std::size_t pos) const;
+
+  private:
+
+    source_ptr  source_;
+    std::string name_;
+    mutable std::once_flag           indexed_;
+    mutable std::vector<std::size_t> heads_;
+};
+
 //
 // To represent where we are reading in the parse functions.
 // Since it "points" somewhere in the input stream, the length is always 1.
@@ -4445,13 +4774,17 @@ class location
     using char_type       = unsigned char; // must be unsigned
     using container_type  = std::vector<char_type>;
     using difference_type = typename container_type::difference_type; // to suppress sign-conversion warning
-    using source_ptr      = std::shared_ptr<const container_type>;
+    using source_ptr      = std::shared_ptr<const source_buffer>;
 
   public:
 
     location(source_ptr src, std::string src_name)
-        : source_(std::move(src)), source_name_(std::move(src_name)),
-          location_(0), line_number_(1)
+        : source_(src), info_(std::make_shared<const source_info>(
+              std::move(src), std::move(src_name))), location_(0)
+    {}
+    location(std::shared_ptr<const container_type> src, std::string src_name)
+        : location(std::make_shared<const source_buffer>(std::move(src)),
+                   std::move(src_name))
     {}
 
     location(const location&) = default;
@@ -4476,20 +4809,12 @@ class location
     }
     void set_location(const std::size_t loc) noexcept;
 
-    std::size_t line_number() const noexcept
-    {
-        return this->line_number_;
-    }
+    std::size_t line_number() const;
     std::string get_line() const;
-    std::size_t column_number() const noexcept;
+    std::size_t column_number() const;
 
     source_ptr const&  source()      const noexcept {return this->source_;}
-    std::string const& source_name() const noexcept {return this->source_name_;}
-
-  private:
-
-    void advance_line_number(const std::size_t n);
-    void retrace_line_number(const std::size_t n);
+    std::string const& source_name() const noexcept {return this->info_->name();}
 
   private:
 
@@ -4497,10 +4822,9 @@ class location
 
   private:
 
-    source_ptr  source_;
-    std::string source_name_;
+    source_ptr  source_; // the same as info_->source(). to skip an indirection
+    std::shared_ptr<const source_info> info_;
     std::size_t location_; // std::vector<>::difference_type is signed
-    std::size_t line_number_;
 };
 
 bool operator==(const location& lhs, const location& rhs) noexcept;
@@ -4574,17 +4898,51 @@ namespace toml
 namespace detail
 {
 
+TOML11_INLINE std::size_t source_info::find_line(const std::size_t pos) const
+{
+    std::call_once(this->indexed_, [this]() {
+        this->heads_.push_back(0);
+        const auto* data = this->source_->data();
+        const auto* iter = data;
+        const auto* last = data + this->source_->size();
+        while(iter != last)
+        {
+            const auto* lf = static_cast<const char_type*>(
+                std::memchr(iter, '\n', static_cast<std::size_t>(last - iter)));
+            if(lf == nullptr)
+            {
+                break;
+            }
+            iter = lf + 1;
+            this->heads_.push_back(static_cast<std::size_t>(iter - data));
+        }
+    });
+    const auto next = std::upper_bound(this->heads_.begin(), this->heads_.end(), pos);
+    assert(next != this->heads_.begin());
+    return static_cast<std::size_t>(std::distance(this->heads_.begin(), next)) - 1;
+}
+
+TOML11_INLINE std::size_t source_info::line_number(const std::size_t pos) const
+{
+    if(this->source_->empty()) {return 0;}
+    return this->find_line(pos) + 1;
+}
+TOML11_INLINE std::size_t source_info::column_number(const std::size_t pos) const
+{
+    if(this->source_->empty()) {return 0;}
+    const auto line = this->find_line(pos);
+    return pos - this->heads_.at(line) + 1;
+}
+
 TOML11_INLINE void location::advance(std::size_t n) noexcept
 {
     assert(this->is_ok());
     if(this->location_ + n < this->source_->size())
     {
-        this->advance_line_number(n);
         this->location_ += n;
     }
     else
     {
-        this->advance_line_number(this->source_->size() - this->location_);
         this->location_ = this->source_->size();
     }
 }
@@ -4594,11 +4952,9 @@ TOML11_INLINE void location::retrace(std::size_t n) noexcept
     if(this->location_ < n)
     {
         this->location_ = 0;
-        this->line_number_ = 1;
     }
     else
     {
-        this->retrace_line_number(n);
         this->location_ -= n;
     }
 }
@@ -4632,28 +4988,15 @@ TOML11_INLINE location::char_type location::peek()
 
 TOML11_INLINE void location::set_location(const std::size_t loc) noexcept
 {
-    if(this->location_ == loc)
-    {
-        return ;
-    }
-
-    if(loc == 0)
-    {
-        this->line_number_ = 1;
-    }
-    else if(this->location_ < loc)
-    {
-        const auto d = loc - this->location_;
-        this->advance_line_number(d);
-    }
-    else
-    {
-        const auto d = this->location_ - loc;
-        this->retrace_line_number(d);
-    }
     this->location_ = loc;
 }
 
+TOML11_INLINE std::size_t location::line_number() const
+{
+    assert(this->is_ok());
+    return this->info_->line_number(this->location_);
+}
+
 TOML11_INLINE std::string location::get_line() const
 {
     assert(this->is_ok());
@@ -4665,51 +5008,10 @@ TOML11_INLINE std::string location::get_line() const
 
     return make_string(std::next(prev.base()), next);
 }
-TOML11_INLINE std::size_t location::column_number() const noexcept
-{
-    assert(this->is_ok());
-    const auto iter  = std::next(this->source_->cbegin(), static_cast<difference_type>(this->location_));
-    const auto riter = cxx::make_reverse_iterator(iter);
-    const auto prev  = std::find(riter, this->source_->crend(), char_type('\n'));
-
-    assert(prev.base() <= iter);
-    return static_cast<std::size_t>(std::distance(prev.base(), iter) + 1); // 1-origin
-}
-
-
-TOML11_INLINE void location::advance_line_number(const std::size_t n)
-{
-    assert(this->is_ok());
-    assert(this->location_ + n <= this->source_->size());
-
-    const auto iter = this->source_->cbegin();
-    this->line_number_ += static_cast<std::size_t>(std::count(
-        std::next(iter, static_cast<difference_type>(this->location_)),
-        std::next(iter, static_cast<difference_type>(this->location_ + n)),
-        char_type('\n')));
-
-    return;
-}
-TOML11_INLINE void location::retrace_line_number(const std::size_t n)
+TOML11_INLINE std::size_t location::column_number() const
 {
     assert(this->is_ok());
-    assert(n <= this->location_); // loc - n >= 0
-
-    const auto iter = this->source_->cbegin();
-    const auto dline_num = static_cast<std::size_t>(std::count(
-        std::next(iter, static_cast<difference_type>(this->location_ - n)),
-        std::next(iter, static_cast<difference_type>(this->location_)),
-        char_type('\n')));
-
-    if(this->line_number_ <= dline_num)
-    {
-        this->line_number_ = 1;
-    }
-    else
-    {
-        this->line_number_ -= dline_num;
-    }
-    return;
+    return this->info_->column_number(this->location_);
 }
 
 TOML11_INLINE bool operator==(const location& lhs, const location& rhs) noexcept
@@ -4798,10 +5100,12 @@ count(const location& first, const location& last, const location::char_type& c)
 #define TOML11_REGION_FWD_HPP
 
 
+#include <limits>
 #include <string>
 #include <vector>
 
 #include <cassert>
+#include <cstdint>
 
 namespace toml
 {
@@ -4821,17 +5125,13 @@ class region
     using difference_type = location::difference_type;
     using source_ptr      = location::source_ptr;
 
-    using iterator       = typename container_type::iterator;
-    using const_iterator = typename container_type::const_iterator;
+    using iterator       = typename source_buffer::iterator;
+    using const_iterator = typename source_buffer::const_iterator;
 
   public:
 
     // a value that is constructed manually does not have input stream info
-    region()
-        : source_(nullptr), source_name_(""), length_(0),
-          first_(0), first_line_(0), first_column_(0), last_(0), last_line_(0),
-          last_column_(0)
-    {}
+    region(): info_(nullptr), first_(0), length_(0), single_char_(false) {}
 
     // a value defined in [first, last).
     // Those source must be the same. Instread, `region` does not make sense.
@@ -4846,27 +5146,32 @@ class region
     region& operator=(const region&) = default;
     region& operator=(region&&)      = default;
 
-    bool is_ok() const noexcept { return static_cast<bool>(this->source_); }
+    bool is_ok() const noexcept { return static_cast<bool>(this->info_); }
 
     operator bool() const noexcept { return this->is_ok(); }
 
     std::size_t length() const noexcept {return this->length_;}
 
-    std::size_t first_line_number() const noexcept
+    // line and column numbers are computed on demand. 0 if unknown.
+    std::size_t first_line_number() const
     {
-        return this->first_line_;
+        return this->info_ ? this->info_->line_number(this->first()) : 0;
     }
-    std::size_t first_column_number() const noexcept
+    std::size_t first_column_number() const
     {
-        return this->first_column_;
+        return this->info_ ? this->info_->column_number(this->first()) : 0;
     }
-    std::size_t last_line_number() const noexcept
+    std::size_t last_line_number() const
     {
-        return this->last_line_;
+        if( ! this->info_) {return 0;}
+        return this->info_->line_number(
+            this->is_single_char() ? this->first() : this->last());
     }
-    std::size_t last_column_number() const noexcept
+    std::size_t last_column_number() const
     {
-        return this->last_column_;
+        if( ! this->info_) {return 0;}
+        return this->is_single_char() ? this->info_->column_number(this->first()) + 1 :
+                                        this->info_->column_number(this->last());
     }
 
     char_type at(std::size_t i) const;
@@ -4879,20 +5184,26 @@ class region
     std::string as_string() const;
     std::vector<std::string> as_lines() const;
 
-    source_ptr const&  source()      const noexcept {return this->source_;}
-    std::string const& source_name() const noexcept {return this->source_name_;}
+    source_ptr const&  source()      const noexcept;
+    std::string const& source_name() const noexcept;
 
   private:
 
-    source_ptr  source_;
-    std::string source_name_;
-    std::size_t length_;
-    std::size_t first_;
-    std::size_t first_line_;
-    std::size_t first_column_;
-    std::size_t last_;
-    std::size_t last_line_;
-    std::size_t last_column_;
+    std::size_t first() const noexcept {return this->first_;}
+    std::size_t last()  const noexcept {return std::size_t(this->first_) + this->length_;}
+
+    // [loc, loc+1) ends on the line of `loc`, even if `loc` is a newline.
+    // other regions end where `last` is.
+    bool is_single_char() const noexcept {return this->single_char_;}
+
+  private:
+
+    // Every value has a region. To keep it small, it only has offsets into
+    // the shared source_info. parse() rejects inputs larger than 4 GiB.
+    std::shared_ptr<const source_info> info_;
+    std::uint32_t first_;
+    std::uint32_t length_;
+    bool          single_char_; // made by region(loc) before the end of input
 };
 
 } // namespace detail
@@ -4919,100 +5230,89 @@ namespace detail
 // a value defined in [first, last).
 // Those source must be the same. Instread, `region` does not make sense.
 TOML11_INLINE region::region(const location& first, const location& last)
-    : source_(first.source()), source_name_(first.source_name()),
-      length_(last.get_location() - first.get_location()),
-      first_(first.get_location()),
-      first_line_(first.line_number()),
-      first_column_(first.column_number()),
-      last_(last.get_location()),
-      last_line_(last.line_number()),
-      last_column_(last.column_number())
+    : info_(first.info_),
+      first_(static_cast<std::uint32_t>(first.get_location())),
+      length_(static_cast<std::uint32_t>(last.get_location() - first.get_location())),
+      single_char_(false)
 {
     assert(first.source()      == last.source());
     assert(first.source_name() == last.source_name());
+    assert(last.get_location() <= (std::numeric_limits<std::uint32_t>::max)());
 }
 
     // shorthand of [loc, loc+1)
 TOML11_INLINE region::region(const location& loc)
-    : source_(loc.source()), source_name_(loc.source_name()), length_(0),
-      first_line_(0), first_column_(0), last_line_(0), last_column_(0)
+    : info_(loc.info_), first_(0), length_(0), single_char_(false)
 {
+    assert(loc.get_location() <= (std::numeric_limits<std::uint32_t>::max)());
+
     // if the file ends with LF, the resulting region points no char.
     if(loc.eof())
     {
-        if(loc.get_location() == 0)
-        {
-            this->length_       = 0;
-            this->first_        = 0;
-            this->first_line_   = 0;
-            this->first_column_ = 0;
-            this->last_         = 0;
-            this->last_line_    = 0;
-            this->last_column_  = 0;
-        }
-        else
+        if(loc.get_location() != 0)
         {
-            const auto first = prev(loc);
-            this->first_        = first.get_location();
-            this->first_line_   = first.line_number();
-            this->first_column_ = first.column_number();
-            this->last_         = loc.get_location();
-            this->last_line_    = loc.line_number();
-            this->last_column_  = loc.column_number();
-            this->length_       = 1;
+            this->first_  = static_cast<std::uint32_t>(loc.get_location() - 1);
+            this->length_ = 1;
         }
     }
     else
     {
-        this->first_        = loc.get_location();
-        this->first_line_   = loc.line_number();
-        this->first_column_ = loc.column_number();
-        this->last_         = loc.get_location() + 1;
-        this->last_line_    = loc.line_number();
-        this->last_column_  = loc.column_number() + 1;
-        this->length_       = 1;
+        this->first_       = static_cast<std::uint32_t>(loc.get_location());
+        this->length_      = 1;
+        this->single_char_ = true;
     }
 }
 
+TOML11_INLINE region::source_ptr const& region::source() const noexcept
+{
+    static const source_ptr null_source(nullptr);
+    return this->info_ ? this->info_->source() : null_source;
+}
+TOML11_INLINE std::string const& region::source_name() const noexcept
+{
+    static const std::string null_name("");
+    return this->info_ ? this->info_->name() : null_name;
+}
+
 TOML11_INLINE region::char_type region::at(std::size_t i) const
 {
-    if(this->last_ <= this->first_ + i)
+    if(this->last() <= this->first() + i)
     {
         throw std::out_of_range("range::at: index " + std::to_string(i) +
                 " exceeds length " + std::to_string(this->length_));
     }
-    const auto iter = std::next(this->source_->cbegin(),
-            static_cast<difference_type>(this->first_ + i));
+    const auto iter = std::next(this->source()->cbegin(),
+            static_cast<difference_type>(this->first() + i));
     return *iter;
 }
 
 TOML11_INLINE region::const_iterator region::begin() const noexcept
 {
-    return std::next(this->source_->cbegin(),
-            static_cast<difference_type>(this->first_));
+    return std::next(this->source()->cbegin(),
+            static_cast<difference_type>(this->first()));
 }
 TOML11_INLINE region::const_iterator region::end() const noexcept
 {
-    return std::next(this->source_->cbegin(),
-            static_cast<difference_type>(this->last_));
+    return std::next(this->source()->cbegin(),
+            static_cast<difference_type>(this->last()));
 }
 TOML11_INLINE region::const_iterator region::cbegin() const noexcept
 {
-    return std::next(this->source_->cbegin(),
-            static_cast<difference_type>(this->first_));
+    return std::next(this->source()->cbegin(),
+            static_cast<difference_type>(this->first()));
 }
 TOML11_INLINE region::const_iterator region::cend() const noexcept
 {
-    return std::next(this->source_->cbegin(),
-            static_cast<difference_type>(this->last_));
+    return std::next(this->source()->cbegin(),
+            static_cast<difference_type>(this->last()));
 }
 
 TOML11_INLINE std::string region::as_string() const
 {
     if(this->is_ok())
     {
-        const auto begin = std::next(this->source_->cbegin(), static_cast<difference_type>(this->first_));
-        const auto end   = std::next(this->source_->cbegin(), static_cast<difference_type>(this->last_ ));
+        const auto begin = std::next(this->source()->cbegin(), static_cast<difference_type>(this->first()));
+        const auto end   = std::next(this->source()->cbegin(), static_cast<difference_type>(this->last()));
         return ::toml::detail::make_string(begin, end);
     }
     else
@@ -5053,17 +5353,17 @@ TOML11_INLINE std::vector<std::string> region::as_lines() const
     // ```
     // So we start from `end-1` when looking for LF.
 
-    const auto begin_idx = static_cast<difference_type>(this->first_);
-    const auto end_idx   = static_cast<difference_type>(this->last_) - 1;
+    const auto begin_idx = static_cast<difference_type>(this->first());
+    const auto end_idx   = static_cast<difference_type>(this->last()) - 1;
 
     // length_ != 0, so begin < end. then begin <= end-1
     assert(begin_idx <= end_idx);
 
-    const auto begin = std::next(this->source_->cbegin(), begin_idx);
-    const auto end   = std::next(this->source_->cbegin(), end_idx);
+    const auto begin = std::next(this->source()->cbegin(), begin_idx);
+    const auto end   = std::next(this->source()->cbegin(), end_idx);
 
-    const auto line_begin = std::find(cxx::make_reverse_iterator(begin), this->source_->crend(), char_type('\n')).base();
-    const auto line_end   = std::find(end, this->source_->cend(), char_type('\n'));
+    const auto line_begin = std::find(cxx::make_reverse_iterator(begin), this->source()->crend(), char_type('\n')).base();
+    const auto line_end   = std::find(end, this->source()->cend(), char_type('\n'));
 
     const auto reg_lines = make_string(line_begin, line_end);
 
@@ -5104,6 +5404,8 @@ namespace toml
 {
 
 // A struct to contain location in a toml file.
+// It keeps the region and computes line numbers and lines when requested, so
+// constructing it (e.g. to pass it to type_config::parse_int) is cheap.
 struct source_location
 {
   public:
@@ -5115,33 +5417,28 @@ struct source_location
     source_location& operator=(source_location const&) = default;
     source_location& operator=(source_location &&)     = default;
 
-    bool is_ok() const noexcept {return this->is_ok_;}
-    std::size_t length() const noexcept {return this->length_;}
+    bool is_ok() const noexcept {return this->region_.is_ok();}
+    std::size_t length() const noexcept {return this->region_.length();}
 
-    std::size_t first_line_number()   const noexcept {return this->first_line_;}
-    std::size_t first_column_number() const noexcept {return this->first_column_;}
-    std::size_t last_line_number()    const noexcept {return this->last_line_;}
-    std::size_t last_column_number()  const noexcept {return this->last_column_;}
+    std::size_t first_line_number()   const;
+    std::size_t first_column_number() const;
+    std::size_t last_line_number()    const;
+    std::size_t last_column_number()  const;
 
-    std::string const& file_name()  const noexcept {return this->file_name_;}
+    std::string const& file_name() const noexcept;
 
-    std::size_t num_lines() const noexcept {return this->line_str_.size();}
+    std::size_t num_lines() const {return this->lines().size();}
 
     std::string const& first_line() const;
     std::string const& last_line() const;
 
-    std::vector<std::string> const& lines() const noexcept {return line_str_;}
+    std::vector<std::string> const& lines() const;
 
   private:
 
-    bool        is_ok_;
-    std::size_t first_line_;
-    std::size_t first_column_;
-    std::size_t last_line_;
-    std::size_t last_column_;
-    std::size_t length_;
-    std::string file_name_;
-    std::vector<std::string> line_str_;
+    detail::region region_;
+    mutable bool line_str_ready_;
+    mutable std::vector<std::string> line_str_;
 };
 
 namespace detail
@@ -5224,42 +5521,61 @@ namespace toml
 {
 
 TOML11_INLINE source_location::source_location(const detail::region& r)
-    : is_ok_(false),
-      first_line_(1),
-      first_column_(1),
-      last_line_(1),
-      last_column_(1),
-      length_(0),
-      file_name_("unknown file")
+    : region_(r), line_str_ready_(false)
+{}
+
+// if the region is not available, it points (1, 1) in "unknown file".
+TOML11_INLINE std::size_t source_location::first_line_number() const
+{
+    return this->is_ok() ? this->region_.first_line_number() : 1;
+}
+TOML11_INLINE std::size_t source_location::first_column_number() const
+{
+    return this->is_ok() ? this->region_.first_column_number() : 1;
+}
+TOML11_INLINE std::size_t source_location::last_line_number() const
+{
+    return this->is_ok() ? this->region_.last_line_number() : 1;
+}
+TOML11_INLINE std::size_t source_location::last_column_number() const
+{
+    return this->is_ok() ? this->region_.last_column_number() : 1;
+}
+
+TOML11_INLINE std::string const& source_location::file_name() const noexcept
 {
-    if(r.is_ok())
+    static const std::string unknown("unknown file");
+    return this->is_ok() ? this->region_.source_name() : unknown;
+}
+
+TOML11_INLINE std::vector<std::string> const& source_location::lines() const
+{
+    if( ! this->line_str_ready_)
     {
-        this->is_ok_        = true;
-        this->file_name_    = r.source_name();
-        this->first_line_   = r.first_line_number();
-        this->first_column_ = r.first_column_number();
-        this->last_line_    = r.last_line_number();
-        this->last_column_  = r.last_column_number();
-        this->length_       = r.length();
-        this->line_str_     = r.as_lines();
+        if(this->is_ok())
+        {
+            this->line_str_ = this->region_.as_lines();
+        }
+        this->line_str_ready_ = true;
     }
+    return this->line_str_;
 }
 
 TOML11_INLINE std::string const& source_location::first_line() const
 {
-    if(this->line_str_.size() == 0)
+    if(this->lines().size() == 0)
     {
         throw std::out_of_range("toml::source_location::first_line: `lines` is empty");
     }
-    return this->line_str_.front();
+    return this->lines().front();
 }
 TOML11_INLINE std::string const& source_location::last_line() const
 {
-    if(this->line_str_.size() == 0)
+    if(this->lines().size() == 0)
     {
         throw std::out_of_range("toml::source_location::first_line: `lines` is empty");
     }
-    return this->line_str_.back();
+    return this->lines().back();
 }
 
 namespace detail
@@ -7933,113 +8249,100 @@ class basic_value;
 // integer_type as {dec, hex, oct, bin}-integer. But, in most cases, operator<<
 // is enough. To make config easy, we provide the default read functions.
 //
-// Before this functions is called, syntax is checked and prefix(`0x` etc) and
-// spacer(`_`) are removed.
+// Before this functions is called, syntax is checked and prefix(`0x` etc) is
+// removed. The default functions skip spacers(`_`) by themselves, so the
+// parser passes the bytes in the source as they are.
 
 template<typename T>
 result<T, error_info>
-read_dec_int(const std::string& str, const source_location src)
+read_int(const char* first, const char* last, const source_location src,
+         const std::uint8_t base)
 {
-    constexpr auto max_digits = std::numeric_limits<T>::digits;
-    assert( ! str.empty());
+    assert(base == 10 || base == 16 || base == 8 || base == 2);
+    assert(first != last);
+
+    bool negative = false;
+    if(*first == '+' || *first == '-')
+    {
+        negative = (*first == '-');
+        ++first;
+    }
 
+    // accumulate negative values downwards so that the min value can be read
+    const T radix = static_cast<T>(base);
+    const T limit = negative ? (std::numeric_limits<T>::min)() :
+                               (std::numeric_limits<T>::max)();
     T val{0};
-    std::istringstream iss(str);
-    iss >> val;
-    if(iss.fail())
+    bool overflow = false;
+    for(; first != last; ++first)
+    {
+        const char c = *first;
+        if(c == '_') {continue;}
+
+        const T d = static_cast<T>(
+            ('0' <= c && c <= '9') ? c - '0' :
+            ('a' <= c && c <= 'f') ? c - 'a' + 10 : c - 'A' + 10);
+        assert(d < radix);
+
+        if(negative ? (val < (limit + d) / radix) : ((limit - d) / radix < val))
+        {
+            overflow = true;
+            break;
+        }
+        val = negative ? T(val * radix - d) : T(val * radix + d);
+    }
+    if(overflow)
     {
-        return err(make_error_info("toml::parse_dec_integer: "
-            "too large integer: current max digits = 2^" + std::to_string(max_digits),
-            std::move(src), "must be < 2^" + std::to_string(max_digits)));
+        constexpr auto max_digits = std::numeric_limits<T>::digits;
+        switch(base)
+        {
+            case  2: { return err(make_error_info("toml::parse_bin_integer: "
+                "too large integer: current max value = 2^" + std::to_string(max_digits),
+                std::move(src), "must be < 2^" + std::to_string(max_digits))); }
+            case  8: { return err(make_error_info("toml::parse_oct_integer: "
+                "too large integer: current max value = 2^" + std::to_string(max_digits),
+                std::move(src), "must be < 2^" + std::to_string(max_digits))); }
+            case 16: { return err(make_error_info("toml::parse_hex_integer: "
+                "too large integer: current max value = 2^" + std::to_string(max_digits),
+                std::move(src), "must be < 2^" + std::to_string(max_digits))); }
+            default: { return err(make_error_info("toml::parse_dec_integer: "
+                "too large integer: current max digits = 2^" + std::to_string(max_digits),
+                std::move(src), "must be < 2^" + std::to_string(max_digits))); }
+        }
     }
     return ok(val);
 }
 
 template<typename T>
 result<T, error_info>
-read_hex_int(const std::string& str, const source_location src)
+read_dec_int(const std::string& str, const source_location src)
 {
-    constexpr auto max_digits = std::numeric_limits<T>::digits;
     assert( ! str.empty());
+    return read_int<T>(str.data(), str.data() + str.size(), std::move(src), 10);
+}
 
-    T val{0};
-    std::istringstream iss(str);
-    iss >> std::hex >> val;
-    if(iss.fail())
-    {
-        return err(make_error_info("toml::parse_hex_integer: "
-            "too large integer: current max value = 2^" + std::to_string(max_digits),
-            std::move(src), "must be < 2^" + std::to_string(max_digits)));
-    }
-    return ok(val);
+template<typename T>
+result<T, error_info>
+read_hex_int(const std::string& str, const source_location src)
+{
+    assert( ! str.empty());
+    return read_int<T>(str.data(), str.data() + str.size(), std::move(src), 16);
 }
 
 template<typename T>
 result<T, error_info>
 read_oct_int(const std::string& str, const source_location src)
 {
-    constexpr auto max_digits = std::numeric_limits<T>::digits;
     assert( ! str.empty());
-
-    T val{0};
-    std::istringstream iss(str);
-    iss >> std::oct >> val;
-    if(iss.fail())
-    {
-        return err(make_error_info("toml::parse_oct_integer: "
-            "too large integer: current max value = 2^" + std::to_string(max_digits),
-            std::move(src), "must be < 2^" + std::to_string(max_digits)));
-    }
-    return ok(val);
+    return read_int<T>(str.data(), str.data() + str.size(), std::move(src), 8);
 }
 
 template<typename T>
 result<T, error_info>
 read_bin_int(const std::string& str, const source_location src)
 {
-    constexpr auto is_bounded =  std::numeric_limits<T>::is_bounded;
-    constexpr auto max_digits =  std::numeric_limits<T>::digits;
-    const auto max_value  = (std::numeric_limits<T>::max)();
-
-    T val{0};
-    T base{1};
-    for(auto i = str.rbegin(); i != str.rend(); ++i)
-    {
-        const auto c = *i;
-        if(c == '1')
-        {
-            val += base;
-            // prevent `base` from overflow
-            if(is_bounded && max_value / 2 < base && std::next(i) != str.rend())
-            {
-                base = 0;
-            }
-            else
-            {
-                base *= 2;
-            }
-        }
-        else
-        {
-            assert(c == '0');
-
-            if(is_bounded && max_value / 2 < base && std::next(i) != str.rend())
-            {
-                base = 0;
-            }
-            else
-            {
-                base *= 2;
-            }
-        }
-    }
-    if(base == 0)
-    {
-        return err(make_error_info("toml::parse_bin_integer: "
-            "too large integer: current max value = 2^" + std::to_string(max_digits),
-            std::move(src), "must be < 2^" + std::to_string(max_digits)));
-    }
-    return ok(val);
+    assert( ! str.empty());
+    return read_int<T>(str.data(), str.data() + str.size(), std::move(src), 2);
 }
 
 template<typename T>
@@ -8060,9 +8363,64 @@ read_int(const std::string& str, const source_location src, const std::uint8_t b
     }
 }
 
+namespace detail
+{
+// reads a floating point value by std::from_chars. It returns false if
+// std::from_chars is not available for T or fails, e.g. out of range. Then the
+// caller falls back to sscanf or iostream.
+#if defined(TOML11_HAS_FLOAT_CHARCONV)
+template<typename T>
+cxx::enable_if_t<std::is_floating_point<T>::value, bool>
+read_float_chars(const std::string& str, const bool is_hex, T& val) noexcept
+{
+    const char* first = str.data();
+    const char* last  = str.data() + str.size();
+
+    // std::from_chars accepts neither `+` nor the prefix `0x`.
+    bool negative = false;
+    if(first != last && (*first == '+' || *first == '-'))
+    {
+        negative = (*first == '-');
+        ++first;
+    }
+    if(is_hex)
+    {
+        if(last - first < 2) {return false;}
+        first += 2;
+    }
+
+    T v{0};
+    const auto res = std::from_chars(first, last, v,
+        is_hex ? std::chars_format::hex : std::chars_format::general);
+    if(res.ec != std::errc{} || res.ptr != last)
+    {
+        return false;
+    }
+    val = negative ? -v : v;
+    return true;
+}
+template<typename T>
+cxx::enable_if_t<cxx::negation<std::is_floating_point<T>>::value, bool>
+read_float_chars(const std::string&, const bool, T&) noexcept
+{
+    return false;
+}
+#else
+template<typename T>
+bool read_float_chars(const std::string&, const bool, T&) noexcept
+{
+    return false;
+}
+#endif
+} // detail
+
 inline result<float, error_info>
 read_hex_float(const std::string& str, const source_location src, float val)
 {
+    if(detail::read_float_chars(str, true, val))
+    {
+        return ok(val);
+    }
 #if defined(_MSC_VER) && ! defined(__clang__)
     const auto res = ::sscanf_s(str.c_str(), "%a", std::addressof(val));
 #else
@@ -8079,6 +8437,10 @@ read_hex_float(const std::string& str, const source_location src, float val)
 inline result<double, error_info>
 read_hex_float(const std::string& str, const source_location src, double val)
 {
+    if(detail::read_float_chars(str, true, val))
+    {
+        return ok(val);
+    }
 #if defined(_MSC_VER) && ! defined(__clang__)
     const auto res = ::sscanf_s(str.c_str(), "%la", std::addressof(val));
 #else
@@ -8109,6 +8471,11 @@ result<T, error_info>
 read_dec_float(const std::string& str, const source_location src)
 {
     T val;
+    if(detail::read_float_chars(str, false, val))
+    {
+        return ok(val);
+    }
+
     std::istringstream iss(str);
     iss >> val;
     if(iss.fail())
@@ -8153,6 +8520,12 @@ struct type_config
     {
         return read_int<integer_type>(str, src, base);
     }
+    static result<integer_type, error_info>
+    parse_int(const char* first, const char* last, const source_location src,
+              const std::uint8_t base)
+    {
+        return read_int<integer_type>(first, last, src, base);
+    }
     static result<floating_type, error_info>
     parse_float(const std::string& str, const source_location src, const bool is_hex)
     {
@@ -8183,6 +8556,12 @@ struct ordered_type_config
     {
         return read_int<integer_type>(str, src, base);
     }
+    static result<integer_type, error_info>
+    parse_int(const char* first, const char* last, const source_location src,
+              const std::uint8_t base)
+    {
+        return read_int<integer_type>(first, last, src, base);
+    }
     static result<floating_type, error_info>
     parse_float(const std::string& str, const source_location src, const bool is_hex)
     {
@@ -8263,6 +8642,21 @@ struct has_parse_int_impl
 template<typename T>
 using has_parse_int = decltype(has_parse_int_impl::check<T>(nullptr));
 
+// optional. if a type_config has it, parser passes the bytes in the source
+// directly to it without copying them into a std::string.
+struct has_parse_int_chars_impl
+{
+    template<typename T> static std::true_type  check(decltype(std::declval<T>().parse_int(
+            std::declval<const char*>(),
+            std::declval<const char*>(),
+            std::declval<const source_location>(),
+            std::declval<const std::uint8_t>()
+        ))*);
+    template<typename T> static std::false_type check(...);
+};
+template<typename T>
+using has_parse_int_chars = decltype(has_parse_int_chars_impl::check<T>(nullptr));
+
 struct has_parse_float_impl
 {
     template<typename T> static std::true_type  check(decltype(std::declval<T>().parse_float(
@@ -9514,13 +9908,36 @@ namespace toml
 namespace detail
 {
 
+// scanners whose grammar depends on the spec flags. Since those are resolved
+// at compile time (see static_syntax), we select the instantiation once per
+// spec and keep the function pointers here.
+struct spec_syntax
+{
+    using scanner_type = bool(*)(location&);
+
+    explicit spec_syntax(const spec& s) noexcept;
+
+    scanner_type comment;
+    scanner_type local_time;
+    scanner_type local_datetime;
+    scanner_type offset_datetime;
+    scanner_type basic_string;
+    scanner_type ml_basic_string;
+    scanner_type unquoted_key;
+    scanner_type std_table;
+    scanner_type array_table;
+};
+
 template<typename TypeConfig>
 class context
 {
+  public:
+    using key_type = typename TypeConfig::string_type;
+
   public:
 
     explicit context(const spec& toml_spec)
-        : toml_spec_(toml_spec), errors_{}
+        : toml_spec_(toml_spec), syntax_(toml_spec), errors_{}, sections_{}
     {}
 
     bool has_error() const noexcept {return !errors_.empty();}
@@ -9533,6 +9950,8 @@ class context
     spec&       toml_spec()       noexcept {return toml_spec_;}
     spec const& toml_spec() const noexcept {return toml_spec_;}
 
+    spec_syntax const& syntax() const noexcept {return syntax_;}
+
     void report_error(error_info err)
     {
         this->errors_.push_back(std::move(err));
@@ -9546,10 +9965,19 @@ class context
         return e;
     }
 
+    // tables to parse, if only some of them are needed. empty means all.
+    std::vector<std::vector<key_type>> const& sections() const noexcept {return sections_;}
+    void set_sections(std::vector<std::vector<key_type>> sections)
+    {
+        this->sections_ = std::move(sections);
+    }
+
   private:
 
     spec toml_spec_;
+    spec_syntax syntax_;
     std::vector<error_info> errors_;
+    std::vector<std::vector<key_type>> sections_;
 };
 
 } // detail
@@ -10438,559 +10866,1675 @@ TOML11_INLINE std::string maybe::name() const
 #endif
 
 #endif // TOML11_SCANNER_HPP
-#ifndef TOML11_SYNTAX_HPP
-#define TOML11_SYNTAX_HPP
+#ifndef TOML11_SIMD_HPP
+#define TOML11_SIMD_HPP
 
-#ifndef TOML11_SYNTAX_FWD_HPP
-#define TOML11_SYNTAX_FWD_HPP
+#ifndef TOML11_SIMD_FWD_HPP
+#define TOML11_SIMD_FWD_HPP
+
+
+#include <cstdint>
 
+#if defined(TOML11_HAS_SSE2)
+#include <emmintrin.h>
+#endif
+#if defined(TOML11_HAS_RUNTIME_AVX2)
+#include <immintrin.h>
+#endif
 
 namespace toml
 {
 namespace detail
 {
-namespace syntax
+namespace simd
 {
 
-using char_type = location::char_type;
+using byte = unsigned char;
 
-// ===========================================================================
-// UTF-8
+// Kernels that skip runs of bytes in [first, last). Each returns the first
+// position that does not belong to the run (or `last`). They do not look at
+// bytes outside of [first, last).
+//
+// The implementation (AVX2, SSE2 or scalar) is selected once at runtime.
 
-// avoid redundant representation and out-of-unicode sequence
+// skips ' ' and '\t'.
+const byte* skip_blank(const byte* first, const byte* last) noexcept;
 
-character_in_range utf8_1byte (const spec&);
-sequence           utf8_2bytes(const spec&);
-sequence           utf8_3bytes(const spec&);
-sequence           utf8_4bytes(const spec&);
+// skips ASCII characters allowed in a comment. It stops at a newline,
+// a non-ASCII byte (that should be checked as UTF-8 by the caller), or
+// a disallowed control character.
+const byte* skip_comment_ascii(const byte* first, const byte* last,
+                               const bool allow_control_chars) noexcept;
 
-class non_ascii final : public scanner_base
-{
-  public:
+// skips printable ASCII characters and tabs in a one-line string. It stops at
+// `quote`, `escape`, a non-ASCII byte, or a control character. Pass the same
+// character to both if the string has no escape sequence.
+const byte* skip_string_ascii(const byte* first, const byte* last,
+                              const byte quote, const byte escape) noexcept;
 
-    using char_type = location::char_type;
+// returns the position of the next '\n' or `last`.
+const byte* find_newline(const byte* first, const byte* last) noexcept;
 
-  public:
+} // simd
+} // detail
+} // toml
+#endif // TOML11_SIMD_FWD_HPP
 
-    explicit non_ascii(const spec& s) noexcept;
-    ~non_ascii() override = default;
+#if ! defined(TOML11_COMPILE_SOURCES)
+#ifndef TOML11_SIMD_IMPL_HPP
+#define TOML11_SIMD_IMPL_HPP
 
-    region scan(location& loc) const override
-    {
-        return scanner_.scan(loc);
-    }
+#include <cstring>
 
-    std::string expected_chars(location&) const override
-    {
-        return "non-ascii utf-8 bytes";
-    }
+namespace toml
+{
+namespace detail
+{
+namespace simd
+{
+namespace kernel
+{
 
-    scanner_base* clone() const override
-    {
-        return new non_ascii(*this);
-    }
+inline int count_trailing_zeros(const std::uint32_t x) noexcept
+{
+    assert(x != 0);
+#if defined(__GNUC__)
+    return __builtin_ctz(x);
+#else
+    int n = 0;
+    while(((x >> n) & 1u) == 0) {++n;}
+    return n;
+#endif
+}
 
-    std::string name() const override
+inline bool is_blank(const byte c) noexcept
+{
+    return c == ' ' || c == '\t';
+}
+inline bool is_comment_ascii(const byte c, const bool allow_control_chars) noexcept
+{
+    if(allow_control_chars)
     {
-        return "non_ascii";
+        return (0x01 <= c && c <= 0x09) || (0x0E <= c && c <= 0x7F);
     }
+    return c == 0x09 || (0x20 <= c && c <= 0x7E);
+}
+inline bool is_string_ascii(const byte c, const byte quote, const byte escape) noexcept
+{
+    return (c == 0x09 || (0x20 <= c && c <= 0x7E)) && c != quote && c != escape;
+}
 
-  private:
-
-    either scanner_;
-};
-
-// ===========================================================================
-// Whitespace
-
-character_either wschar(const spec&);
-
-repeat_at_least ws(const spec& s);
-
-// ===========================================================================
-// Newline
-
-either newline(const spec&);
-
-// ===========================================================================
-// Comments
-
-either allowed_comment_char(const spec& s);
-
-// XXX Note that it does not take newline
-sequence comment(const spec& s);
-
-// ===========================================================================
-// Boolean
-
-either boolean(const spec&);
-
-// ===========================================================================
-// Integer
+// ----------------------------------------------------------------------------
+// scalar
 
-class digit final : public scanner_base
+inline const byte* skip_blank_scalar(const byte* first, const byte* last) noexcept
 {
-  public:
-
-    using char_type = location::char_type;
+    while(first != last && is_blank(*first)) {++first;}
+    return first;
+}
+inline const byte* skip_comment_ascii_scalar(const byte* first, const byte* last,
+                                             const bool allow_control_chars) noexcept
+{
+    while(first != last && is_comment_ascii(*first, allow_control_chars)) {++first;}
+    return first;
+}
+inline const byte* skip_string_ascii_scalar(const byte* first, const byte* last,
+                                            const byte quote, const byte escape) noexcept
+{
+    while(first != last && is_string_ascii(*first, quote, escape)) {++first;}
+    return first;
+}
 
-  public:
+// ----------------------------------------------------------------------------
+// SSE2
 
-    explicit digit(const spec&) noexcept;
-    ~digit() override = default;
+#if defined(TOML11_HAS_SSE2)
 
-    region scan(location& loc) const override
+// mask of bytes that stop the run. bytes >= 0x80 are negative as int8.
+inline __m128i not_blank_sse2(const __m128i x) noexcept
+{
+    const __m128i sp = _mm_cmpeq_epi8(x, _mm_set1_epi8(' '));
+    const __m128i tb = _mm_cmpeq_epi8(x, _mm_set1_epi8('\t'));
+    return _mm_xor_si128(_mm_or_si128(sp, tb), _mm_set1_epi8(-1));
+}
+inline __m128i not_comment_ascii_sse2(const __m128i x, const bool allow_control_chars) noexcept
+{
+    if(allow_control_chars)
     {
-        return scanner_.scan(loc);
+        // stop at 0x00, 0x0A-0x0D and non-ASCII
+        const __m128i nul  = _mm_cmpeq_epi8(x, _mm_setzero_si128());
+        const __m128i ctrl = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(0x09)),
+                                           _mm_cmplt_epi8(x, _mm_set1_epi8(0x0E)));
+        const __m128i high = _mm_cmplt_epi8(x, _mm_setzero_si128());
+        return _mm_or_si128(_mm_or_si128(nul, ctrl), high);
     }
+    // stop at control chars except for tab, DEL, and non-ASCII
+    const __m128i low = _mm_andnot_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(0x09)),
+                                         _mm_cmplt_epi8(x, _mm_set1_epi8(0x20)));
+    const __m128i del = _mm_cmpeq_epi8(x, _mm_set1_epi8(0x7F));
+    return _mm_or_si128(low, del);
+}
 
-    std::string expected_chars(location&) const override
+inline const byte* skip_blank_sse2(const byte* first, const byte* last) noexcept
+{
+    while(last - first >= 16)
     {
-        return "digit [0-9]";
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(not_blank_sse2(x)));
+        if(mask != 0) {return first + count_trailing_zeros(mask);}
+        first += 16;
     }
-
-    scanner_base* clone() const override
+    return skip_blank_scalar(first, last);
+}
+inline const byte* skip_comment_ascii_sse2(const byte* first, const byte* last,
+                                           const bool allow_control_chars) noexcept
+{
+    while(last - first >= 16)
     {
-        return new digit(*this);
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(
+                    not_comment_ascii_sse2(x, allow_control_chars)));
+        if(mask != 0) {return first + count_trailing_zeros(mask);}
+        first += 16;
     }
-
-    std::string name() const override
+    return skip_comment_ascii_scalar(first, last, allow_control_chars);
+}
+inline const byte* skip_string_ascii_sse2(const byte* first, const byte* last,
+                                          const byte quote, const byte escape) noexcept
+{
+    const __m128i q = _mm_set1_epi8(static_cast<char>(quote));
+    const __m128i e = _mm_set1_epi8(static_cast<char>(escape));
+    while(last - first >= 16)
     {
-        return "digit";
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        // the same as comments (non-ASCII is negative, < 0x20) + quote/escape
+        const __m128i stop = _mm_or_si128(not_comment_ascii_sse2(x, false),
+                _mm_or_si128(_mm_cmpeq_epi8(x, q), _mm_cmpeq_epi8(x, e)));
+        const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(stop));
+        if(mask != 0) {return first + count_trailing_zeros(mask);}
+        first += 16;
     }
+    return skip_string_ascii_scalar(first, last, quote, escape);
+}
+#endif // TOML11_HAS_SSE2
 
-  private:
+// ----------------------------------------------------------------------------
+// AVX2
 
-    character_in_range scanner_;
-};
+#if defined(TOML11_HAS_RUNTIME_AVX2)
 
-class alpha final : public scanner_base
+__attribute__((target("avx2")))
+inline const byte* skip_blank_avx2(const byte* first, const byte* last) noexcept
 {
-  public:
-
-    using char_type = location::char_type;
+    while(last - first >= 32)
+    {
+        const __m256i x  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        const __m256i sp = _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' '));
+        const __m256i tb = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\t'));
+        const auto mask = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(sp, tb)));
+        if(mask != 0) {return first + count_trailing_zeros(mask);}
+        first += 32;
+    }
+    return skip_blank_sse2(first, last);
+}
 
-  public:
-
-    explicit alpha(const spec&) noexcept;
-    ~alpha() override = default;
-
-    region scan(location& loc) const override
+__attribute__((target("avx2")))
+inline const byte* skip_comment_ascii_avx2(const byte* first, const byte* last,
+                                           const bool allow_control_chars) noexcept
+{
+    while(last - first >= 32)
     {
-        return scanner_.scan(loc);
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        __m256i stop;
+        if(allow_control_chars)
+        {
+            const __m256i nul  = _mm256_cmpeq_epi8(x, _mm256_setzero_si256());
+            const __m256i ctrl = _mm256_and_si256(
+                _mm256_cmpgt_epi8(x, _mm256_set1_epi8(0x09)),
+                _mm256_cmpgt_epi8(_mm256_set1_epi8(0x0E), x));
+            const __m256i high = _mm256_cmpgt_epi8(_mm256_setzero_si256(), x);
+            stop = _mm256_or_si256(_mm256_or_si256(nul, ctrl), high);
+        }
+        else
+        {
+            const __m256i low = _mm256_andnot_si256(
+                _mm256_cmpeq_epi8(x, _mm256_set1_epi8(0x09)),
+                _mm256_cmpgt_epi8(_mm256_set1_epi8(0x20), x));
+            const __m256i del = _mm256_cmpeq_epi8(x, _mm256_set1_epi8(0x7F));
+            stop = _mm256_or_si256(low, del);
+        }
+        const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(stop));
+        if(mask != 0) {return first + count_trailing_zeros(mask);}
+        first += 32;
     }
+    return skip_comment_ascii_sse2(first, last, allow_control_chars);
+}
 
-    std::string expected_chars(location&) const override
+__attribute__((target("avx2")))
+inline const byte* skip_string_ascii_avx2(const byte* first, const byte* last,
+                                          const byte quote, const byte escape) noexcept
+{
+    const __m256i q = _mm256_set1_epi8(static_cast<char>(quote));
+    const __m256i e = _mm256_set1_epi8(static_cast<char>(escape));
+    while(last - first >= 32)
     {
-        return "alpha [a-zA-Z]";
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        const __m256i low = _mm256_andnot_si256(
+            _mm256_cmpeq_epi8(x, _mm256_set1_epi8(0x09)),
+            _mm256_cmpgt_epi8(_mm256_set1_epi8(0x20), x));
+        const __m256i del = _mm256_cmpeq_epi8(x, _mm256_set1_epi8(0x7F));
+        const __m256i stop = _mm256_or_si256(_mm256_or_si256(low, del),
+            _mm256_or_si256(_mm256_cmpeq_epi8(x, q), _mm256_cmpeq_epi8(x, e)));
+        const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(stop));
+        if(mask != 0) {return first + count_trailing_zeros(mask);}
+        first += 32;
     }
+    return skip_string_ascii_sse2(first, last, quote, escape);
+}
+#endif // TOML11_HAS_RUNTIME_AVX2
 
-    scanner_base* clone() const override
-    {
-        return new alpha(*this);
-    }
+struct kernel_table
+{
+    const byte* (*skip_blank)(const byte*, const byte*);
+    const byte* (*skip_comment_ascii)(const byte*, const byte*, const bool);
+    const byte* (*skip_string_ascii)(const byte*, const byte*, const byte, const byte);
+};
 
-    std::string name() const override
+inline kernel_table select_kernels() noexcept
+{
+#if defined(TOML11_HAS_RUNTIME_AVX2)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
     {
-        return "alpha";
+        return kernel_table{&skip_blank_avx2, &skip_comment_ascii_avx2,
+                            &skip_string_ascii_avx2};
     }
+#endif
+#if defined(TOML11_HAS_SSE2)
+    return kernel_table{&skip_blank_sse2, &skip_comment_ascii_sse2,
+                        &skip_string_ascii_sse2};
+#else
+    return kernel_table{&skip_blank_scalar, &skip_comment_ascii_scalar,
+                        &skip_string_ascii_scalar};
+#endif
+}
 
-  private:
-
-    either scanner_;
-};
-
-class hexdig final : public scanner_base
+inline kernel_table const& kernels() noexcept
 {
-  public:
-
-    using char_type = location::char_type;
-
-  public:
+    static const kernel_table table = select_kernels();
+    return table;
+}
 
-    explicit hexdig(const spec& s) noexcept;
-    ~hexdig() override = default;
+} // kernel
 
-    region scan(location& loc) const override
-    {
-        return scanner_.scan(loc);
-    }
+// most of the runs are empty or short. check the first byte before
+// dispatching to the kernel.
 
-    std::string expected_chars(location&) const override
-    {
-        return "hex [0-9a-fA-F]";
-    }
+TOML11_INLINE const byte* skip_blank(const byte* first, const byte* last) noexcept
+{
+    if(first == last || ! kernel::is_blank(*first)) {return first;}
+    return kernel::kernels().skip_blank(first + 1, last);
+}
 
-    scanner_base* clone() const override
+TOML11_INLINE const byte* skip_comment_ascii(const byte* first, const byte* last,
+                                             const bool allow_control_chars) noexcept
+{
+    if(first == last || ! kernel::is_comment_ascii(*first, allow_control_chars))
     {
-        return new hexdig(*this);
+        return first;
     }
+    return kernel::kernels().skip_comment_ascii(first + 1, last, allow_control_chars);
+}
 
-    std::string name() const override
+TOML11_INLINE const byte* skip_string_ascii(const byte* first, const byte* last,
+                                            const byte quote, const byte escape) noexcept
+{
+    if(first == last || ! kernel::is_string_ascii(*first, quote, escape))
     {
-        return "hexdig";
+        return first;
     }
+    return kernel::kernels().skip_string_ascii(first + 1, last, quote, escape);
+}
 
-  private:
-
-    either scanner_;
-};
-
-sequence num_suffix(const spec& s);
-
-sequence dec_int(const spec& s);
-sequence hex_int(const spec& s);
-sequence oct_int(const spec&);
-sequence bin_int(const spec&);
-either   integer(const spec& s);
-
-// ===========================================================================
-// Floating
+TOML11_INLINE const byte* find_newline(const byte* first, const byte* last) noexcept
+{
+    if(first == last) {return last;}
+    const void* found = std::memchr(first, '\n', static_cast<std::size_t>(last - first));
+    return found ? static_cast<const byte*>(found) : last;
+}
 
-sequence zero_prefixable_int(const spec& s);
-sequence fractional_part(const spec& s);
-sequence exponent_part(const spec& s);
-sequence hex_floating(const spec& s);
-either   floating(const spec& s);
+} // simd
+} // detail
+} // toml
+#endif // TOML11_SIMD_IMPL_HPP
+#endif
 
-// ===========================================================================
-// Datetime
+#endif // TOML11_SIMD_HPP
+#ifndef TOML11_STATIC_SCANNER_HPP
+#define TOML11_STATIC_SCANNER_HPP
 
-sequence local_date(const spec& s);
-sequence local_time(const spec& s);
-either time_offset(const spec& s);
-sequence full_time(const spec& s);
-character_either time_delim(const spec&);
-sequence local_datetime(const spec& s);
-sequence offset_datetime(const spec& s);
+#ifndef TOML11_STATIC_SCANNER_FWD_HPP
+#define TOML11_STATIC_SCANNER_FWD_HPP
 
-// ===========================================================================
-// String
 
-sequence escaped(const spec& s);
+#include <string>
+#include <type_traits>
 
-either basic_char(const spec& s);
+namespace toml
+{
+namespace detail
+{
 
-sequence basic_string(const spec& s);
+// ----------------------------------------------------------------------------
+// Scanners composed at compile time.
+//
+// Each scanner is a type that has `static bool scan(location&)`. It returns
+// true and advances `loc` if it matches. Otherwise it returns false and keeps
+// `loc` unchanged. Since the whole grammar is a type, it does not allocate and
+// can be inlined. The runtime scanners in scanner.hpp are still used to
+// generate error messages through `expected_chars`.
 
-// ---------------------------------------------------------------------------
-// multiline string
+namespace static_scanner
+{
 
-sequence escaped_newline(const spec& s);
-sequence ml_basic_string(const spec& s);
+using char_type = location::char_type;
 
-// ---------------------------------------------------------------------------
-// literal string
+template<char_type C>
+struct character
+{
+    static bool scan(location& loc)
+    {
+        if(loc.eof() || loc.current() != C) {return false;}
+        loc.advance(1);
+        return true;
+    }
+};
 
-either literal_char(const spec& s);
-sequence literal_string(const spec& s);
+template<char_type From, char_type To>
+struct character_in_range
+{
+    static bool scan(location& loc)
+    {
+        if(loc.eof()) {return false;}
+        const auto c = loc.current();
+        if(c < From || To < c) {return false;}
+        loc.advance(1);
+        return true;
+    }
+};
 
-sequence ml_literal_string(const spec& s);
+template<char_type ... Cs>
+struct character_either;
 
-either string(const spec& s);
+template<>
+struct character_either<>
+{
+    static bool contains(const char_type) noexcept {return false;}
+};
 
-// ===========================================================================
-// Keys
+template<char_type C, char_type ... Cs>
+struct character_either<C, Cs...>
+{
+    static bool contains(const char_type c) noexcept
+    {
+        return c == C || character_either<Cs...>::contains(c);
+    }
+    static bool scan(location& loc)
+    {
+        if(loc.eof() || ! contains(loc.current())) {return false;}
+        loc.advance(1);
+        return true;
+    }
+};
 
-// to keep `expected_chars` simple
-class non_ascii_key_char final : public scanner_base
+template<char_type ... Cs>
+struct literal
 {
-  public:
+    static bool scan(location& loc)
+    {
+        constexpr std::size_t size = sizeof...(Cs);
+        const char_type value[size] = {Cs...};
 
-    using char_type = location::char_type;
+        const auto& src = *loc.source();
+        const auto  pos = loc.get_location();
+        if(src.size() < pos + size) {return false;}
+        for(std::size_t i=0; i<size; ++i)
+        {
+            if(src[pos + i] != value[i]) {return false;}
+        }
+        loc.advance(size);
+        return true;
+    }
+};
 
-  private:
+template<typename ... Ss>
+struct sequence;
 
-    using in_range = character_in_range; // make definition short
+template<>
+struct sequence<>
+{
+    static bool scan(location&) noexcept {return true;}
+};
 
-  public:
+template<typename S, typename ... Ss>
+struct sequence<S, Ss...>
+{
+    static bool scan(location& loc)
+    {
+        const auto first = loc.get_location();
+        if(S::scan(loc) && sequence<Ss...>::scan(loc))
+        {
+            return true;
+        }
+        loc.set_location(first);
+        return false;
+    }
+};
 
-    explicit non_ascii_key_char(const spec& s) noexcept;
-    ~non_ascii_key_char() override = default;
+// either<> never matches. It is used to disable an alternative.
+template<typename ... Ss>
+struct either;
 
-    region scan(location& loc) const override;
+template<>
+struct either<>
+{
+    static bool scan(location&) noexcept {return false;}
+};
 
-    std::string expected_chars(location&) const override
+template<typename S, typename ... Ss>
+struct either<S, Ss...>
+{
+    static bool scan(location& loc)
     {
-        return "bare key non-ASCII script";
+        return S::scan(loc) || either<Ss...>::scan(loc);
     }
+};
 
-    scanner_base* clone() const override
+template<std::size_t N, typename S>
+struct repeat_exact
+{
+    static bool scan(location& loc)
     {
-        return new non_ascii_key_char(*this);
+        const auto first = loc.get_location();
+        for(std::size_t i=0; i<N; ++i)
+        {
+            if( ! S::scan(loc))
+            {
+                loc.set_location(first);
+                return false;
+            }
+        }
+        return true;
     }
+};
 
-    std::string name() const override
+template<std::size_t N, typename S>
+struct repeat_at_least
+{
+    static bool scan(location& loc)
     {
-        return "non-ASCII bare key";
+        if( ! repeat_exact<N, S>::scan(loc))
+        {
+            return false;
+        }
+        while( ! loc.eof())
+        {
+            const auto checkpoint = loc.get_location();
+            if( ! S::scan(loc) || checkpoint == loc.get_location())
+            {
+                break;
+            }
+        }
+        return true;
     }
+};
 
-  private:
-
-    std::uint32_t read_utf8(location& loc) const;
+template<typename S>
+struct maybe
+{
+    static bool scan(location& loc)
+    {
+        S::scan(loc);
+        return true;
+    }
 };
 
+// returns the matched region, or an invalid region if not matched.
+template<typename S>
+region scan_region(location& loc)
+{
+    const auto first = loc;
+    if(S::scan(loc))
+    {
+        return region(first, loc);
+    }
+    return region{};
+}
 
-repeat_at_least unquoted_key(const spec& s);
+inline region scan_region(bool(*scanner)(location&), location& loc)
+{
+    const auto first = loc;
+    if(scanner(loc))
+    {
+        return region(first, loc);
+    }
+    return region{};
+}
 
-either quoted_key(const spec& s);
+// [first, loc) as a string. faster than region::as_string if we don't need
+// the line and column numbers.
+inline std::string scanned_string(const std::size_t first, const location& loc)
+{
+    const auto& src = *loc.source();
+    return make_string(
+        std::next(src.begin(), static_cast<location::difference_type>(first)),
+        std::next(src.begin(), static_cast<location::difference_type>(loc.get_location())));
+}
 
-either simple_key(const spec& s);
+} // static_scanner
 
-sequence dot_sep(const spec& s);
+// ----------------------------------------------------------------------------
+// TOML grammar written in static_scanner. see syntax.hpp for the runtime ones.
+//
+// The rules that depend on the spec flags take them as template arguments.
+// `spec_syntax` picks the instantiation for a spec once.
+
+namespace static_syntax
+{
+// to avoid conflicts with the runtime scanners in toml::detail
+using static_scanner::character;
+using static_scanner::character_in_range;
+using static_scanner::character_either;
+using static_scanner::literal;
+using static_scanner::sequence;
+using static_scanner::either;
+using static_scanner::repeat_exact;
+using static_scanner::repeat_at_least;
+using static_scanner::maybe;
 
-sequence dotted_key(const spec& s);
+// ===========================================================================
+// UTF-8
 
+struct utf8_2bytes : sequence<
+    character_in_range<0xC2, 0xDF>, character_in_range<0x80, 0xBF>
+    >{};
 
-class key final : public scanner_base
-{
-  public:
+struct utf8_3bytes : sequence<either<
+        sequence<character         <0xE0>,       character_in_range<0xA0, 0xBF>>,
+        sequence<character_in_range<0xE1, 0xEC>, character_in_range<0x80, 0xBF>>,
+        sequence<character         <0xED>,       character_in_range<0x80, 0x9F>>,
+        sequence<character_in_range<0xEE, 0xEF>, character_in_range<0x80, 0xBF>>
+    >, character_in_range<0x80, 0xBF>>{};
 
-    using char_type = location::char_type;
+struct utf8_4bytes : sequence<either<
+        sequence<character         <0xF0>,       character_in_range<0x90, 0xBF>>,
+        sequence<character_in_range<0xF1, 0xF3>, character_in_range<0x80, 0xBF>>,
+        sequence<character         <0xF4>,       character_in_range<0x80, 0x8F>>
+    >, character_in_range<0x80, 0xBF>, character_in_range<0x80, 0xBF>>{};
 
-  public:
+struct non_ascii : either<utf8_2bytes, utf8_3bytes, utf8_4bytes>{};
 
-    explicit key(const spec& s) noexcept;
-    ~key() override = default;
+// ===========================================================================
+// Whitespace, Newline, Comment
 
-    region scan(location& loc) const override
+struct wschar  : character_either<' ', '\t'>{};
+struct ws
+{
+    // equivalent to repeat_at_least<0, wschar>
+    static bool scan(location& loc) noexcept
     {
-        return scanner_.scan(loc);
+        if(loc.eof()) {return true;}
+        const auto& src  = *loc.source();
+        const auto* head = src.data() + loc.get_location();
+        const auto* tail = src.data() + src.size();
+        const auto* stop = simd::skip_blank(head, tail);
+        loc.advance(static_cast<std::size_t>(stop - head));
+        return true;
     }
+};
+struct newline : either<character<'\n'>, literal<'\r', '\n'>>{};
 
-    std::string expected_chars(location&) const override
-    {
-        return "basic key([a-zA-Z0-9_-]) or quoted key(\" or ')";
-    }
+template<bool AllowControlChars>
+struct allowed_comment_char : std::conditional<AllowControlChars,
+        either<character_in_range<0x01, 0x09>, character_in_range<0x0E, 0x7F>, non_ascii>,
+        either<character<0x09>,                character_in_range<0x20, 0x7E>, non_ascii>
+    >::type {};
 
-    scanner_base* clone() const override
+// XXX Note that it does not take newline
+template<bool AllowControlChars>
+struct comment
+{
+    // equivalent to
+    // sequence<character<'#'>, repeat_at_least<0, allowed_comment_char<Ctrl>>>
+    static bool scan(location& loc) noexcept
     {
-        return new key(*this);
-    }
-
-    std::string name() const override
-    {
-        return "key";
-    }
+        if(loc.current() != '#') {return false;}
+        loc.advance();
 
-  private:
+        const auto& src  = *loc.source();
+        const auto* tail = src.data() + src.size();
+        while( ! loc.eof())
+        {
+            // ASCII part never contains a newline, so line number is kept
+            const auto* head = src.data() + loc.get_location();
+            const auto* stop = simd::skip_comment_ascii(head, tail, AllowControlChars);
+            loc.advance(static_cast<std::size_t>(stop - head));
 
-    either scanner_;
+            if(loc.eof() || loc.current() < 0x80 || ! non_ascii::scan(loc))
+            {
+                break;
+            }
+        }
+        return true;
+    }
 };
 
-sequence keyval_sep(const spec& s);
-
 // ===========================================================================
-// Table key
-
-sequence std_table(const spec& s);
+// Boolean
 
-sequence array_table(const spec& s);
+struct boolean : either<
+        literal<'t', 'r', 'u', 'e'>, literal<'f', 'a', 'l', 's', 'e'>
+    >{};
 
 // ===========================================================================
-// extension: null
+// Integer
 
-literal null_value(const spec&);
+struct digit  : character_in_range<'0', '9'>{};
+struct alpha  : either<character_in_range<'a', 'z'>, character_in_range<'A', 'Z'>>{};
+struct hexdig : either<digit, character_in_range<'a', 'f'>, character_in_range<'A', 'F'>>{};
+struct sign   : character_either<'-', '+'>{};
 
-} // namespace syntax
-} // namespace detail
-} // namespace toml
-#endif // TOML11_SYNTAX_FWD_HPP
+// digits separated by a single `_`, like 1_000
+template<typename Digit>
+struct digits_with_underscore : repeat_at_least<0,
+        either<Digit, sequence<character<'_'>, Digit>>
+    >{};
 
-#if ! defined(TOML11_COMPILE_SOURCES)
-#ifndef TOML11_SYNTAX_IMPL_HPP
-#define TOML11_SYNTAX_IMPL_HPP
+struct num_suffix : sequence<
+        character<'_'>,
+        either<alpha, non_ascii>,
+        repeat_at_least<0, either<
+            sequence<character<'_'>, either<alpha, digit, non_ascii>>,
+            either<alpha, digit, non_ascii>
+        >>
+    >{};
 
+struct dec_int : sequence<
+        maybe<sign>,
+        either<
+            sequence<character_in_range<'1', '9'>, repeat_at_least<1,
+                either<digit, sequence<character<'_'>, digit>>>>,
+            digit
+        >
+    >{};
 
-namespace toml
-{
-namespace detail
-{
-namespace syntax
-{
+struct hex_int : sequence<literal<'0', 'x'>, hexdig,
+        digits_with_underscore<hexdig>>{};
 
-using char_type = location::char_type;
+struct oct_int : sequence<literal<'0', 'o'>, character_in_range<'0', '7'>,
+        digits_with_underscore<character_in_range<'0', '7'>>>{};
+
+struct bin_int : sequence<literal<'0', 'b'>, character_either<'0', '1'>,
+        digits_with_underscore<character_either<'0', '1'>>>{};
+
+struct integer : either<hex_int, oct_int, bin_int, dec_int>{};
 
 // ===========================================================================
-// UTF-8
+// Floating
 
-// avoid redundant representation and out-of-unicode sequence
+struct zero_prefixable_int : sequence<digit, digits_with_underscore<digit>>{};
+struct fractional_part : sequence<character<'.'>, zero_prefixable_int>{};
+struct exponent_part   : sequence<character_either<'e', 'E'>,
+        maybe<character_either<'+', '-'>>, zero_prefixable_int>{};
+
+// C99 hexfloat (%a)
+// [+-]? 0x ( [0-9a-fA-F]*\.[0-9a-fA-F]+ | [0-9a-fA-F]+\.? ) [pP] [+-]? [0-9]+
+struct hex_floating : sequence<
+        maybe<sign>,
+        character<'0'>,
+        character_either<'x', 'X'>,
+        either<
+            sequence<repeat_at_least<0, hexdig>, character<'.'>, repeat_at_least<1, hexdig>>,
+            sequence<repeat_at_least<1, hexdig>, maybe<character<'.'>>>
+        >,
+        character_either<'p', 'P'>,
+        maybe<character_either<'+', '-'>>,
+        repeat_at_least<1, digit>
+    >{};
 
-TOML11_INLINE character_in_range utf8_1byte(const spec&)
-{
-    return character_in_range(0x00, 0x7F);
-}
+struct floating : either<
+        sequence<dec_int, either<exponent_part,
+                 sequence<fractional_part, maybe<exponent_part>>>>,
+        sequence<maybe<sign>,
+                 either<literal<'i', 'n', 'f'>, literal<'n', 'a', 'n'>>>
+    >{};
 
-TOML11_INLINE sequence utf8_2bytes(const spec&)
-{
-    return sequence(character_in_range(0xC2, 0xDF),
-                    character_in_range(0x80, 0xBF));
-}
+// ===========================================================================
+// Datetime
 
-TOML11_INLINE sequence utf8_3bytes(const spec&)
-{
-    return sequence(/*1~2 bytes = */either(
-        sequence(character         (0xE0),       character_in_range(0xA0, 0xBF)),
-        sequence(character_in_range(0xE1, 0xEC), character_in_range(0x80, 0xBF)),
-        sequence(character         (0xED),       character_in_range(0x80, 0x9F)),
-        sequence(character_in_range(0xEE, 0xEF), character_in_range(0x80, 0xBF))
-    ), /*3rd byte = */ character_in_range(0x80, 0xBF));
-}
+struct local_date : sequence<
+        repeat_exact<4, digit>, character<'-'>,
+        repeat_exact<2, digit>, character<'-'>,
+        repeat_exact<2, digit>
+    >{};
 
-TOML11_INLINE sequence utf8_4bytes(const spec&)
-{
-    return sequence(/*1~2 bytes = */either(
-        sequence(character         (0xF0),       character_in_range(0x90, 0xBF)),
-        sequence(character_in_range(0xF1, 0xF3), character_in_range(0x80, 0xBF)),
-        sequence(character         (0xF4),       character_in_range(0x80, 0x8F))
-    ), character_in_range(0x80, 0xBF), character_in_range(0x80, 0xBF));
-}
+struct hour_minute : sequence<
+        repeat_exact<2, digit>, character<':'>, repeat_exact<2, digit>
+    >{};
+struct second_part : sequence<
+        character<':'>, repeat_exact<2, digit>,
+        maybe<sequence<character<'.'>, repeat_at_least<1, digit>>>
+    >{};
 
-TOML11_INLINE non_ascii::non_ascii(const spec& s) noexcept
-    : scanner_(utf8_2bytes(s), utf8_3bytes(s), utf8_4bytes(s))
-{}
+template<bool SecondsOptional>
+struct local_time : std::conditional<SecondsOptional,
+        sequence<hour_minute, maybe<second_part>>,
+        sequence<hour_minute, second_part>
+    >::type {};
 
+struct time_offset : either<
+        character_either<'Z', 'z'>,
+        sequence<character_either<'+', '-'>, hour_minute>
+    >{};
 
-// ===========================================================================
-// Whitespace
+struct time_delim : character_either<'T', 't', ' '>{};
 
-TOML11_INLINE character_either wschar(const spec&)
-{
-    return character_either{char_type(' '), char_type('\t')};
-}
+template<bool SecondsOptional>
+struct local_datetime : sequence<
+        local_date, time_delim, local_time<SecondsOptional>
+    >{};
 
-TOML11_INLINE repeat_at_least ws(const spec& s)
-{
-    return repeat_at_least(0, wschar(s));
-}
+template<bool SecondsOptional>
+struct offset_datetime : sequence<
+        local_date, time_delim, local_time<SecondsOptional>, time_offset
+    >{};
 
 // ===========================================================================
-// Newline
+// String
 
-TOML11_INLINE either newline(const spec&)
-{
-    return either(character(char_type('\n')), literal("\r\n"));
-}
+template<bool AllowE, bool AllowX>
+struct escaped : sequence<character<'\\'>, either<
+        typename std::conditional<AllowE,
+            character_either<'"', '\\', 'b', 'f', 'n', 'r', 't', 'e'>,
+            character_either<'"', '\\', 'b', 'f', 'n', 'r', 't'>
+        >::type,
+        sequence<character<'u'>, repeat_exact<4, hexdig>>,
+        sequence<character<'U'>, repeat_exact<8, hexdig>>,
+        typename std::conditional<AllowX,
+            sequence<character<'x'>, repeat_exact<2, hexdig>>,
+            either<>
+        >::type
+    >>{};
+
+struct basic_unescaped : either<
+        wschar,
+        character<0x21>,                // 22 is "
+        character_in_range<0x23, 0x5B>, // 5C is backslash
+        character_in_range<0x5D, 0x7E>, // 7F is DEL
+        non_ascii
+    >{};
 
-// ===========================================================================
-// Comments
+template<bool AllowE, bool AllowX>
+struct basic_char : either<basic_unescaped, escaped<AllowE, AllowX>>{};
 
-TOML11_INLINE either allowed_comment_char(const spec& s)
+// one-line string delimited by `Quote`. runs of plain ASCII characters are
+// skipped by simd kernels. If `Escape == Quote`, there is no escape sequence.
+template<unsigned char Quote, unsigned char Escape, typename EscapeSeq>
+struct oneline_string
 {
-    if(s.v1_1_0_allow_control_characters_in_comments)
-    {
-        return either(
-            character_in_range(0x01, 0x09),
-            character_in_range(0x0E, 0x7F),
-            non_ascii(s)
-        );
-    }
-    else
+    static bool scan(location& loc)
     {
-        return either(
-            character(0x09),
-            character_in_range(0x20, 0x7E),
-            non_ascii(s)
-        );
+        if(loc.current() != Quote) {return false;}
+        const auto checkpoint = loc.get_location();
+        loc.advance();
+
+        const auto& src  = *loc.source();
+        const auto* tail = src.data() + src.size();
+        while( ! loc.eof())
+        {
+            const auto* head = src.data() + loc.get_location();
+            const auto* stop = simd::skip_string_ascii(head, tail, Quote, Escape);
+            loc.advance(static_cast<std::size_t>(stop - head));
+            if(loc.eof())
+            {
+                break;
+            }
+
+            const auto c = loc.current();
+            if(c == Quote)
+            {
+                loc.advance();
+                return true;
+            }
+            const bool ok = (c == Escape) ? EscapeSeq::scan(loc) :
+                            (0x80 <= c && non_ascii::scan(loc));
+            if( ! ok)
+            {
+                break;
+            }
+        }
+        loc.set_location(checkpoint);
+        return false;
     }
-}
+};
 
-// XXX Note that it does not take newline
-TOML11_INLINE sequence comment(const spec& s)
-{
-    return sequence(character(char_type('#')),
-                    repeat_at_least(0, allowed_comment_char(s)));
-}
+// equivalent to sequence<'"', repeat_at_least<0, basic_char<E, X>>, '"'>
+template<bool AllowE, bool AllowX>
+struct basic_string : oneline_string<'"', '\\', escaped<AllowE, AllowX>>{};
+
+struct escaped_newline : sequence<
+        character<'\\'>, ws, newline,
+        repeat_at_least<0, either<wschar, newline>>
+    >{};
+
+template<bool AllowE, bool AllowX>
+struct mlb_content : either<basic_char<AllowE, AllowX>, newline, escaped_newline>{};
+
+struct mlb_quotes : either<literal<'"', '"'>, character<'"'>>{};
+
+// XXX """ and mlb_quotes are intentionally reordered to avoid
+//     unexpected match of mlb_quotes
+template<bool AllowE, bool AllowX>
+struct ml_basic_string : sequence<
+        literal<'"', '"', '"'>,
+        maybe<newline>,
+        repeat_at_least<0, mlb_content<AllowE, AllowX>>,
+        repeat_at_least<0, sequence<
+            mlb_quotes, repeat_at_least<1, mlb_content<AllowE, AllowX>>
+        >>,
+        literal<'"', '"', '"'>,
+        maybe<mlb_quotes>
+    >{};
+
+struct literal_char : either<
+        character         <0x09>,
+        character_in_range<0x20, 0x26>,
+        character_in_range<0x28, 0x7E>,
+        non_ascii
+    >{};
+
+// equivalent to sequence<'\'', repeat_at_least<0, literal_char>, '\''>
+struct literal_string : oneline_string<'\'', '\'', either<>>{};
+
+struct mll_quotes  : either<literal<'\'', '\''>, character<'\''>>{};
+struct mll_content : either<literal_char, newline>{};
+
+struct ml_literal_string : sequence<
+        literal<'\'', '\'', '\''>,
+        maybe<newline>,
+        repeat_at_least<0, mll_content>,
+        repeat_at_least<0, sequence<mll_quotes, repeat_at_least<1, mll_content>>>,
+        literal<'\'', '\'', '\''>,
+        maybe<mll_quotes>
+    >{};
 
 // ===========================================================================
-// Boolean
+// Keys
 
-TOML11_INLINE either boolean(const spec&)
+struct non_ascii_key_char
 {
-    return either(literal("true"), literal("false"));
-}
+    static bool scan(location& loc);
+
+    // returns 0xFFFFFFFF if it is not a valid UTF-8 sequence.
+    static std::uint32_t read_utf8(location& loc);
+};
+
+template<bool AllowNonEnglish>
+struct unquoted_key : repeat_at_least<1, typename std::conditional<AllowNonEnglish,
+        either<alpha, digit, character<0x2D>, character<0x5F>, non_ascii_key_char>,
+        either<alpha, digit, character<0x2D>, character<0x5F>>
+    >::type>{};
+
+template<bool AllowE, bool AllowX>
+struct quoted_key : either<basic_string<AllowE, AllowX>, literal_string>{};
+
+template<bool AllowNonEnglish, bool AllowE, bool AllowX>
+struct simple_key : either<
+        unquoted_key<AllowNonEnglish>, quoted_key<AllowE, AllowX>
+    >{};
+
+struct dot_sep    : sequence<ws, character<'.'>, ws>{};
+struct keyval_sep : sequence<ws, character<'='>, ws>{};
+
+// `dotted_key | simple_key` matches the same range as this.
+template<bool AllowNonEnglish, bool AllowE, bool AllowX>
+struct key : sequence<
+        simple_key<AllowNonEnglish, AllowE, AllowX>,
+        repeat_at_least<0, sequence<dot_sep, simple_key<AllowNonEnglish, AllowE, AllowX>>>
+    >{};
 
 // ===========================================================================
-// Integer
+// Table key
 
-TOML11_INLINE digit::digit(const spec&) noexcept
-    : scanner_(char_type('0'), char_type('9'))
-{}
+template<bool AllowNonEnglish, bool AllowE, bool AllowX>
+struct std_table : sequence<
+        character<'['>, ws, key<AllowNonEnglish, AllowE, AllowX>, ws, character<']'>
+    >{};
 
-TOML11_INLINE alpha::alpha(const spec&) noexcept
-    : scanner_(
-        character_in_range(char_type('a'), char_type('z')),
-        character_in_range(char_type('A'), char_type('Z'))
-    )
-{}
+template<bool AllowNonEnglish, bool AllowE, bool AllowX>
+struct array_table : sequence<
+        literal<'[', '['>, ws, key<AllowNonEnglish, AllowE, AllowX>, ws, literal<']', ']'>
+    >{};
 
-TOML11_INLINE hexdig::hexdig(const spec& s) noexcept
-    : scanner_(
-        digit(s),
-        character_in_range(char_type('a'), char_type('f')),
-        character_in_range(char_type('A'), char_type('F'))
-    )
-{}
+// ===========================================================================
+// extension: null
 
-// non-digit-graph = ([a-zA-Z]|unicode mb char)
-// graph           = ([a-zA-Z0-9]|unicode mb char)
-// suffix          = _ non-digit-graph (graph | _graph)
-TOML11_INLINE sequence num_suffix(const spec& s)
-{
-    const auto non_digit_graph = [&s]() {
-        return either(
-            alpha(s),
-            non_ascii(s)
-        );
-    };
-    const auto graph = [&s]() {
-        return either(
-            alpha(s),
-            digit(s),
-            non_ascii(s)
-        );
-    };
+struct null_value : literal<'n', 'u', 'l', 'l'>{};
 
-    return sequence(
-            character(char_type('_')),
-            non_digit_graph(),
-            repeat_at_least(0,
-                either(
-                    sequence(character(char_type('_')), graph()),
-                    graph()
-                )
-            )
-        );
-}
+} // static_syntax
+} // detail
+} // toml
+#endif // TOML11_STATIC_SCANNER_FWD_HPP
 
-TOML11_INLINE sequence dec_int(const spec& s)
+#if ! defined(TOML11_COMPILE_SOURCES)
+#ifndef TOML11_STATIC_SCANNER_IMPL_HPP
+#define TOML11_STATIC_SCANNER_IMPL_HPP
+
+namespace toml
+{
+namespace detail
+{
+namespace static_syntax
 {
-    const auto digit19 = []() {
-        return character_in_range(char_type('1'), char_type('9'));
-    };
-    return sequence(
-            maybe(character_either{char_type('-'), char_type('+')}),
-            either(
-                sequence(
-                    digit19(),
-                    repeat_at_least(1,
-                        either(
-                            digit(s),
-                            sequence(character(char_type('_')), digit(s))
-                        )
-                    )
-                ),
-                digit(s)
-            )
-        );
-}
 
-TOML11_INLINE sequence hex_int(const spec& s)
+TOML11_INLINE std::uint32_t non_ascii_key_char::read_utf8(location& loc)
 {
-    return sequence(
-            literal("0x"),
-            hexdig(s),
-            repeat_at_least(0,
+    // U+0000   ... U+0079  ; 0xxx_xxxx
+    // U+0080   ... U+07FF  ; 110y_yyyx 10xx_xxxx;
+    // U+0800   ... U+FFFF  ; 1110_yyyy 10yx_xxxx 10xx_xxxx
+    // U+010000 ... U+10FFFF; 1111_0yyy 10yy_xxxx 10xx_xxxx 10xx_xxxx
+
+    const unsigned char b1 = loc.current(); loc.advance(1);
+    if(b1 < 0x80)
+    {
+        return static_cast<std::uint32_t>(b1);
+    }
+    else if((b1 >> 5) == 6) // 0b110 == 6
+    {
+        const auto b2 = loc.current(); loc.advance(1);
+
+        const std::uint32_t c1 = b1 & ((1 << 5) - 1);
+        const std::uint32_t c2 = b2 & ((1 << 6) - 1);
+        const std::uint32_t codep = (c1 << 6) + c2;
+
+        if(codep < 0x80)
+        {
+            return 0xFFFFFFFF;
+        }
+        return codep;
+    }
+    else if((b1 >> 4) == 14) // 0b1110 == 14
+    {
+        const auto b2 = loc.current(); loc.advance(1); if(loc.eof()) {return 0xFFFFFFFF;}
+        const auto b3 = loc.current(); loc.advance(1);
+
+        const std::uint32_t c1 = b1 & ((1 << 4) - 1);
+        const std::uint32_t c2 = b2 & ((1 << 6) - 1);
+        const std::uint32_t c3 = b3 & ((1 << 6) - 1);
+
+        const std::uint32_t codep = (c1 << 12) + (c2 << 6) + c3;
+        if(codep < 0x800)
+        {
+            return 0xFFFFFFFF;
+        }
+        return codep;
+    }
+    else if((b1 >> 3) == 30) // 0b11110 == 30
+    {
+        const auto b2 = loc.current(); loc.advance(1); if(loc.eof()) {return 0xFFFFFFFF;}
+        const auto b3 = loc.current(); loc.advance(1); if(loc.eof()) {return 0xFFFFFFFF;}
+        const auto b4 = loc.current(); loc.advance(1);
+
+        const std::uint32_t c1 = b1 & ((1 << 3) - 1);
+        const std::uint32_t c2 = b2 & ((1 << 6) - 1);
+        const std::uint32_t c3 = b3 & ((1 << 6) - 1);
+        const std::uint32_t c4 = b4 & ((1 << 6) - 1);
+        const std::uint32_t codep = (c1 << 18) + (c2 << 12) + (c3 << 6) + c4;
+
+        if(codep < 0x10000)
+        {
+            return 0xFFFFFFFF;
+        }
+        return codep;
+    }
+    else // not a Unicode codepoint in UTF-8
+    {
+        return 0xFFFFFFFF;
+    }
+}
+
+TOML11_INLINE bool non_ascii_key_char::scan(location& loc)
+{
+    if(loc.eof()) {return false;}
+
+    const auto first = loc.get_location();
+    const auto cp = read_utf8(loc);
+
+    // ALPHA / DIGIT / %x2D / %x5F    ; a-z A-Z 0-9 - _
+    // / %xB2 / %xB3 / %xB9 / %xBC-BE ; superscript digits, fractions
+    // / %xC0-D6 / %xD8-F6 / %xF8-37D ; non-symbol chars in Latin block
+    // / %x37F-1FFF                   ; exclude GREEK QUESTION MARK, which is basically a semi-colon
+    // / %x200C-200D / %x203F-2040    ; from General Punctuation Block, include the two tie symbols and ZWNJ, ZWJ
+    // / %x2070-218F / %x2460-24FF    ; include super-/subscripts, letterlike/numberlike forms, enclosed alphanumerics
+    // / %x2C00-2FEF / %x3001-D7FF    ; skip arrows, math, box drawing etc, skip 2FF0-3000 ideographic up/down markers and spaces
+    // / %xF900-FDCF / %xFDF0-FFFD    ; skip D800-DFFF surrogate block, E000-F8FF Private Use area, FDD0-FDEF intended for process-internal use (unicode)
+    // / %x10000-EFFFF                ; all chars outside BMP range, excluding Private Use planes (F0000-10FFFF)
+
+    if(cp != 0xFFFFFFFF && (
+       cp == 0xB2 || cp == 0xB3 || cp == 0xB9 || (0xBC <= cp && cp <= 0xBE) ||
+       (0xC0    <= cp && cp <= 0xD6  ) || (0xD8 <= cp && cp <= 0xF6) || (0xF8 <= cp && cp <= 0x37D) ||
+       (0x37F   <= cp && cp <= 0x1FFF) ||
+       (0x200C  <= cp && cp <= 0x200D) || (0x203F <= cp && cp <= 0x2040) ||
+       (0x2070  <= cp && cp <= 0x218F) || (0x2460 <= cp && cp <= 0x24FF) ||
+       (0x2C00  <= cp && cp <= 0x2FEF) || (0x3001 <= cp && cp <= 0xD7FF) ||
+       (0xF900  <= cp && cp <= 0xFDCF) || (0xFDF0 <= cp && cp <= 0xFFFD) ||
+       (0x10000 <= cp && cp <= 0xEFFFF) ))
+    {
+        return true;
+    }
+    loc.set_location(first);
+    return false;
+}
+
+} // static_syntax
+
+namespace spec_syntax_detail
+{
+using scanner_type = spec_syntax::scanner_type;
+
+// selects Scanner<B1, B2, ...>::scan from runtime flags.
+template<template<bool...> class Scanner, bool ... Bs>
+struct select
+{
+    static scanner_type with() noexcept
+    {
+        return &Scanner<Bs...>::scan;
+    }
+    template<typename ... Rest>
+    static scanner_type with(const bool b, const Rest ... rest) noexcept
+    {
+        return b ? select<Scanner, Bs..., true >::with(rest...)
+                 : select<Scanner, Bs..., false>::with(rest...);
+    }
+};
+} // spec_syntax_detail
+
+TOML11_INLINE spec_syntax::spec_syntax(const spec& s) noexcept
+{
+    using spec_syntax_detail::select;
+
+    const bool ctrl = s.v1_1_0_allow_control_characters_in_comments;
+    const bool secs = s.v1_1_0_make_seconds_optional;
+    const bool nonE = s.v1_1_0_allow_non_english_in_bare_keys;
+    const bool escE = s.v1_1_0_add_escape_sequence_e;
+    const bool escX = s.v1_1_0_add_escape_sequence_x;
+
+    this->comment         = select<static_syntax::comment        >::with(ctrl);
+    this->local_time      = select<static_syntax::local_time     >::with(secs);
+    this->local_datetime  = select<static_syntax::local_datetime >::with(secs);
+    this->offset_datetime = select<static_syntax::offset_datetime>::with(secs);
+    this->basic_string    = select<static_syntax::basic_string   >::with(escE, escX);
+    this->ml_basic_string = select<static_syntax::ml_basic_string>::with(escE, escX);
+    this->unquoted_key    = select<static_syntax::unquoted_key   >::with(nonE);
+    this->std_table       = select<static_syntax::std_table      >::with(nonE, escE, escX);
+    this->array_table     = select<static_syntax::array_table    >::with(nonE, escE, escX);
+}
+
+} // detail
+} // toml
+#endif // TOML11_STATIC_SCANNER_IMPL_HPP
+#endif
+
+#endif // TOML11_STATIC_SCANNER_HPP
+#ifndef TOML11_SYNTAX_HPP
+#define TOML11_SYNTAX_HPP
+
+#ifndef TOML11_SYNTAX_FWD_HPP
+#define TOML11_SYNTAX_FWD_HPP
+
+
+namespace toml
+{
+namespace detail
+{
+namespace syntax
+{
+
+using char_type = location::char_type;
+
+// ===========================================================================
+// UTF-8
+
+// avoid redundant representation and out-of-unicode sequence
+
+character_in_range utf8_1byte (const spec&);
+sequence           utf8_2bytes(const spec&);
+sequence           utf8_3bytes(const spec&);
+sequence           utf8_4bytes(const spec&);
+
+class non_ascii final : public scanner_base
+{
+  public:
+
+    using char_type = location::char_type;
+
+  public:
+
+    explicit non_ascii(const spec& s) noexcept;
+    ~non_ascii() override = default;
+
+    region scan(location& loc) const override
+    {
+        return scanner_.scan(loc);
+    }
+
+    std::string expected_chars(location&) const override
+    {
+        return "non-ascii utf-8 bytes";
+    }
+
+    scanner_base* clone() const override
+    {
+        return new non_ascii(*this);
+    }
+
+    std::string name() const override
+    {
+        return "non_ascii";
+    }
+
+  private:
+
+    either scanner_;
+};
+
+// ===========================================================================
+// Whitespace
+
+character_either wschar(const spec&);
+
+repeat_at_least ws(const spec& s);
+
+// ===========================================================================
+// Newline
+
+either newline(const spec&);
+
+// ===========================================================================
+// Comments
+
+either allowed_comment_char(const spec& s);
+
+// XXX Note that it does not take newline
+sequence comment(const spec& s);
+
+// ===========================================================================
+// Boolean
+
+either boolean(const spec&);
+
+// ===========================================================================
+// Integer
+
+class digit final : public scanner_base
+{
+  public:
+
+    using char_type = location::char_type;
+
+  public:
+
+    explicit digit(const spec&) noexcept;
+    ~digit() override = default;
+
+    region scan(location& loc) const override
+    {
+        return scanner_.scan(loc);
+    }
+
+    std::string expected_chars(location&) const override
+    {
+        return "digit [0-9]";
+    }
+
+    scanner_base* clone() const override
+    {
+        return new digit(*this);
+    }
+
+    std::string name() const override
+    {
+        return "digit";
+    }
+
+  private:
+
+    character_in_range scanner_;
+};
+
+class alpha final : public scanner_base
+{
+  public:
+
+    using char_type = location::char_type;
+
+  public:
+
+    explicit alpha(const spec&) noexcept;
+    ~alpha() override = default;
+
+    region scan(location& loc) const override
+    {
+        return scanner_.scan(loc);
+    }
+
+    std::string expected_chars(location&) const override
+    {
+        return "alpha [a-zA-Z]";
+    }
+
+    scanner_base* clone() const override
+    {
+        return new alpha(*this);
+    }
+
+    std::string name() const override
+    {
+        return "alpha";
+    }
+
+  private:
+
+    either scanner_;
+};
+
+class hexdig final : public scanner_base
+{
+  public:
+
+    using char_type = location::char_type;
+
+  public:
+
+    explicit hexdig(const spec& s) noexcept;
+    ~hexdig() override = default;
+
+    region scan(location& loc) const override
+    {
+        return scanner_.scan(loc);
+    }
+
+    std::string expected_chars(location&) const override
+    {
+        return "hex [0-9a-fA-F]";
+    }
+
+    scanner_base* clone() const override
+    {
+        return new hexdig(*this);
+    }
+
+    std::string name() const override
+    {
+        return "hexdig";
+    }
+
+  private:
+
+    either scanner_;
+};
+
+sequence num_suffix(const spec& s);
+
+sequence dec_int(const spec& s);
+sequence hex_int(const spec& s);
+sequence oct_int(const spec&);
+sequence bin_int(const spec&);
+either   integer(const spec& s);
+
+// ===========================================================================
+// Floating
+
+sequence zero_prefixable_int(const spec& s);
+sequence fractional_part(const spec& s);
+sequence exponent_part(const spec& s);
+sequence hex_floating(const spec& s);
+either   floating(const spec& s);
+
+// ===========================================================================
+// Datetime
+
+sequence local_date(const spec& s);
+sequence local_time(const spec& s);
+either time_offset(const spec& s);
+sequence full_time(const spec& s);
+character_either time_delim(const spec&);
+sequence local_datetime(const spec& s);
+sequence offset_datetime(const spec& s);
+
+// ===========================================================================
+// String
+
+sequence escaped(const spec& s);
+
+either basic_char(const spec& s);
+
+sequence basic_string(const spec& s);
+
+// ---------------------------------------------------------------------------
+// multiline string
+
+sequence escaped_newline(const spec& s);
+sequence ml_basic_string(const spec& s);
+
+// ---------------------------------------------------------------------------
+// literal string
+
+either literal_char(const spec& s);
+sequence literal_string(const spec& s);
+
+sequence ml_literal_string(const spec& s);
+
+either string(const spec& s);
+
+// ===========================================================================
+// Keys
+
+// to keep `expected_chars` simple
+class non_ascii_key_char final : public scanner_base
+{
+  public:
+
+    using char_type = location::char_type;
+
+  private:
+
+    using in_range = character_in_range; // make definition short
+
+  public:
+
+    explicit non_ascii_key_char(const spec& s) noexcept;
+    ~non_ascii_key_char() override = default;
+
+    region scan(location& loc) const override;
+
+    std::string expected_chars(location&) const override
+    {
+        return "bare key non-ASCII script";
+    }
+
+    scanner_base* clone() const override
+    {
+        return new non_ascii_key_char(*this);
+    }
+
+    std::string name() const override
+    {
+        return "non-ASCII bare key";
+    }
+};
+
+
+repeat_at_least unquoted_key(const spec& s);
+
+either quoted_key(const spec& s);
+
+either simple_key(const spec& s);
+
+sequence dot_sep(const spec& s);
+
+sequence dotted_key(const spec& s);
+
+
+class key final : public scanner_base
+{
+  public:
+
+    using char_type = location::char_type;
+
+  public:
+
+    explicit key(const spec& s) noexcept;
+    ~key() override = default;
+
+    region scan(location& loc) const override
+    {
+        return scanner_.scan(loc);
+    }
+
+    std::string expected_chars(location&) const override
+    {
+        return "basic key([a-zA-Z0-9_-]) or quoted key(\" or ')";
+    }
+
+    scanner_base* clone() const override
+    {
+        return new key(*this);
+    }
+
+    std::string name() const override
+    {
+        return "key";
+    }
+
+  private:
+
+    either scanner_;
+};
+
+sequence keyval_sep(const spec& s);
+
+// ===========================================================================
+// Table key
+
+sequence std_table(const spec& s);
+
+sequence array_table(const spec& s);
+
+// ===========================================================================
+// extension: null
+
+literal null_value(const spec&);
+
+} // namespace syntax
+} // namespace detail
+} // namespace toml
+#endif // TOML11_SYNTAX_FWD_HPP
+
+#if ! defined(TOML11_COMPILE_SOURCES)
+#ifndef TOML11_SYNTAX_IMPL_HPP
+#define TOML11_SYNTAX_IMPL_HPP
+
+
+namespace toml
+{
+namespace detail
+{
+namespace syntax
+{
+
+using char_type = location::char_type;
+
+// ===========================================================================
+// UTF-8
+
+// avoid redundant representation and out-of-unicode sequence
+
+TOML11_INLINE character_in_range utf8_1byte(const spec&)
+{
+    return character_in_range(0x00, 0x7F);
+}
+
+TOML11_INLINE sequence utf8_2bytes(const spec&)
+{
+    return sequence(character_in_range(0xC2, 0xDF),
+                    character_in_range(0x80, 0xBF));
+}
+
+TOML11_INLINE sequence utf8_3bytes(const spec&)
+{
+    return sequence(/*1~2 bytes = */either(
+        sequence(character         (0xE0),       character_in_range(0xA0, 0xBF)),
+        sequence(character_in_range(0xE1, 0xEC), character_in_range(0x80, 0xBF)),
+        sequence(character         (0xED),       character_in_range(0x80, 0x9F)),
+        sequence(character_in_range(0xEE, 0xEF), character_in_range(0x80, 0xBF))
+    ), /*3rd byte = */ character_in_range(0x80, 0xBF));
+}
+
+TOML11_INLINE sequence utf8_4bytes(const spec&)
+{
+    return sequence(/*1~2 bytes = */either(
+        sequence(character         (0xF0),       character_in_range(0x90, 0xBF)),
+        sequence(character_in_range(0xF1, 0xF3), character_in_range(0x80, 0xBF)),
+        sequence(character         (0xF4),       character_in_range(0x80, 0x8F))
+    ), character_in_range(0x80, 0xBF), character_in_range(0x80, 0xBF));
+}
+
+TOML11_INLINE non_ascii::non_ascii(const spec& s) noexcept
+    : scanner_(utf8_2bytes(s), utf8_3bytes(s), utf8_4bytes(s))
+{}
+
+
+// ===========================================================================
+// Whitespace
+
+TOML11_INLINE character_either wschar(const spec&)
+{
+    return character_either{char_type(' '), char_type('\t')};
+}
+
+TOML11_INLINE repeat_at_least ws(const spec& s)
+{
+    return repeat_at_least(0, wschar(s));
+}
+
+// ===========================================================================
+// Newline
+
+TOML11_INLINE either newline(const spec&)
+{
+    return either(character(char_type('\n')), literal("\r\n"));
+}
+
+// ===========================================================================
+// Comments
+
+TOML11_INLINE either allowed_comment_char(const spec& s)
+{
+    if(s.v1_1_0_allow_control_characters_in_comments)
+    {
+        return either(
+            character_in_range(0x01, 0x09),
+            character_in_range(0x0E, 0x7F),
+            non_ascii(s)
+        );
+    }
+    else
+    {
+        return either(
+            character(0x09),
+            character_in_range(0x20, 0x7E),
+            non_ascii(s)
+        );
+    }
+}
+
+// XXX Note that it does not take newline
+TOML11_INLINE sequence comment(const spec& s)
+{
+    return sequence(character(char_type('#')),
+                    repeat_at_least(0, allowed_comment_char(s)));
+}
+
+// ===========================================================================
+// Boolean
+
+TOML11_INLINE either boolean(const spec&)
+{
+    return either(literal("true"), literal("false"));
+}
+
+// ===========================================================================
+// Integer
+
+TOML11_INLINE digit::digit(const spec&) noexcept
+    : scanner_(char_type('0'), char_type('9'))
+{}
+
+TOML11_INLINE alpha::alpha(const spec&) noexcept
+    : scanner_(
+        character_in_range(char_type('a'), char_type('z')),
+        character_in_range(char_type('A'), char_type('Z'))
+    )
+{}
+
+TOML11_INLINE hexdig::hexdig(const spec& s) noexcept
+    : scanner_(
+        digit(s),
+        character_in_range(char_type('a'), char_type('f')),
+        character_in_range(char_type('A'), char_type('F'))
+    )
+{}
+
+// non-digit-graph = ([a-zA-Z]|unicode mb char)
+// graph           = ([a-zA-Z0-9]|unicode mb char)
+// suffix          = _ non-digit-graph (graph | _graph)
+TOML11_INLINE sequence num_suffix(const spec& s)
+{
+    const auto non_digit_graph = [&s]() {
+        return either(
+            alpha(s),
+            non_ascii(s)
+        );
+    };
+    const auto graph = [&s]() {
+        return either(
+            alpha(s),
+            digit(s),
+            non_ascii(s)
+        );
+    };
+
+    return sequence(
+            character(char_type('_')),
+            non_digit_graph(),
+            repeat_at_least(0,
+                either(
+                    sequence(character(char_type('_')), graph()),
+                    graph()
+                )
+            )
+        );
+}
+
+TOML11_INLINE sequence dec_int(const spec& s)
+{
+    const auto digit19 = []() {
+        return character_in_range(char_type('1'), char_type('9'));
+    };
+    return sequence(
+            maybe(character_either{char_type('-'), char_type('+')}),
+            either(
+                sequence(
+                    digit19(),
+                    repeat_at_least(1,
+                        either(
+                            digit(s),
+                            sequence(character(char_type('_')), digit(s))
+                        )
+                    )
+                ),
+                digit(s)
+            )
+        );
+}
+
+TOML11_INLINE sequence hex_int(const spec& s)
+{
+    return sequence(
+            literal("0x"),
+            hexdig(s),
+            repeat_at_least(0,
                 either(
                     hexdig(s),
                     sequence(character(char_type('_')), hexdig(s))
@@ -11352,107 +12896,13 @@ TOML11_INLINE non_ascii_key_char::non_ascii_key_char(const spec& s) noexcept
     (void)s; // for NDEBUG
 }
 
-TOML11_INLINE std::uint32_t non_ascii_key_char::read_utf8(location& loc) const
-{
-    // U+0000   ... U+0079  ; 0xxx_xxxx
-    // U+0080   ... U+07FF  ; 110y_yyyx 10xx_xxxx;
-    // U+0800   ... U+FFFF  ; 1110_yyyy 10yx_xxxx 10xx_xxxx
-    // U+010000 ... U+10FFFF; 1111_0yyy 10yy_xxxx 10xx_xxxx 10xx_xxxx
-
-    const unsigned char b1 = loc.current(); loc.advance(1);
-    if(b1 < 0x80)
-    {
-        return static_cast<std::uint32_t>(b1);
-    }
-    else if((b1 >> 5) == 6) // 0b110 == 6
-    {
-        const auto b2 = loc.current(); loc.advance(1);
-
-        const std::uint32_t c1 = b1 & ((1 << 5) - 1);
-        const std::uint32_t c2 = b2 & ((1 << 6) - 1);
-        const std::uint32_t codep = (c1 << 6) + c2;
-
-        if(codep < 0x80)
-        {
-            return 0xFFFFFFFF;
-        }
-        return codep;
-    }
-    else if((b1 >> 4) == 14) // 0b1110 == 14
-    {
-        const auto b2 = loc.current(); loc.advance(1); if(loc.eof()) {return 0xFFFFFFFF;}
-        const auto b3 = loc.current(); loc.advance(1);
-
-        const std::uint32_t c1 = b1 & ((1 << 4) - 1);
-        const std::uint32_t c2 = b2 & ((1 << 6) - 1);
-        const std::uint32_t c3 = b3 & ((1 << 6) - 1);
-
-        const std::uint32_t codep = (c1 << 12) + (c2 << 6) + c3;
-        if(codep < 0x800)
-        {
-            return 0xFFFFFFFF;
-        }
-        return codep;
-    }
-    else if((b1 >> 3) == 30) // 0b11110 == 30
-    {
-        const auto b2 = loc.current(); loc.advance(1); if(loc.eof()) {return 0xFFFFFFFF;}
-        const auto b3 = loc.current(); loc.advance(1); if(loc.eof()) {return 0xFFFFFFFF;}
-        const auto b4 = loc.current(); loc.advance(1);
-
-        const std::uint32_t c1 = b1 & ((1 << 3) - 1);
-        const std::uint32_t c2 = b2 & ((1 << 6) - 1);
-        const std::uint32_t c3 = b3 & ((1 << 6) - 1);
-        const std::uint32_t c4 = b4 & ((1 << 6) - 1);
-        const std::uint32_t codep = (c1 << 18) + (c2 << 12) + (c3 << 6) + c4;
-
-        if(codep < 0x10000)
-        {
-            return 0xFFFFFFFF;
-        }
-        return codep;
-    }
-    else // not a Unicode codepoint in UTF-8
-    {
-        return 0xFFFFFFFF;
-    }
-}
-
 TOML11_INLINE region non_ascii_key_char::scan(location& loc) const
 {
-    if(loc.eof()) {return region{};}
-
     const auto first = loc;
-
-    const auto cp = read_utf8(loc);
-
-    if(cp == 0xFFFFFFFF)
-    {
-        return region{};
-    }
-
-    // ALPHA / DIGIT / %x2D / %x5F    ; a-z A-Z 0-9 - _
-    // / %xB2 / %xB3 / %xB9 / %xBC-BE ; superscript digits, fractions
-    // / %xC0-D6 / %xD8-F6 / %xF8-37D ; non-symbol chars in Latin block
-    // / %x37F-1FFF                   ; exclude GREEK QUESTION MARK, which is basically a semi-colon
-    // / %x200C-200D / %x203F-2040    ; from General Punctuation Block, include the two tie symbols and ZWNJ, ZWJ
-    // / %x2070-218F / %x2460-24FF    ; include super-/subscripts, letterlike/numberlike forms, enclosed alphanumerics
-    // / %x2C00-2FEF / %x3001-D7FF    ; skip arrows, math, box drawing etc, skip 2FF0-3000 ideographic up/down markers and spaces
-    // / %xF900-FDCF / %xFDF0-FFFD    ; skip D800-DFFF surrogate block, E000-F8FF Private Use area, FDD0-FDEF intended for process-internal use (unicode)
-    // / %x10000-EFFFF                ; all chars outside BMP range, excluding Private Use planes (F0000-10FFFF)
-
-    if(cp == 0xB2 || cp == 0xB3 || cp == 0xB9 || (0xBC <= cp && cp <= 0xBE) ||
-       (0xC0    <= cp && cp <= 0xD6  ) || (0xD8 <= cp && cp <= 0xF6) || (0xF8 <= cp && cp <= 0x37D) ||
-       (0x37F   <= cp && cp <= 0x1FFF) ||
-       (0x200C  <= cp && cp <= 0x200D) || (0x203F <= cp && cp <= 0x2040) ||
-       (0x2070  <= cp && cp <= 0x218F) || (0x2460 <= cp && cp <= 0x24FF) ||
-       (0x2C00  <= cp && cp <= 0x2FEF) || (0x3001 <= cp && cp <= 0xD7FF) ||
-       (0xF900  <= cp && cp <= 0xFDCF) || (0xFDF0 <= cp && cp <= 0xFFFD) ||
-       (0x10000 <= cp && cp <= 0xEFFFF) )
+    if(static_syntax::non_ascii_key_char::scan(loc))
     {
         return region(first, loc);
     }
-    loc = first;
     return region{};
 }
 
@@ -11542,18 +12992,17 @@ namespace detail
 {
 
 template<typename TC>
-bool skip_whitespace(location& loc, const context<TC>& ctx)
+bool skip_whitespace(location& loc, const context<TC>&)
 {
-    return syntax::ws(ctx.toml_spec()).scan(loc).is_ok();
+    return static_syntax::ws::scan(loc);
 }
 
 template<typename TC>
-bool skip_empty_lines(location& loc, const context<TC>& ctx)
+bool skip_empty_lines(location& loc, const context<TC>&)
 {
-    return repeat_at_least(1, sequence(
-            syntax::ws(ctx.toml_spec()),
-            syntax::newline(ctx.toml_spec())
-        )).scan(loc).is_ok();
+    return static_scanner::repeat_at_least<1, static_scanner::sequence<
+            static_syntax::ws, static_syntax::newline
+        >>::scan(loc);
 }
 
 // For error recovery.
@@ -11568,17 +13017,14 @@ void skip_comment_block(location& loc, const context<TC>& ctx)
         skip_whitespace(loc, ctx);
         if(loc.current() == '#')
         {
-            while( ! loc.eof())
-            {
-                // both CRLF and LF ends with LF.
-                if(loc.current() == '\n')
-                {
-                    loc.advance();
-                    break;
-                }
-            }
+            // both CRLF and LF ends with LF.
+            const auto& src  = *loc.source();
+            const auto* head = src.data() + loc.get_location();
+            const auto* tail = src.data() + src.size();
+            const auto* lf   = simd::find_newline(head, tail);
+            loc.advance(static_cast<std::size_t>(lf - head) + (lf == tail ? 0 : 1));
         }
-        else if(syntax::newline(ctx.toml_spec()).scan(loc).is_ok())
+        else if(static_syntax::newline::scan(loc))
         {
             ; // an empty line. skip this also
         }
@@ -11594,12 +13040,18 @@ void skip_comment_block(location& loc, const context<TC>& ctx)
 template<typename TC>
 void skip_empty_or_comment_lines(location& loc, const context<TC>& ctx)
 {
-    const auto& spec = ctx.toml_spec();
-    repeat_at_least(0, sequence(
-            syntax::ws(spec),
-            maybe(syntax::comment(spec)),
-            syntax::newline(spec))
-        ).scan(loc);
+    // (ws comment? newline)*
+    while( ! loc.eof())
+    {
+        const auto checkpoint = loc.get_location();
+        static_syntax::ws::scan(loc);
+        ctx.syntax().comment(loc);
+        if( ! static_syntax::newline::scan(loc))
+        {
+            loc.set_location(checkpoint);
+            break;
+        }
+    }
     return ;
 }
 
@@ -11613,23 +13065,26 @@ void skip_empty_or_comment_lines(location& loc, const context<TC>& ctx)
 template<typename TC>
 void skip_string_like(location& loc, const context<TC>&)
 {
+    using ml_basic_quote   = static_scanner::literal<'"', '"', '"'>;
+    using ml_literal_quote = static_scanner::literal<'\'', '\'', '\''>;
+
     // if """ is found, skip until the closing """ is found.
-    if(literal("\"\"\"").scan(loc).is_ok())
+    if(ml_basic_quote::scan(loc))
     {
         while( ! loc.eof())
         {
-            if(literal("\"\"\"").scan(loc).is_ok())
+            if(ml_basic_quote::scan(loc))
             {
                 return;
             }
             loc.advance();
         }
     }
-    else if(literal("'''").scan(loc).is_ok())
+    else if(ml_literal_quote::scan(loc))
     {
         while( ! loc.eof())
         {
-            if(literal("'''").scan(loc).is_ok())
+            if(ml_literal_quote::scan(loc))
             {
                 return;
             }
@@ -11680,7 +13135,7 @@ guess_value_type(const location& loc, const context<TC>& ctx);
 template<typename TC>
 void skip_array_like(location& loc, const context<TC>& ctx)
 {
-    const auto& spec = ctx.toml_spec();
+    const auto& syn = ctx.syntax();
     assert(loc.current() == '[');
     loc.advance();
 
@@ -11700,11 +13155,10 @@ void skip_array_like(location& loc, const context<TC>& ctx)
         }
         else if(loc.current() == '[')
         {
-            const auto checkpoint = loc;
-            if(syntax::std_table(spec).scan(loc).is_ok() ||
-               syntax::array_table(spec).scan(loc).is_ok())
+            const auto checkpoint = loc.get_location();
+            if(syn.std_table(loc) || syn.array_table(loc))
             {
-                loc = checkpoint;
+                loc.set_location(checkpoint);
                 break;
             }
             // if it is not a table-definition, then it is an array.
@@ -11745,6 +13199,7 @@ void skip_inline_table_like(location& loc, const context<TC>& ctx)
     loc.advance();
 
     const auto& spec = ctx.toml_spec();
+    const auto& syn  = ctx.syntax();
 
     while( ! loc.eof())
     {
@@ -11767,11 +13222,10 @@ void skip_inline_table_like(location& loc, const context<TC>& ctx)
         }
         else if(loc.current() == '[')
         {
-            const auto checkpoint = loc;
-            if(syntax::std_table(spec).scan(loc).is_ok() ||
-               syntax::array_table(spec).scan(loc).is_ok())
+            const auto checkpoint = loc.get_location();
+            if(syn.std_table(loc) || syn.array_table(loc))
             {
-                loc = checkpoint;
+                loc.set_location(checkpoint);
                 break; // missing closing `}`.
             }
             // if it is not a table-definition, then it is an array.
@@ -11855,28 +13309,171 @@ void skip_key_value_pair(location& loc, const context<TC>& ctx)
 template<typename TC>
 void skip_until_next_table(location& loc, const context<TC>& ctx)
 {
-    const auto& spec = ctx.toml_spec();
+    const auto& syn = ctx.syntax();
     while( ! loc.eof())
     {
         if(loc.current() == '\n')
         {
             loc.advance();
-            const auto line_begin = loc;
+            const auto line_begin = loc.get_location();
 
             skip_whitespace(loc, ctx);
-            if(syntax::std_table(spec).scan(loc).is_ok())
+            if(syn.std_table(loc) || syn.array_table(loc))
             {
-                loc = line_begin;
+                loc.set_location(line_begin);
                 return ;
             }
-            if(syntax::array_table(spec).scan(loc).is_ok())
+        }
+        loc.advance();
+    }
+}
+
+// The functions above resynchronize the parser after an error. The ones below
+// pass over the tables that are not selected (see context::sections). They
+// are exact for valid TOML: a newline or `[` in a string, an array or an
+// inline table does not end what is being skipped.
+
+// returns the first newline in [first, last) that is not in a string, an
+// array or an inline table (or `last`). if a bracket is still open at `last`,
+// `unclosed` points to the outermost one.
+inline location::char_type const*
+find_logical_line_end(location::char_type const* first,
+                      location::char_type const* last,
+                      location::char_type const*& unclosed)
+{
+    std::size_t depth = 0;
+    unclosed = nullptr;
+    while(first != last)
+    {
+        switch(*first)
+        {
+            case '\n':
+            {
+                if(depth == 0) {return first;}
+                ++first;
+                break;
+            }
+            case '#':
             {
-                loc = line_begin;
-                return ;
+                while(first != last && *first != '\n') {++first;}
+                break;
+            }
+            case '[':
+            case '{':
+            {
+                if(depth++ == 0) {unclosed = first;}
+                ++first;
+                break;
+            }
+            case ']':
+            case '}':
+            {
+                if(depth != 0 && --depth == 0) {unclosed = nullptr;}
+                ++first;
+                break;
+            }
+            case '"':
+            case '\'':
+            {
+                const auto quote = *first;
+                const bool multiline = last - first >= 3 &&
+                    first[1] == quote && first[2] == quote;
+                first += multiline ? 3 : 1;
+                while(first != last)
+                {
+                    if(*first == '\\' && quote == '"')
+                    {
+                        first += (last - first >= 2) ? 2 : 1;
+                    }
+                    else if(*first == quote && ( ! multiline ||
+                            (last - first >= 3 && first[1] == quote && first[2] == quote)))
+                    {
+                        first += multiline ? 3 : 1;
+                        // `""""` and `"""""` end with one or two quotes in the string
+                        for(int i=0; multiline && i<2 && first != last && *first == quote; ++i)
+                        {
+                            ++first;
+                        }
+                        break;
+                    }
+                    else if(*first == '\n' && ! multiline)
+                    {
+                        break; // unterminated. let the newline end the line.
+                    }
+                    else
+                    {
+                        ++first;
+                    }
+                }
+                break;
+            }
+            default:
+            {
+                ++first;
+                break;
             }
         }
-        loc.advance();
     }
+    return last;
+}
+
+template<typename TC>
+void skip_logical_line(location& loc, context<TC>& ctx)
+{
+    const auto first = loc.source()->data();
+    const auto last  = first + loc.source()->size();
+
+    location::char_type const* unclosed = nullptr;
+    const auto end = find_logical_line_end(first + loc.get_location(), last, unclosed);
+    if(unclosed != nullptr)
+    {
+        loc.set_location(static_cast<std::size_t>(unclosed - first));
+        ctx.report_error(make_error_info("toml::parse_file: "
+            "missing closing bracket in a skipped table",
+            source_location(region(loc)), "opened here"));
+    }
+    loc.set_location(static_cast<std::size_t>(end - first));
+}
+
+// skips the key-value pairs of a table up to the next table header or EOF.
+// `loc` must be at the beginning of a line. returns where the comments of the
+// next header begin, i.e. the first of the comment lines right above it (the
+// header itself if there is none), or the end of the input.
+template<typename TC>
+std::size_t skip_table_body(location& loc, context<TC>& ctx)
+{
+    const auto first = loc.source()->data();
+    const auto last  = first + loc.source()->size();
+
+    auto iter = first + loc.get_location();
+    auto comments = last; // the first line of the current comment block
+    while(iter != last)
+    {
+        const auto line_begin = iter;
+        while(iter != last && (*iter == ' ' || *iter == '\t')) {++iter;}
+
+        // at the top level, only a table header can start with `[`.
+        if(iter != last && *iter == '[')
+        {
+            loc.set_location(static_cast<std::size_t>(line_begin - first));
+            return static_cast<std::size_t>(
+                (comments != last ? comments : line_begin) - first);
+        }
+        if(iter != last && *iter == '#')
+        {
+            if(comments == last) {comments = line_begin;}
+        }
+        else // an empty line also separates the comments from the header
+        {
+            comments = last;
+        }
+        loc.set_location(static_cast<std::size_t>(iter - first));
+        skip_logical_line(loc, ctx);
+        iter = first + loc.get_location();
+        if(iter != last) {++iter;} // newline
+    }
+    loc.set_location(loc.source()->size());
+    return loc.source()->size();
 }
 
 } // namespace detail
@@ -11922,6 +13519,7 @@ extern template void skip_until_next_table      <ordered_type_config>(location&
 
 
 #include <fstream>
+#include <map>
 #include <sstream>
 
 #include <cassert>
@@ -12010,16 +13608,17 @@ template<typename TC>
 result<cxx::optional<std::string>, error_info>
 parse_comment_line(location& loc, context<TC>& ctx)
 {
-    const auto& spec = ctx.toml_spec();
-    const auto first = loc;
+    const auto first = loc.get_location();
 
     skip_whitespace(loc, ctx);
 
-    const auto com_reg = syntax::comment(spec).scan(loc);
-    if(com_reg.is_ok())
+    const auto com_first = loc.get_location();
+    if(ctx.syntax().comment(loc))
     {
+        auto com = static_scanner::scanned_string(com_first, loc);
+
         // once comment started, newline must follow (or reach EOF).
-        if( ! loc.eof() && ! syntax::newline(spec).scan(loc).is_ok())
+        if( ! loc.eof() && ! static_syntax::newline::scan(loc))
         {
             while( ! loc.eof()) // skip until newline to continue parsing
             {
@@ -12031,11 +13630,11 @@ parse_comment_line(location& loc, context<TC>& ctx)
                 source_location(region(loc)), "but got this",
                 "Hint: most of the control characters are not allowed in comments"));
         }
-        return ok(cxx::optional<std::string>(com_reg.as_string()));
+        return ok(cxx::optional<std::string>(std::move(com)));
     }
     else
     {
-        loc = first; // rollback whitespace to parse indent
+        loc.set_location(first); // rollback whitespace to parse indent
         return ok(cxx::optional<std::string>(cxx::make_nullopt()));
     }
 }
@@ -12055,7 +13654,7 @@ parse_boolean(location& loc, const context<TC>& ctx)
 
     // ----------------------------------------------------------------------
     // check syntax
-    auto reg = syntax::boolean(spec).scan(loc);
+    auto reg = static_scanner::scan_region<static_syntax::boolean>(loc);
     if( ! reg.is_ok())
     {
         return err(make_syntax_error("toml::parse_boolean: "
@@ -12093,13 +13692,58 @@ parse_boolean(location& loc, const context<TC>& ctx)
  *                 |___/
  */
 
+// passes the digits [first, last), that may contain `_`, to TC::parse_int.
+template<typename TC>
+result<typename basic_value<TC>::integer_type, error_info>
+read_integer_chars(const char* first, const char* last, source_location src,
+                   const std::uint8_t base, std::true_type /*has_parse_int_chars*/)
+{
+    return TC::parse_int(first, last, std::move(src), base);
+}
+template<typename TC>
+result<typename basic_value<TC>::integer_type, error_info>
+read_integer_chars(const char* first, const char* last, source_location src,
+                   const std::uint8_t base, std::false_type /*has_parse_int_chars*/)
+{
+    // remove all `_` before calling TC::parse_int
+    std::string str;
+    str.reserve(static_cast<std::size_t>(last - first));
+    std::copy_if(first, last, std::back_inserter(str),
+                 [](const char c) { return c != '_'; });
+
+    if(base != 10)
+    {
+        // skip zeros at the MSB. 0x0000_0000 becomes empty.
+        str.erase(str.begin(), std::find_if(str.begin(), str.end(),
+                    [](const char c) { return c != '0'; }));
+        if(str.empty()) { str = "0"; }
+    }
+    return TC::parse_int(str, std::move(src), base);
+}
+
+// sets width and spacer from the digits [first, last) without prefix.
+inline void read_integer_format(const char* first, const char* last,
+                                integer_format_info& fmt)
+{
+    fmt.width = static_cast<std::size_t>(last - first) -
+                static_cast<std::size_t>(std::count(first, last, '_'));
+
+    const auto rfirst = cxx::make_reverse_iterator(last);
+    const auto rlast  = cxx::make_reverse_iterator(first);
+    const auto first_underscore = std::find(rfirst, rlast, '_');
+    if(first_underscore != rlast)
+    {
+        fmt.spacer = static_cast<std::size_t>(std::distance(rfirst, first_underscore));
+    }
+}
+
 template<typename TC>
 result<basic_value<TC>, error_info>
 parse_bin_integer(location& loc, const context<TC>& ctx)
 {
     const auto first = loc;
     const auto& spec = ctx.toml_spec();
-    auto reg = syntax::bin_int(spec).scan(loc);
+    auto reg = static_scanner::scan_region<static_syntax::bin_int>(loc);
     if( ! reg.is_ok())
     {
         return err(make_syntax_error("toml::parse_bin_integer: "
@@ -12107,28 +13751,17 @@ parse_bin_integer(location& loc, const context<TC>& ctx)
             syntax::bin_int(spec), loc));
     }
 
-    auto str = reg.as_string();
-
-    integer_format_info fmt;
-    fmt.fmt   = integer_format::bin;
-    fmt.width = str.size() - 2 - static_cast<std::size_t>(std::count(str.begin(), str.end(), '_'));
-
-    const auto first_underscore = std::find(str.rbegin(), str.rend(), '_');
-    if(first_underscore != str.rend())
-    {
-        fmt.spacer = static_cast<std::size_t>(std::distance(str.rbegin(), first_underscore));
-    }
-
-    // skip prefix `0b` and zeros and underscores at the MSB
-    str.erase(str.begin(), std::find(std::next(str.begin(), 2), str.end(), '1'));
-
-    // remove all `_` before calling TC::parse_int
-    str.erase(std::remove(str.begin(), str.end(), '_'), str.end());
-
-    // 0b0000_0000 becomes empty.
-    if(str.empty()) { str = "0"; }
+    // skip prefix `0b`. digits are read from the source without copying.
+    const auto* data = reinterpret_cast<const char*>(loc.source()->data());
+    const auto* head = data + first.get_location() + 2;
+    const auto* tail = data + loc.get_location();
 
-    const auto val = TC::parse_int(str, source_location(region(loc)), 2);
+    integer_format_info fmt;
+    fmt.fmt = integer_format::bin;
+    read_integer_format(head, tail, fmt);
+
+    const auto val = read_integer_chars<TC>(head, tail,
+        source_location(region(loc)), 2, detail::has_parse_int_chars<TC>{});
     if(val.is_ok())
     {
         return ok(basic_value<TC>(val.as_ok(), std::move(fmt), {}, std::move(reg)));
@@ -12148,7 +13781,7 @@ parse_oct_integer(location& loc, const context<TC>& ctx)
 {
     const auto first = loc;
     const auto& spec = ctx.toml_spec();
-    auto reg = syntax::oct_int(spec).scan(loc);
+    auto reg = static_scanner::scan_region<static_syntax::oct_int>(loc);
     if( ! reg.is_ok())
     {
         return err(make_syntax_error("toml::parse_oct_integer: "
@@ -12156,31 +13789,17 @@ parse_oct_integer(location& loc, const context<TC>& ctx)
             syntax::oct_int(spec), loc));
     }
 
-    auto str = reg.as_string();
+    // skip prefix `0o`. digits are read from the source without copying.
+    const auto* data = reinterpret_cast<const char*>(loc.source()->data());
+    const auto* head = data + first.get_location() + 2;
+    const auto* tail = data + loc.get_location();
 
     integer_format_info fmt;
-    fmt.fmt   = integer_format::oct;
-    fmt.width = str.size() - 2 - static_cast<std::size_t>(std::count(str.begin(), str.end(), '_'));
-
-    const auto first_underscore = std::find(str.rbegin(), str.rend(), '_');
-    if(first_underscore != str.rend())
-    {
-        fmt.spacer = static_cast<std::size_t>(std::distance(str.rbegin(), first_underscore));
-    }
-
-    // skip prefix `0o` and zeros and underscores at the MSB
-    str.erase(str.begin(), std::find_if(
-                std::next(str.begin(), 2), str.end(), [](const char c) {
-                    return c != '0' && c != '_';
-                }));
-
-    // remove all `_` before calling TC::parse_int
-    str.erase(std::remove(str.begin(), str.end(), '_'), str.end());
+    fmt.fmt = integer_format::oct;
+    read_integer_format(head, tail, fmt);
 
-    // 0o0000_0000 becomes empty.
-    if(str.empty()) { str = "0"; }
-
-    const auto val = TC::parse_int(str, source_location(region(loc)), 8);
+    const auto val = read_integer_chars<TC>(head, tail,
+        source_location(region(loc)), 8, detail::has_parse_int_chars<TC>{});
     if(val.is_ok())
     {
         return ok(basic_value<TC>(val.as_ok(), std::move(fmt), {}, std::move(reg)));
@@ -12198,7 +13817,7 @@ parse_hex_integer(location& loc, const context<TC>& ctx)
 {
     const auto first = loc;
     const auto& spec = ctx.toml_spec();
-    auto reg = syntax::hex_int(spec).scan(loc);
+    auto reg = static_scanner::scan_region<static_syntax::hex_int>(loc);
     if( ! reg.is_ok())
     {
         return err(make_syntax_error("toml::parse_hex_integer: "
@@ -12206,39 +13825,28 @@ parse_hex_integer(location& loc, const context<TC>& ctx)
             syntax::hex_int(spec), loc));
     }
 
-    auto str = reg.as_string();
+    // skip prefix `0x`. digits are read from the source without copying.
+    const auto* data = reinterpret_cast<const char*>(loc.source()->data());
+    const auto* head = data + first.get_location() + 2;
+    const auto* tail = data + loc.get_location();
 
     integer_format_info fmt;
-    fmt.fmt   = integer_format::hex;
-    fmt.width = str.size() - 2 - static_cast<std::size_t>(std::count(str.begin(), str.end(), '_'));
+    fmt.fmt = integer_format::hex;
+    read_integer_format(head, tail, fmt);
 
-    const auto first_underscore = std::find(str.rbegin(), str.rend(), '_');
-    if(first_underscore != str.rend())
+    // check if it uses upper/lower case.
+    // if both upper and lower case letters are found, set upper=true.
+    bool lower_found = false;
+    bool upper_found = false;
+    for(const auto* iter = head; iter != tail; ++iter)
     {
-        fmt.spacer = static_cast<std::size_t>(std::distance(str.rbegin(), first_underscore));
+        lower_found = lower_found || ('a' <= *iter && *iter <= 'f');
+        upper_found = upper_found || ('A' <= *iter && *iter <= 'F');
     }
+    fmt.uppercase = ! lower_found || upper_found;
 
-    // skip prefix `0x` and zeros and underscores at the MSB
-    str.erase(str.begin(), std::find_if(
-                std::next(str.begin(), 2), str.end(), [](const char c) {
-                    return c != '0' && c != '_';
-                }));
-
-    // remove all `_` before calling TC::parse_int
-    str.erase(std::remove(str.begin(), str.end(), '_'), str.end());
-
-    // 0x0000_0000 becomes empty.
-    if(str.empty()) { str = "0"; }
-
-    // prefix zero and _ is removed. check if it uses upper/lower case.
-    // if both upper and lower case letters are found, set upper=true.
-    const auto lower_not_found = std::find_if(str.begin(), str.end(),
-        [](const char c) { return std::islower(static_cast<int>(c)) != 0; }) == str.end();
-    const auto upper_found = std::find_if(str.begin(), str.end(),
-        [](const char c) { return std::isupper(static_cast<int>(c)) != 0; }) != str.end();
-    fmt.uppercase = lower_not_found || upper_found;
-
-    const auto val = TC::parse_int(str, source_location(region(loc)), 16);
+    const auto val = read_integer_chars<TC>(head, tail,
+        source_location(region(loc)), 16, detail::has_parse_int_chars<TC>{});
     if(val.is_ok())
     {
         return ok(basic_value<TC>(val.as_ok(), std::move(fmt), {}, std::move(reg)));
@@ -12259,7 +13867,7 @@ parse_dec_integer(location& loc, const context<TC>& ctx)
 
     // ----------------------------------------------------------------------
     // check syntax
-    auto reg = syntax::dec_int(spec).scan(loc);
+    auto reg = static_scanner::scan_region<static_syntax::dec_int>(loc);
     if( ! reg.is_ok())
     {
         return err(make_syntax_error("toml::parse_dec_integer: "
@@ -12268,24 +13876,18 @@ parse_dec_integer(location& loc, const context<TC>& ctx)
     }
 
     // ----------------------------------------------------------------------
-    // it matches. gen value
-    auto str = reg.as_string();
+    // it matches. gen value. digits are read from the source without copying.
+    const auto* data = reinterpret_cast<const char*>(loc.source()->data());
+    const auto* head = data + first.get_location();
+    const auto* tail = data + loc.get_location();
 
     integer_format_info fmt;
     fmt.fmt = integer_format::dec;
-    fmt.width = str.size() - static_cast<std::size_t>(std::count(str.begin(), str.end(), '_'));
-
-    const auto first_underscore = std::find(str.rbegin(), str.rend(), '_');
-    if(first_underscore != str.rend())
-    {
-        fmt.spacer = static_cast<std::size_t>(std::distance(str.rbegin(), first_underscore));
-    }
-
-    // remove all `_` before calling TC::parse_int
-    str.erase(std::remove(str.begin(), str.end(), '_'), str.end());
+    read_integer_format(head, tail, fmt);
 
     auto src = source_location(region(loc));
-    const auto val = TC::parse_int(str, src, 10);
+    const auto val = read_integer_chars<TC>(head, tail, std::move(src), 10,
+                                            detail::has_parse_int_chars<TC>{});
     if(val.is_err())
     {
         loc = first;
@@ -12297,7 +13899,7 @@ parse_dec_integer(location& loc, const context<TC>& ctx)
 
     if(spec.ext_num_suffix && loc.current() == '_')
     {
-        const auto sfx_reg = syntax::num_suffix(spec).scan(loc);
+        const auto sfx_reg = static_scanner::scan_region<static_syntax::num_suffix>(loc);
         if( ! sfx_reg.is_ok())
         {
             loc = first;
@@ -12383,12 +13985,12 @@ parse_floating(location& loc, const context<TC>& ctx)
     bool is_hex = false;
     std::string str;
     region reg;
-    if(spec.ext_hex_float && sequence(character('0'), character('x')).scan(loc).is_ok())
+    if(spec.ext_hex_float && static_scanner::literal<'0', 'x'>::scan(loc))
     {
         loc = first;
         is_hex = true;
 
-        reg = syntax::hex_floating(spec).scan(loc);
+        reg = static_scanner::scan_region<static_syntax::hex_floating>(loc);
         if( ! reg.is_ok())
         {
             return err(make_syntax_error("toml::parse_floating: "
@@ -12399,7 +14001,7 @@ parse_floating(location& loc, const context<TC>& ctx)
     }
     else
     {
-        reg = syntax::floating(spec).scan(loc);
+        reg = static_scanner::scan_region<static_syntax::floating>(loc);
         if( ! reg.is_ok())
         {
             return err(make_syntax_error("toml::parse_floating: "
@@ -12561,7 +14163,7 @@ parse_floating(location& loc, const context<TC>& ctx)
 
     if(spec.ext_num_suffix && loc.current() == '_')
     {
-        const auto sfx_reg = syntax::num_suffix(spec).scan(loc);
+        const auto sfx_reg = static_scanner::scan_region<static_syntax::num_suffix>(loc);
         if( ! sfx_reg.is_ok())
         {
             auto src = source_location(region(loc));
@@ -12587,6 +14189,169 @@ parse_floating(location& loc, const context<TC>& ctx)
  * |___/\__,_|\__\___|\__|_|_|_|_\___|
  */
 
+// reads `n` decimal digits. returns -1 if any of them is not a digit.
+inline int read_fixed_digits(const location::char_type* p, const std::size_t n) noexcept
+{
+    int val = 0;
+    for(std::size_t i=0; i<n; ++i)
+    {
+        const auto d = static_cast<unsigned int>(p[i]) - static_cast<unsigned int>('0');
+        if(9 < d)
+        {
+            return -1;
+        }
+        val = val * 10 + static_cast<int>(d);
+    }
+    return val;
+}
+
+inline bool is_valid_local_date(const int year, const int month, const int day) noexcept
+{
+    // We briefly check whether the input date is valid or not.
+    //     Actually, because of the historical reasons, there are several
+    // edge cases, such as 1582/10/5-1582/10/14 (only in several countries).
+    // But here, we do not care about it.
+    // It makes the code complicated and there is only low probability
+    // that such a specific date is needed in practice. If someone need to
+    // validate date accurately, that means that the one need a specialized
+    // library for their purpose in another layer.
+
+    const bool is_leap = (year % 4 == 0) && ((year % 100 != 0) || (year % 400 == 0));
+    const auto max_day = [month, is_leap]() {
+        if(month == 2)
+        {
+            return is_leap ? 29 : 28;
+        }
+        if(month == 4 || month == 6 || month == 9 || month == 11)
+        {
+            return 30;
+        }
+        return 31;
+    }();
+    return (1 <= month && month <= 12) && (1 <= day && day <= max_day);
+}
+
+// Most of the datetimes have the fixed layout `yyyy-mm-ddTHH:MM:SS[.frac]`
+// with an optional offset `Z` or `+HH:MM`. We read it at once without any
+// scanner or std::string. If it has any other form (e.g. no seconds, a bad
+// offset, or an invalid value), it fails and the generic path handles it.
+struct fixed_datetime
+{
+    int year   = 0;
+    int month  = 0;
+    int day    = 0;
+    int hour   = 0;
+    int minute = 0;
+    int second = 0;
+    int subsecond = 0; // [ns]
+    std::size_t subsecond_precision = 0;
+    datetime_delimiter_kind delimiter = datetime_delimiter_kind::upper_T;
+
+    bool has_offset   = false;
+    int offset_hour   = 0; // signed
+    int offset_minute = 0; // signed
+
+    std::size_t size = 0; // number of bytes read
+
+    local_datetime to_local_datetime() const
+    {
+        return local_datetime(
+            local_date(year, static_cast<month_t>(month - 1), day),
+            local_time(hour, minute, second,
+                subsecond / 1000000, subsecond / 1000 % 1000, subsecond % 1000));
+    }
+};
+
+inline bool read_fixed_datetime(const location& loc, fixed_datetime& dt) noexcept
+{
+    const auto& src  = *loc.source();
+    const auto* head = src.data() + loc.get_location();
+    const auto* tail = src.data() + src.size();
+
+    // 0         1
+    // 0123456789012345678
+    // yyyy-mm-ddTHH:MM:SS
+    if(tail - head < 19 || head[4] != '-' || head[7] != '-' ||
+       head[13] != ':' || head[16] != ':')
+    {
+        return false;
+    }
+    switch(head[10])
+    {
+        case 'T': { dt.delimiter = datetime_delimiter_kind::upper_T; break; }
+        case 't': { dt.delimiter = datetime_delimiter_kind::lower_t; break; }
+        case ' ': { dt.delimiter = datetime_delimiter_kind::space;   break; }
+        default : { return false; }
+    }
+    dt.year   = read_fixed_digits(head +  0, 4);
+    dt.month  = read_fixed_digits(head +  5, 2);
+    dt.day    = read_fixed_digits(head +  8, 2);
+    dt.hour   = read_fixed_digits(head + 11, 2);
+    dt.minute = read_fixed_digits(head + 14, 2);
+    dt.second = read_fixed_digits(head + 17, 2);
+    if(dt.year < 0 || dt.month < 0 || dt.day < 0 ||
+       dt.hour < 0 || dt.minute < 0 || dt.second < 0)
+    {
+        return false;
+    }
+    if( ! is_valid_local_date(dt.year, dt.month, dt.day) ||
+        24 <= dt.hour || 60 <= dt.minute || 60 < dt.second) // :60 is allowed
+    {
+        return false;
+    }
+
+    auto iter = head + 19;
+    if(iter != tail && *iter == '.')
+    {
+        ++iter;
+        const auto frac = iter;
+        while(iter != tail && '0' <= *iter && *iter <= '9')
+        {
+            ++iter;
+        }
+        if(iter == frac)
+        {
+            return false;
+        }
+        // digits after the 9th are ignored
+        dt.subsecond_precision = static_cast<std::size_t>(iter - frac);
+        dt.subsecond = 0;
+        for(std::size_t i=0; i<9; ++i)
+        {
+            dt.subsecond = dt.subsecond * 10 +
+                (i < dt.subsecond_precision ? (frac[i] - '0') : 0);
+        }
+    }
+
+    if(iter != tail && (*iter == 'Z' || *iter == 'z'))
+    {
+        dt.has_offset = true;
+        ++iter;
+    }
+    else if(iter != tail && (*iter == '+' || *iter == '-'))
+    {
+        // 012345
+        // +HH:MM
+        if(tail - iter < 6 || iter[3] != ':')
+        {
+            return false;
+        }
+        const auto h = read_fixed_digits(iter + 1, 2);
+        const auto m = read_fixed_digits(iter + 4, 2);
+        if(h < 0 || m < 0 || 24 < h || 60 < m)
+        {
+            return false;
+        }
+        const int sign = (*iter == '+') ? 1 : -1;
+        dt.has_offset    = true;
+        dt.offset_hour   = sign * h;
+        dt.offset_minute = sign * m;
+        iter += 6;
+    }
+    dt.size = static_cast<std::size_t>(iter - head);
+    return true;
+}
+
 // all the offset_datetime, local_datetime, local_date parses date part.
 template<typename TC>
 result<std::tuple<local_date, local_date_format_info, region>, error_info>
@@ -12599,7 +14364,7 @@ parse_local_date_only(location& loc, const context<TC>& ctx)
 
     // ----------------------------------------------------------------------
     // check syntax
-    auto reg = syntax::local_date(spec).scan(loc);
+    auto reg = static_scanner::scan_region<static_syntax::local_date>(loc);
     if( ! reg.is_ok())
     {
         return err(make_syntax_error("toml::parse_local_date: "
@@ -12608,71 +14373,22 @@ parse_local_date_only(location& loc, const context<TC>& ctx)
     }
 
     // ----------------------------------------------------------------------
-    // it matches. gen value
-    const auto str = reg.as_string();
+    // it matches. gen value. the syntax ensures that all of them are digits.
 
     // 0123456789
     // yyyy-mm-dd
-    const auto year_r  = from_string<int>(str.substr(0, 4));
-    const auto month_r = from_string<int>(str.substr(5, 2));
-    const auto day_r   = from_string<int>(str.substr(8, 2));
+    const auto* str  = loc.source()->data() + first.get_location();
+    const auto year  = read_fixed_digits(str + 0, 4);
+    const auto month = read_fixed_digits(str + 5, 2);
+    const auto day   = read_fixed_digits(str + 8, 2);
+    assert(0 <= year && 0 <= month && 0 <= day);
 
-    if(year_r.is_err())
-    {
-        auto src = source_location(region(first));
-        return err(make_error_info("toml::parse_local_date: "
-            "failed to read year `" + str.substr(0, 4) + "`",
-            std::move(src), "here"));
-    }
-    if(month_r.is_err())
-    {
-        auto src = source_location(region(first));
-        return err(make_error_info("toml::parse_local_date: "
-            "failed to read month `" + str.substr(5, 2) + "`",
-            std::move(src), "here"));
-    }
-    if(day_r.is_err())
+    if( ! is_valid_local_date(year, month, day))
     {
         auto src = source_location(region(first));
-        return err(make_error_info("toml::parse_local_date: "
-            "failed to read day `" + str.substr(8, 2) + "`",
-            std::move(src), "here"));
-    }
-
-    const auto year  = year_r.unwrap();
-    const auto month = month_r.unwrap();
-    const auto day   = day_r.unwrap();
-
-    {
-        // We briefly check whether the input date is valid or not.
-        //     Actually, because of the historical reasons, there are several
-        // edge cases, such as 1582/10/5-1582/10/14 (only in several countries).
-        // But here, we do not care about it.
-        // It makes the code complicated and there is only low probability
-        // that such a specific date is needed in practice. If someone need to
-        // validate date accurately, that means that the one need a specialized
-        // library for their purpose in another layer.
-
-        const bool is_leap = (year % 4 == 0) && ((year % 100 != 0) || (year % 400 == 0));
-        const auto max_day = [month, is_leap]() {
-            if(month == 2)
-            {
-                return is_leap ? 29 : 28;
-            }
-            if(month == 4 || month == 6 || month == 9 || month == 11)
-            {
-                return 30;
-            }
-            return 31;
-        }();
-
-        if((month < 1 || 12 < month) || (day < 1 || max_day < day))
-        {
-            auto src = source_location(region(first));
-            return err(make_error_info("toml::parse_local_date: invalid date.",
-                std::move(src), "month must be 01-12, day must be any of "
-                "01-28,29,30,31 depending on the month/year."));
-        }
+        return err(make_error_info("toml::parse_local_date: invalid date.",
+            std::move(src), "month must be 01-12, day must be any of "
+            "01-28,29,30,31 depending on the month/year."));
     }
 
     return ok(std::make_tuple(
@@ -12710,7 +14426,7 @@ parse_local_time_only(location& loc, const context<TC>& ctx)
 
     // ----------------------------------------------------------------------
     // check syntax
-    auto reg = syntax::local_time(spec).scan(loc);
+    auto reg = static_scanner::scan_region(ctx.syntax().local_time, loc);
     if( ! reg.is_ok())
     {
         if(spec.v1_1_0_make_seconds_optional)
@@ -12728,32 +14444,16 @@ parse_local_time_only(location& loc, const context<TC>& ctx)
     }
 
     // ----------------------------------------------------------------------
-    // it matches. gen value
-    const auto str = reg.as_string();
+    // it matches. gen value. the syntax ensures that all of them are digits.
+    const auto* str = loc.source()->data() + first.get_location();
+    const auto  len = loc.get_location() - first.get_location();
 
     // at least we have HH:MM.
     // 01234
     // HH:MM
-    const auto hour_r   = from_string<int>(str.substr(0, 2));
-    const auto minute_r = from_string<int>(str.substr(3, 2));
-
-    if(hour_r.is_err())
-    {
-        auto src = source_location(region(first));
-        return err(make_error_info("toml::parse_local_time: "
-            "failed to read hour `" + str.substr(0, 2) + "`",
-            std::move(src), "here"));
-    }
-    if(minute_r.is_err())
-    {
-        auto src = source_location(region(first));
-        return err(make_error_info("toml::parse_local_time: "
-            "failed to read minute `" + str.substr(3, 2) + "`",
-            std::move(src), "here"));
-    }
-
-    const auto hour   = hour_r.unwrap();
-    const auto minute = minute_r.unwrap();
+    const auto hour   = read_fixed_digits(str + 0, 2);
+    const auto minute = read_fixed_digits(str + 3, 2);
+    assert(0 <= hour && 0 <= minute);
 
     if((hour < 0 || 24 <= hour) || (minute < 0 || 60 <= minute))
     {
@@ -12767,28 +14467,21 @@ parse_local_time_only(location& loc, const context<TC>& ctx)
     // Since toml v1.1.0, second and subsecond part becomes optional.
     // Check the version and return if second does not exist.
 
-    if(str.size() == 5 && spec.v1_1_0_make_seconds_optional)
+    if(len == 5 && spec.v1_1_0_make_seconds_optional)
     {
         fmt.has_seconds = false;
         fmt.subsecond_precision = 0;
         return ok(std::make_tuple(local_time(hour, minute, 0), std::move(fmt), std::move(reg)));
     }
-    assert(str.at(5) == ':');
+    assert(str[5] == ':');
 
     // we have at least `:SS` part. `.subseconds` are optional.
 
     // 0         1
     // 012345678901234
     // HH:MM:SS.subsec
-    const auto sec_r = from_string<int>(str.substr(6, 2));
-    if(sec_r.is_err())
-    {
-        auto src = source_location(region(first));
-        return err(make_error_info("toml::parse_local_time: "
-            "failed to read second `" + str.substr(6, 2) + "`",
-            std::move(src), "here"));
-    }
-    const auto sec = sec_r.unwrap();
+    const auto sec = read_fixed_digits(str + 6, 2);
+    assert(0 <= sec);
 
     if(sec < 0 || 60 < sec) // :60 is allowed
     {
@@ -12797,53 +14490,27 @@ parse_local_time_only(location& loc, const context<TC>& ctx)
                     std::move(src), "second must be 00-60."));
     }
 
-    if(str.size() == 8)
+    if(len == 8)
     {
         fmt.has_seconds = true;
         fmt.subsecond_precision = 0;
         return ok(std::make_tuple(local_time(hour, minute, sec), std::move(fmt), std::move(reg)));
     }
 
-    assert(str.at(8) == '.');
-
-    auto secfrac = str.substr(9, str.size() - 9);
+    assert(str[8] == '.');
 
     fmt.has_seconds = true;
-    fmt.subsecond_precision = secfrac.size();
-
-    while(secfrac.size() < 9)
-    {
-        secfrac += '0';
-    }
-    assert(9 <= secfrac.size());
-    const auto ms_r = from_string<int>(secfrac.substr(0, 3));
-    const auto us_r = from_string<int>(secfrac.substr(3, 3));
-    const auto ns_r = from_string<int>(secfrac.substr(6, 3));
+    fmt.subsecond_precision = len - 9;
 
-    if(ms_r.is_err())
-    {
-        auto src = source_location(region(first));
-        return err(make_error_info("toml::parse_local_time: "
-            "failed to read milliseconds `" + secfrac.substr(0, 3) + "`",
-            std::move(src), "here"));
-    }
-    if(us_r.is_err())
-    {
-        auto src = source_location(region(first));
-        return err(make_error_info("toml::parse_local_time: "
-            "failed to read microseconds`" + str.substr(3, 3) + "`",
-            std::move(src), "here"));
-    }
-    if(ns_r.is_err())
+    // digits after the 9th are ignored
+    int subsec = 0;
+    for(std::size_t i=0; i<9; ++i)
     {
-        auto src = source_location(region(first));
-        return err(make_error_info("toml::parse_local_time: "
-            "failed to read nanoseconds`" + str.substr(6, 3) + "`",
-            std::move(src), "here"));
+        subsec = subsec * 10 + (i < fmt.subsecond_precision ? (str[9 + i] - '0') : 0);
     }
-    const auto ms = ms_r.unwrap();
-    const auto us = us_r.unwrap();
-    const auto ns = ns_r.unwrap();
+    const auto ms = subsec / 1000000;
+    const auto us = subsec / 1000 % 1000;
+    const auto ns = subsec % 1000;
 
     return ok(std::make_tuple(local_time(hour, minute, sec, ms, us, ns), std::move(fmt), std::move(reg)));
 }
@@ -12877,6 +14544,21 @@ parse_local_datetime(location& loc, const context<TC>& ctx)
 
     local_datetime_format_info fmt;
 
+    // ----------------------------------------------------------------------
+    // fast path. if it fails, the generic path below gives diagnostics.
+
+    fixed_datetime dt;
+    if(read_fixed_datetime(loc, dt) && ! dt.has_offset)
+    {
+        fmt.delimiter           = dt.delimiter;
+        fmt.has_seconds         = true;
+        fmt.subsecond_precision = dt.subsecond_precision;
+
+        loc.advance(dt.size);
+        region reg(first, loc);
+        return ok(basic_value<TC>(dt.to_local_datetime(), std::move(fmt), {}, std::move(reg)));
+    }
+
     // ----------------------------------------------------------------------
 
     auto date_fmt_reg = parse_local_date_only(loc, ctx);
@@ -12937,6 +14619,23 @@ parse_offset_datetime(location& loc, const context<TC>& ctx)
 
     offset_datetime_format_info fmt;
 
+    // ----------------------------------------------------------------------
+    // fast path. if it fails, the generic path below gives diagnostics.
+
+    fixed_datetime dt;
+    if(read_fixed_datetime(loc, dt) && dt.has_offset)
+    {
+        fmt.delimiter           = dt.delimiter;
+        fmt.has_seconds         = true;
+        fmt.subsecond_precision = dt.subsecond_precision;
+
+        loc.advance(dt.size);
+        region reg(first, loc);
+        offset_datetime val(dt.to_local_datetime(),
+                            time_offset(dt.offset_hour, dt.offset_minute));
+        return ok(basic_value<TC>(val, std::move(fmt), {}, std::move(reg)));
+    }
+
     // ----------------------------------------------------------------------
     // date part
 
@@ -12987,7 +14686,7 @@ parse_offset_datetime(location& loc, const context<TC>& ctx)
     // ----------------------------------------------------------------------
     // offset part
 
-    const auto ofs_reg = syntax::time_offset(spec).scan(loc);
+    const auto ofs_reg = static_scanner::scan_region<static_syntax::time_offset>(loc);
     if( ! ofs_reg.is_ok())
     {
         return err(make_syntax_error("toml::parse_offset_datetime: "
@@ -13156,8 +14855,9 @@ parse_escape_sequence(location& loc, const context<TC>& ctx)
     }
     else if(spec.v1_1_0_add_escape_sequence_x && loc.current() == 'x')
     {
-        auto scanner = sequence(character('x'), repeat_exact(2, syntax::hexdig(spec)));
-        const auto reg = scanner.scan(loc);
+        const auto reg = static_scanner::scan_region<static_scanner::sequence<
+            static_scanner::character<'x'>,
+            static_scanner::repeat_exact<2, static_syntax::hexdig>>>(loc);
         if( ! reg.is_ok())
         {
             auto src = source_location(region(loc));
@@ -13174,8 +14874,9 @@ parse_escape_sequence(location& loc, const context<TC>& ctx)
     }
     else if(loc.current() == 'u')
     {
-        auto scanner = sequence(character('u'), repeat_exact(4, syntax::hexdig(spec)));
-        const auto reg = scanner.scan(loc);
+        const auto reg = static_scanner::scan_region<static_scanner::sequence<
+            static_scanner::character<'u'>,
+            static_scanner::repeat_exact<4, static_syntax::hexdig>>>(loc);
         if( ! reg.is_ok())
         {
             auto src = source_location(region(loc));
@@ -13192,8 +14893,9 @@ parse_escape_sequence(location& loc, const context<TC>& ctx)
     }
     else if(loc.current() == 'U')
     {
-        auto scanner = sequence(character('U'), repeat_exact(8, syntax::hexdig(spec)));
-        const auto reg = scanner.scan(loc);
+        const auto reg = static_scanner::scan_region<static_scanner::sequence<
+            static_scanner::character<'U'>,
+            static_scanner::repeat_exact<8, static_syntax::hexdig>>>(loc);
         if( ! reg.is_ok())
         {
             auto src = source_location(region(loc));
@@ -13228,6 +14930,49 @@ parse_escape_sequence(location& loc, const context<TC>& ctx)
     return ok(retval);
 }
 
+// decodes the (already scanned) body of a basic string, [loc, last).
+// escape-free runs are copied at once; escape sequences are parsed in place.
+template<typename TC>
+result<typename basic_value<TC>::string_type, error_info>
+parse_basic_string_body(location loc, const std::size_t last,
+                        const bool multiline, const context<TC>& ctx)
+{
+    using string_type = typename basic_value<TC>::string_type;
+    string_type val;
+
+    const auto* data = loc.source()->data();
+    while(loc.get_location() < last)
+    {
+        const auto* head = data + loc.get_location();
+        const auto* bs   = static_cast<const unsigned char*>(
+            std::memchr(head, '\\', last - loc.get_location()));
+        if(bs == nullptr)
+        {
+            bs = data + last;
+        }
+        val.append(head, bs);
+        loc.advance(static_cast<std::size_t>(bs - head));
+
+        if(loc.get_location() < last)
+        {
+            // remove whitespaces around escaped-newline
+            if(multiline && static_syntax::escaped_newline::scan(loc))
+            {
+                continue;
+            }
+            // syntax does not check its value. the unicode codepoint may be
+            // invalid, e.g. out-of-bound, [0xD800, 0xDFFF]
+            auto esc = parse_escape_sequence(loc, ctx);
+            if(esc.is_err())
+            {
+                return err(esc.unwrap_err());
+            }
+            val += esc.unwrap();
+        }
+    }
+    return ok(val);
+}
+
 template<typename TC>
 result<basic_value<TC>, error_info>
 parse_ml_basic_string(location& loc, const context<TC>& ctx)
@@ -13238,7 +14983,7 @@ parse_ml_basic_string(location& loc, const context<TC>& ctx)
     string_format_info fmt;
     fmt.fmt = string_format::multiline_basic;
 
-    auto reg = syntax::ml_basic_string(spec).scan(loc);
+    auto reg = static_scanner::scan_region(ctx.syntax().ml_basic_string, loc);
     if( ! reg.is_ok())
     {
         return err(make_syntax_error("toml::parse_ml_basic_string: "
@@ -13249,69 +14994,26 @@ parse_ml_basic_string(location& loc, const context<TC>& ctx)
     // ----------------------------------------------------------------------
     // it matches. gen value
 
-    auto str = reg.as_string();
-
     // we already checked that it starts with """ and ends with """.
-    assert(str.substr(0, 3) == "\"\"\"");
-    str.erase(0, 3);
-
-    assert(str.size() >= 3);
-    assert(str.substr(str.size()-3, 3) == "\"\"\"");
-    str.erase(str.size()-3, 3);
+    auto body = first;
+    body.advance(3);
+    const auto body_last = loc.get_location() - 3;
+    assert(body.get_location() <= body_last);
 
     // the first newline just after """ is trimmed
-    if(str.size() >= 1 && str.at(0) == '\n')
-    {
-        str.erase(0, 1);
-        fmt.start_with_newline = true;
-    }
-    else if(str.size() >= 2 && str.at(0) == '\r' && str.at(1) == '\n')
+    if(static_syntax::newline::scan(body))
     {
-        str.erase(0, 2);
         fmt.start_with_newline = true;
     }
 
-    using string_type = typename basic_value<TC>::string_type;
-    string_type val;
+    auto val = parse_basic_string_body(std::move(body), body_last, true, ctx);
+    if(val.is_err())
     {
-        auto iter = str.cbegin();
-        while(iter != str.cend())
-        {
-            if(*iter == '\\') // remove whitespaces around escaped-newline
-            {
-                // we assume that the string is not too long to copy
-                auto loc2 = make_temporary_location(make_string(iter, str.cend()));
-                if(syntax::escaped_newline(spec).scan(loc2).is_ok())
-                {
-                    std::advance(iter, loc2.get_location()); // skip escaped newline and indent
-                    // now iter points non-WS char
-                    assert(iter == str.end() || (*iter != ' ' && *iter != '\t'));
-                }
-                else // normal escape seq.
-                {
-                    auto esc = parse_escape_sequence(loc2, ctx);
-
-                    // syntax does not check its value. the unicode codepoint may be
-                    // invalid, e.g. out-of-bound, [0xD800, 0xDFFF]
-                    if(esc.is_err())
-                    {
-                        return err(esc.unwrap_err());
-                    }
-
-                    val += esc.unwrap();
-                    std::advance(iter, loc2.get_location());
-                }
-            }
-            else // we already checked the syntax. we don't need to check it again.
-            {
-                val += static_cast<typename string_type::value_type>(*iter);
-                ++iter;
-            }
-        }
+        return err(val.unwrap_err());
     }
 
     return ok(basic_value<TC>(
-            std::move(val), std::move(fmt), {}, std::move(reg)
+            std::move(val.unwrap()), std::move(fmt), {}, std::move(reg)
         ));
 }
 
@@ -13322,7 +15024,7 @@ parse_basic_string_only(location& loc, const context<TC>& ctx)
     const auto first = loc;
     const auto& spec = ctx.toml_spec();
 
-    auto reg = syntax::basic_string(spec).scan(loc);
+    auto reg = static_scanner::scan_region(ctx.syntax().basic_string, loc);
     if( ! reg.is_ok())
     {
         return err(make_syntax_error("toml::parse_basic_string: "
@@ -13333,45 +15035,17 @@ parse_basic_string_only(location& loc, const context<TC>& ctx)
     // ----------------------------------------------------------------------
     // it matches. gen value
 
-    auto str = reg.as_string();
-
-    assert(str.back() == '\"');
-    str.pop_back();
-    assert(str.at(0) == '\"');
-    str.erase(0, 1);
-
-    using string_type = typename basic_value<TC>::string_type;
-    using char_type   = typename string_type::value_type;
-    string_type val;
+    // we already checked that it starts with " and ends with ".
+    auto body = first;
+    body.advance(1);
+    const auto body_last = loc.get_location() - 1;
 
+    auto val = parse_basic_string_body(std::move(body), body_last, false, ctx);
+    if(val.is_err())
     {
-        auto iter = str.begin();
-        while(iter != str.end())
-        {
-            if(*iter == '\\')
-            {
-                auto loc2 = make_temporary_location(make_string(iter, str.end()));
-
-                auto esc = parse_escape_sequence(loc2, ctx);
-
-                // syntax does not check its value. the unicode codepoint may be
-                // invalid, e.g. out-of-bound, [0xD800, 0xDFFF]
-                if(esc.is_err())
-                {
-                    return err(esc.unwrap_err());
-                }
-
-                val += esc.unwrap();
-                std::advance(iter, loc2.get_location());
-            }
-            else
-            {
-                val += char_type(*iter); // we already checked the syntax.
-                ++iter;
-            }
-        }
+        return err(val.unwrap_err());
     }
-    return ok(std::make_pair(val, reg));
+    return ok(std::make_pair(std::move(val.unwrap()), std::move(reg)));
 }
 
 template<typename TC>
@@ -13404,7 +15078,7 @@ parse_ml_literal_string(location& loc, const context<TC>& ctx)
     string_format_info fmt;
     fmt.fmt = string_format::multiline_literal;
 
-    auto reg = syntax::ml_literal_string(spec).scan(loc);
+    auto reg = static_scanner::scan_region<static_syntax::ml_literal_string>(loc);
     if( ! reg.is_ok())
     {
         return err(make_syntax_error("toml::parse_ml_literal_string: "
@@ -13449,7 +15123,7 @@ parse_literal_string_only(location& loc, const context<TC>& ctx)
     const auto first = loc;
     const auto& spec = ctx.toml_spec();
 
-    auto reg = syntax::literal_string(spec).scan(loc);
+    auto reg = static_scanner::scan_region<static_syntax::literal_string>(loc);
     if( ! reg.is_ok())
     {
         return err(make_syntax_error("toml::parse_literal_string: "
@@ -13460,15 +15134,11 @@ parse_literal_string_only(location& loc, const context<TC>& ctx)
     // ----------------------------------------------------------------------
     // it matches. gen value
 
-    auto str = reg.as_string();
-
-    assert(str.back() == '\'');
-    str.pop_back();
-    assert(str.at(0) == '\'');
-    str.erase(0, 1);
-
+    // we already checked that it starts with ' and ends with '.
+    // literal strings have no escape sequence. copy the body at once.
+    const auto* data = loc.source()->data();
     using string_type = typename basic_value<TC>::string_type;
-    string_type val(str.begin(), str.end());
+    string_type val(data + first.get_location() + 1, data + loc.get_location() - 1);
 
     return ok(std::make_pair(std::move(val), std::move(reg)));
 }
@@ -13503,7 +15173,7 @@ parse_string(location& loc, const context<TC>& ctx)
 
     if( ! loc.eof() && loc.current() == '"')
     {
-        if(literal("\"\"\"").scan(loc).is_ok())
+        if(static_scanner::literal<'"', '"', '"'>::scan(loc))
         {
             loc = first;
             return parse_ml_basic_string(loc, ctx);
@@ -13516,7 +15186,7 @@ parse_string(location& loc, const context<TC>& ctx)
     }
     else if( ! loc.eof() && loc.current() == '\'')
     {
-        if(literal("'''").scan(loc).is_ok())
+        if(static_scanner::literal<'\'', '\'', '\''>::scan(loc))
         {
             loc = first;
             return parse_ml_literal_string(loc, ctx);
@@ -13549,7 +15219,7 @@ parse_null(location& loc, const context<TC>& ctx)
 
     // ----------------------------------------------------------------------
     // check syntax
-    auto reg = syntax::null_value(spec).scan(loc);
+    auto reg = static_scanner::scan_region<static_syntax::null_value>(loc);
     if( ! reg.is_ok())
     {
         return err(make_syntax_error("toml::parse_null: "
@@ -13609,7 +15279,7 @@ parse_simple_key(location& loc, const context<TC>& ctx)
 
     // bare key.
 
-    if(const auto bare = syntax::unquoted_key(spec).scan(loc))
+    if(const auto bare = static_scanner::scan_region(ctx.syntax().unquoted_key, loc))
     {
         return ok(string_conv<key_type>(bare.as_string()));
     }
@@ -13636,7 +15306,6 @@ result<std::pair<std::vector<typename basic_value<TC>::key_type>, region>, error
 parse_key(location& loc, const context<TC>& ctx)
 {
     const auto first = loc;
-    const auto& spec = ctx.toml_spec();
 
     using key_type = typename basic_value<TC>::key_type;
     std::vector<key_type> keys;
@@ -13649,8 +15318,7 @@ parse_key(location& loc, const context<TC>& ctx)
         }
         keys.push_back(std::move(key.unwrap()));
 
-        auto reg = syntax::dot_sep(spec).scan(loc);
-        if( ! reg.is_ok())
+        if( ! static_syntax::dot_sep::scan(loc))
         {
             break;
         }
@@ -13689,7 +15357,7 @@ parse_key_value_pair(location& loc, context<TC>& ctx)
         return err(key_res.unwrap_err());
     }
 
-    if( ! syntax::keyval_sep(spec).scan(loc).is_ok())
+    if( ! static_syntax::keyval_sep::scan(loc))
     {
         auto e = make_syntax_error("toml::parse_key_value_pair: "
             "invalid key value separator `=`", syntax::keyval_sep(spec), loc);
@@ -13744,21 +15412,31 @@ template<typename TC>
 cxx::optional<multiline_spacer<TC>>
 skip_multiline_spacer(location& loc, context<TC>& ctx, const bool newline_found = false)
 {
-    const auto& spec = ctx.toml_spec();
-
     multiline_spacer<TC> spacer;
     spacer.newline_found = newline_found;
     spacer.indent_type   = indent_char::none;
     spacer.indent        = 0;
     spacer.comments.clear();
 
+    using spaces = static_scanner::repeat_at_least<1, static_scanner::character<' '>>;
+    using tabs   = static_scanner::repeat_at_least<1, static_scanner::character<'\t'>>;
+
     bool spacer_found = false;
     while( ! loc.eof())
     {
-        if(auto comm = sequence(syntax::comment(spec), syntax::newline(spec)).scan(loc))
+        const auto first = loc.get_location();
+
+        const bool comment_found = ctx.syntax().comment(loc) &&
+                                   static_syntax::newline::scan(loc);
+        if( ! comment_found)
+        {
+            loc.set_location(first);
+        }
+
+        if(comment_found)
         {
             spacer.newline_found = true;
-            auto comment = comm.as_string();
+            auto comment = static_scanner::scanned_string(first, loc);
             if( ! comment.empty() && comment.back() == '\n')
             {
                 comment.pop_back();
@@ -13773,7 +15451,7 @@ skip_multiline_spacer(location& loc, context<TC>& ctx, const bool newline_found
             spacer.indent = 0;
             spacer_found = true;
         }
-        else if(auto nl = syntax::newline(spec).scan(loc))
+        else if(static_syntax::newline::scan(loc))
         {
             spacer.newline_found = true;
             spacer.comments.clear();
@@ -13781,16 +15459,16 @@ skip_multiline_spacer(location& loc, context<TC>& ctx, const bool newline_found
             spacer.indent = 0;
             spacer_found = true;
         }
-        else if(auto sp = repeat_at_least(1, character(cxx::bit_cast<location::char_type>(' '))).scan(loc))
+        else if(spaces::scan(loc))
         {
             spacer.indent_type = indent_char::space;
-            spacer.indent      = static_cast<std::int32_t>(sp.length());
+            spacer.indent      = static_cast<std::int32_t>(loc.get_location() - first);
             spacer_found = true;
         }
-        else if(auto tabs = repeat_at_least(1, character(cxx::bit_cast<location::char_type>('\t'))).scan(loc))
+        else if(tabs::scan(loc))
         {
             spacer.indent_type = indent_char::tab;
-            spacer.indent      = static_cast<std::int32_t>(tabs.length());
+            spacer.indent      = static_cast<std::int32_t>(loc.get_location() - first);
             spacer_found = true;
         }
         else
@@ -13892,7 +15570,7 @@ parse_array(location& loc, context<TC>& ctx)
                 }
             }
 
-            comma_found = character(',').scan(loc).is_ok();
+            comma_found = static_scanner::character<','>::scan(loc);
 
             // parse comment after a comma
             // array = [
@@ -14061,12 +15739,41 @@ enum class inserting_value_kind : std::uint8_t
     dotted_keys  // insert a.b.c = "this"
 };
 
+// A cursor that remembers the tables resolved while walking the last key path
+// from a table. Successive insertions sharing a prefix (e.g. `[a.b.c]` after
+// `[a.b.d]`, or repeated `[[a.b]]`) start walking from the end of the common
+// prefix instead of from the root.
+//
+// Only the path to the parent of the last key is remembered. Tables are not
+// removed or replaced while parsing and each table is held by a pointer, so the
+// cached tables stay valid. An array-of-tables is appended only at the last
+// key, so the cursor never points into a stale element of it.
+//
+// A cursor must always be used with the same root table and the same kind
+// (tables or dotted keys).
+template<typename TC>
+struct table_path_cursor
+{
+    using key_type   = typename basic_value<TC>::key_type;
+    using table_type = typename basic_value<TC>::table_type;
+
+    std::vector<std::pair<key_type, table_type*>> path;
+};
+
+// An array defined by `[[array.of.tables]]` contains only tables. Checking the
+// format first avoids scanning all the elements on every append.
+template<typename TC>
+bool is_appendable_array_of_tables(const basic_value<TC>& v)
+{
+    return v.is_array() && v.as_array_fmt().fmt == array_format::array_of_tables;
+}
+
 template<typename TC>
 result<basic_value<TC>*, error_info>
 insert_value(const inserting_value_kind kind,
     typename basic_value<TC>::table_type* current_table_ptr,
     const std::vector<typename basic_value<TC>::key_type>& keys, region key_reg,
-    basic_value<TC> val)
+    basic_value<TC> val, table_path_cursor<TC>* cursor = nullptr)
 {
     using value_type = basic_value<TC>;
     using array_type = typename basic_value<TC>::array_type;
@@ -14076,6 +15783,23 @@ insert_value(const inserting_value_kind kind,
 
     assert( ! keys.empty());
 
+    // skip the common prefix of the last path
+    std::size_t first_key = 0;
+    if(cursor != nullptr)
+    {
+        auto& path = cursor->path;
+        while(first_key < path.size() && first_key + 1 < keys.size() &&
+              path[first_key].first == keys[first_key])
+        {
+            ++first_key;
+        }
+        path.resize(first_key);
+        if(first_key != 0)
+        {
+            current_table_ptr = path.back().second;
+        }
+    }
+
     // dotted key can insert to dotted key tables defined at the same level.
     // dotted key can NOT reopen a table even if it is implcitly-defined one.
     //
@@ -14095,8 +15819,13 @@ insert_value(const inserting_value_kind kind,
     // t2.t3.v = 0
     // [t1.t2] # INVALID t1.t2 is defined as a dotted-key table.
 
-    for(std::size_t i=0; i<keys.size(); ++i)
+    for(std::size_t i=first_key; i<keys.size(); ++i)
     {
+        if(cursor != nullptr && i == cursor->path.size() + 1)
+        {
+            cursor->path.emplace_back(keys.at(i-1), current_table_ptr);
+        }
+
         const auto& key = keys.at(i);
         table_type& current_table = *current_table_ptr;
 
@@ -14143,7 +15872,8 @@ insert_value(const inserting_value_kind kind,
                 assert(found->second.is_table());
                 current_table_ptr = std::addressof(found->second.as_table());
             }
-            else if(found->second.is_array_of_tables())
+            else if(is_appendable_array_of_tables(found->second) ||
+                    found->second.is_array_of_tables())
             {
                 // aot = [{this = "type", of = "aot"}] # cannot be reopened
                 if(found->second.as_array_fmt().fmt != array_format::array_of_tables)
@@ -14271,7 +16001,8 @@ insert_value(const inserting_value_kind kind,
                     }
                     else // the array is already defined, append to it
                     {
-                        if( ! found->second.is_array_of_tables())
+                        if( ! is_appendable_array_of_tables(found->second) &&
+                            ! found->second.is_array_of_tables())
                         {
                             return err(make_error_info("toml::insert_value: "
                                 "failed to insert an array of tables, value already exists",
@@ -14446,7 +16177,7 @@ parse_inline_table(location& loc, context<TC>& ctx)
                 skip_whitespace(loc, ctx);
             }
 
-            comma_found = character(',').scan(loc).is_ok();
+            comma_found = static_scanner::character<','>::scan(loc);
 
             if(spec.v1_1_0_allow_newlines_in_inline_tables)
             {
@@ -14531,15 +16262,20 @@ result<value_t, error_info>
 guess_number_type(const location& first, const context<TC>& ctx)
 {
     const auto& spec = ctx.toml_spec();
-    location loc = first;
+    location loc = first; // scanners rewind `loc` if they fail
 
-    if(syntax::offset_datetime(spec).scan(loc).is_ok())
+    fixed_datetime dt;
+    if(read_fixed_datetime(loc, dt))
+    {
+        return ok(dt.has_offset ? value_t::offset_datetime : value_t::local_datetime);
+    }
+
+    if(ctx.syntax().offset_datetime(loc))
     {
         return ok(value_t::offset_datetime);
     }
-    loc = first;
 
-    if(syntax::local_datetime(spec).scan(loc).is_ok())
+    if(ctx.syntax().local_datetime(loc))
     {
         const auto curr = loc.current();
         // if offset_datetime contains bad offset, it syntax::offset_datetime
@@ -14553,9 +16289,8 @@ guess_number_type(const location& first, const context<TC>& ctx)
         }
         return ok(value_t::local_datetime);
     }
-    loc = first;
 
-    if(syntax::local_date(spec).scan(loc).is_ok())
+    if(static_syntax::local_date::scan(loc))
     {
         // bad time may appear after this.
 
@@ -14596,19 +16331,17 @@ guess_number_type(const location& first, const context<TC>& ctx)
         }
         return ok(value_t::local_date);
     }
-    loc = first;
 
-    if(syntax::local_time(spec).scan(loc).is_ok())
+    if(ctx.syntax().local_time(loc))
     {
         return ok(value_t::local_time);
     }
-    loc = first;
 
-    if(syntax::floating(spec).scan(loc).is_ok())
+    if(static_syntax::floating::scan(loc))
     {
         if( ! loc.eof() && loc.current() == '_')
         {
-            if(spec.ext_num_suffix && syntax::num_suffix(spec).scan(loc).is_ok())
+            if(spec.ext_num_suffix && static_syntax::num_suffix::scan(loc))
             {
                 return ok(value_t::floating);
             }
@@ -14621,15 +16354,14 @@ guess_number_type(const location& first, const context<TC>& ctx)
         }
         return ok(value_t::floating);
     }
-    loc = first;
 
     if(spec.ext_hex_float)
     {
-        if(syntax::hex_floating(spec).scan(loc).is_ok())
+        if(static_syntax::hex_floating::scan(loc))
         {
             if( ! loc.eof() && loc.current() == '_')
             {
-                if(spec.ext_num_suffix && syntax::num_suffix(spec).scan(loc).is_ok())
+                if(spec.ext_num_suffix && static_syntax::num_suffix::scan(loc))
                 {
                     return ok(value_t::floating);
                 }
@@ -14642,17 +16374,16 @@ guess_number_type(const location& first, const context<TC>& ctx)
             }
             return ok(value_t::floating);
         }
-        loc = first;
     }
 
-    if(auto int_reg = syntax::integer(spec).scan(loc))
+    if(auto int_reg = static_scanner::scan_region<static_syntax::integer>(loc))
     {
         if( ! loc.eof())
         {
             const auto c = loc.current();
             if(c == '_')
             {
-                if(spec.ext_num_suffix && syntax::num_suffix(spec).scan(loc).is_ok())
+                if(spec.ext_num_suffix && static_syntax::num_suffix::scan(loc))
                 {
                     return ok(value_t::integer);
                 }
@@ -14780,7 +16511,7 @@ guess_value_type(const location& loc, const context<TC>& ctx)
         }
         case 'i' : // inf or string without quotes(syntax error).
         {
-            if(literal("inf").scan(inner).is_ok())
+            if(static_scanner::literal<'i', 'n', 'f'>::scan(inner))
             {
                 return ok(value_t::floating);
             }
@@ -14803,11 +16534,11 @@ guess_value_type(const location& loc, const context<TC>& ctx)
         {
             if(sp.ext_null_value)
             {
-                if(literal("nan").scan(inner).is_ok())
+                if(static_scanner::literal<'n', 'a', 'n'>::scan(inner))
                 {
                     return ok(value_t::floating);
                 }
-                else if(literal("null").scan(inner).is_ok())
+                else if(static_syntax::null_value::scan(inner))
                 {
                     return ok(value_t::empty);
                 }
@@ -14821,7 +16552,7 @@ guess_value_type(const location& loc, const context<TC>& ctx)
             }
             else // must be nan.
             {
-                if(literal("nan").scan(inner).is_ok())
+                if(static_scanner::literal<'n', 'a', 'n'>::scan(inner))
                 {
                     return ok(value_t::floating);
                 }
@@ -14916,7 +16647,7 @@ parse_table_key(location& loc, context<TC>& ctx)
     const auto first = loc;
     const auto& spec = ctx.toml_spec();
 
-    auto reg = syntax::std_table(spec).scan(loc);
+    auto reg = static_scanner::scan_region(ctx.syntax().std_table, loc);
     if(!reg.is_ok())
     {
         return err(make_syntax_error("toml::parse_table_key: invalid table key",
@@ -14946,7 +16677,7 @@ parse_array_table_key(location& loc, context<TC>& ctx)
     const auto first = loc;
     const auto& spec = ctx.toml_spec();
 
-    auto reg = syntax::array_table(spec).scan(loc);
+    auto reg = static_scanner::scan_region(ctx.syntax().array_table, loc);
     if(!reg.is_ok())
     {
         return err(make_syntax_error("toml::parse_array_table_key: invalid array-of-tables key",
@@ -14971,21 +16702,65 @@ parse_array_table_key(location& loc, context<TC>& ctx)
     return ok(std::make_pair(std::move(keys_res.unwrap().first), std::move(reg)));
 }
 
+// how the key `prefix + keys` relates to the sections selected in context.
+enum class section_match : std::uint8_t
+{
+    none,     // not selected. skip it.
+    ancestor, // contains a selected section. parse only the selected keys.
+    inside    // is, or is in, a selected section. parse all.
+};
+
+template<typename TC>
+section_match match_sections(const context<TC>& ctx,
+    const std::vector<typename basic_value<TC>::key_type>& prefix,
+    const std::vector<typename basic_value<TC>::key_type>& keys)
+{
+    if(ctx.sections().empty())
+    {
+        return section_match::inside;
+    }
+    const auto length = prefix.size() + keys.size();
+    auto result = section_match::none;
+    for(const auto& section : ctx.sections())
+    {
+        bool matched = true;
+        for(std::size_t i=0; matched && i < (std::min)(length, section.size()); ++i)
+        {
+            const auto& key = (i < prefix.size()) ? prefix[i] : keys[i - prefix.size()];
+            matched = (key == section[i]);
+        }
+        if( ! matched)
+        {
+            continue;
+        }
+        if(section.size() <= length)
+        {
+            return section_match::inside;
+        }
+        result = section_match::ancestor;
+    }
+    return result;
+}
+
 // called after reading [table.keys] and comments around it.
 // Since table may already contain a subtable ([x.y.z] can be defined before [x]),
 // the table that is being parsed is passed as an argument.
+// If only some of its keys are selected, `path` is the key of the table and
+// the other key-value pairs are skipped.
 template<typename TC>
 result<none_t, error_info>
-parse_table(location& loc, context<TC>& ctx, basic_value<TC>& table)
+parse_table(location& loc, context<TC>& ctx, basic_value<TC>& table,
+    const std::vector<typename basic_value<TC>::key_type>* path = nullptr)
 {
     assert(table.is_table());
 
     const auto num_errors = ctx.errors().size();
-    const auto& spec = ctx.toml_spec();
 
     // clear indent info
     table.as_table_fmt().indent_type = indent_char::none;
 
+    table_path_cursor<TC> cursor; // for dotted keys
+
     bool newline_found = true;
     while( ! loc.eof())
     {
@@ -14999,7 +16774,8 @@ parse_table(location& loc, context<TC>& ctx, basic_value<TC>& table)
             break;
         }
         // if next table is comming, return.
-        if(sequence(syntax::ws(spec), character('[')).scan(loc).is_ok())
+        if(static_scanner::sequence<static_syntax::ws,
+                static_scanner::character<'['>>::scan(loc))
         {
             loc = start;
             break;
@@ -15019,6 +16795,18 @@ parse_table(location& loc, context<TC>& ctx, basic_value<TC>& table)
         }
 
         newline_found = false; // reset
+        if(path != nullptr)
+        {
+            const auto keytop = loc;
+            const auto key_res = parse_key(loc, ctx);
+            if(key_res.is_ok() && match_sections(ctx, *path,
+                    key_res.as_ok().first) == section_match::none)
+            {
+                skip_logical_line(loc, ctx);
+                continue;
+            }
+            loc = keytop;
+        }
         if(auto kv_res = parse_key_value_pair(loc, ctx))
         {
             auto keys    = std::move(kv_res.unwrap().first.first);
@@ -15029,480 +16817,940 @@ parse_table(location& loc, context<TC>& ctx, basic_value<TC>& table)
             {
                 for(const auto& com : sp.value().comments)
                 {
-                    val.comments().push_back(com);
+                    val.comments().push_back(com);
+                }
+            }
+
+            if(auto com_res = parse_comment_line(loc, ctx))
+            {
+                if(auto com_opt = com_res.unwrap())
+                {
+                    val.comments().push_back(com_opt.value());
+                    newline_found = true; // comment includes newline at the end
+                }
+            }
+            else
+            {
+                ctx.report_error(std::move(com_res.unwrap_err()));
+            }
+
+            auto ins_res = insert_value(inserting_value_kind::dotted_keys,
+                    std::addressof(table.as_table()),
+                    keys, std::move(key_reg), std::move(val), &cursor);
+            if(ins_res.is_err())
+            {
+                ctx.report_error(std::move(ins_res.unwrap_err()));
+            }
+        }
+        else
+        {
+            ctx.report_error(std::move(kv_res.unwrap_err()));
+            skip_key_value_pair(loc, ctx);
+        }
+    }
+
+    if(num_errors < ctx.errors().size())
+    {
+        assert(ctx.has_error()); // already reported
+        return err(ctx.pop_last_error());
+    }
+    return ok();
+}
+
+template<typename TC>
+result<basic_value<TC>, std::vector<error_info>>
+parse_file(location& loc, context<TC>& ctx)
+{
+    using value_type = basic_value<TC>;
+    using table_type = typename value_type::table_type;
+    using key_type   = typename value_type::key_type;
+
+    const auto first = loc;
+    const auto& spec = ctx.toml_spec();
+    const std::vector<key_type> no_keys; // the key of the root table
+
+    if(loc.eof())
+    {
+        return ok(value_type(table_type(), table_format_info{}, {}, region(loc)));
+    }
+
+    value_type root(table_type(), table_format_info{}, {}, region(loc));
+    root.as_table_fmt().fmt = table_format::multiline;
+    root.as_table_fmt().indent_type = indent_char::none;
+
+    // parse top comment.
+    //
+    // ```toml
+    // # this is a comment for the top-level table.
+    //
+    // key = "the first value"
+    // ```
+    //
+    // ```toml
+    // # this is a comment for "the first value".
+    // key = "the first value"
+    // ```
+    while( ! loc.eof())
+    {
+        if(auto com_res = parse_comment_line(loc, ctx))
+        {
+            if(auto com_opt = com_res.unwrap())
+            {
+                root.comments().push_back(std::move(com_opt.value()));
+            }
+            else // no comment found.
+            {
+                // if it is not an empty line, clear the root comment.
+                if( ! static_scanner::sequence<static_syntax::ws,
+                        static_syntax::newline>::scan(loc))
+                {
+                    loc = first;
+                    root.comments().clear();
+                }
+                break;
+            }
+        }
+        else
+        {
+            ctx.report_error(std::move(com_res.unwrap_err()));
+            skip_comment_block(loc, ctx);
+        }
+    }
+
+    // parse root table
+    {
+        const auto res = parse_table(loc, ctx, root,
+            ctx.sections().empty() ? nullptr : std::addressof(no_keys));
+        if(res.is_err())
+        {
+            ctx.report_error(std::move(res.unwrap_err()));
+            skip_until_next_table(loc, ctx);
+        }
+    }
+
+    // parse tables
+
+    table_path_cursor<TC> cursor; // for [table] and [[array.of.tables]]
+
+    while( ! loc.eof())
+    {
+        auto sp = skip_multiline_spacer(loc, ctx, /*newline_found=*/true);
+
+        // `[table]` never starts with `[[`. try `[[array.of.tables]]` only if
+        // it looks like that, not to build an error for every `[table]`.
+        const auto keytop = loc;
+        const auto maybe_array_table = static_scanner::literal<'[', '['>::scan(loc);
+        loc = keytop;
+
+        if(maybe_array_table)
+        {
+            if(auto key_res = parse_array_table_key(loc, ctx))
+            {
+                auto key = std::move(std::get<0>(key_res.unwrap()));
+                auto reg = std::move(std::get<1>(key_res.unwrap()));
+
+                std::vector<std::string> com;
+                if(sp.has_value())
+                {
+                    for(std::size_t i=0; i<sp.value().comments.size(); ++i)
+                    {
+                        com.push_back(std::move(sp.value().comments.at(i)));
+                    }
+                }
+
+                // [table.def] must be followed by one of
+                // - a comment line
+                // - whitespace + newline
+                // - EOF
+                if(auto com_res = parse_comment_line(loc, ctx))
+                {
+                    if(auto com_opt = com_res.unwrap())
+                    {
+                        com.push_back(com_opt.value());
+                    }
+                    else // if there is no comment, ws+newline must exist (or EOF)
+                    {
+                        skip_whitespace(loc, ctx);
+                        if( ! loc.eof() && ! static_syntax::newline::scan(loc))
+                        {
+                            ctx.report_error(make_syntax_error("toml::parse_file: "
+                                "newline (or EOF) expected",
+                                syntax::newline(ctx.toml_spec()), loc));
+                            skip_until_next_table(loc, ctx);
+                            continue;
+                        }
+                    }
+                }
+                else // comment syntax error (rare)
+                {
+                    ctx.report_error(com_res.unwrap_err());
+                    skip_until_next_table(loc, ctx);
+                    continue;
+                }
+
+                const auto selected = match_sections(ctx, no_keys, key);
+                if(selected == section_match::none)
+                {
+                    // the comments above the next header belong to it.
+                    loc.set_location(skip_table_body(loc, ctx));
+                    continue;
+                }
+
+                table_format_info fmt;
+                fmt.fmt = table_format::multiline;
+                fmt.indent_type = indent_char::none;
+                auto tab = value_type(table_type{}, std::move(fmt), std::move(com), reg);
+
+                auto inserted = insert_value(inserting_value_kind::array_table,
+                    std::addressof(root.as_table()),
+                    key, std::move(reg), std::move(tab), &cursor);
+
+                if(inserted.is_err())
+                {
+                    ctx.report_error(inserted.unwrap_err());
+
+                    // check errors in the table
+                    auto tmp = basic_value<TC>(table_type());
+                    auto res = parse_table(loc, ctx, tmp);
+                    if(res.is_err())
+                    {
+                        ctx.report_error(res.unwrap_err());
+                        skip_until_next_table(loc, ctx);
+                    }
+                    continue;
+                }
+
+                auto tab_ptr = inserted.unwrap();
+                assert(tab_ptr);
+
+                const auto tab_res = parse_table(loc, ctx, *tab_ptr,
+                    selected == section_match::ancestor ? std::addressof(key) : nullptr);
+                if(tab_res.is_err())
+                {
+                    ctx.report_error(tab_res.unwrap_err());
+                    skip_until_next_table(loc, ctx);
+                }
+
+                // parse_table first clears `indent_type`.
+                // to keep header indent info, we must store it later.
+                if(sp.has_value() && sp.value().indent_type != indent_char::none)
+                {
+                    tab_ptr->as_table_fmt().indent_type = sp.value().indent_type;
+                    tab_ptr->as_table_fmt().name_indent = sp.value().indent;
+                }
+                continue;
+            }
+        }
+        if(auto key_res = parse_table_key(loc, ctx))
+        {
+            auto key = std::move(std::get<0>(key_res.unwrap()));
+            auto reg = std::move(std::get<1>(key_res.unwrap()));
+
+            std::vector<std::string> com;
+            if(sp.has_value())
+            {
+                for(std::size_t i=0; i<sp.value().comments.size(); ++i)
+                {
+                    com.push_back(std::move(sp.value().comments.at(i)));
+                }
+            }
+
+            // [table.def] must be followed by one of
+            // - a comment line
+            // - whitespace + newline
+            // - EOF
+            if(auto com_res = parse_comment_line(loc, ctx))
+            {
+                if(auto com_opt = com_res.unwrap())
+                {
+                    com.push_back(com_opt.value());
+                }
+                else // if there is no comment, ws+newline must exist (or EOF)
+                {
+                    skip_whitespace(loc, ctx);
+                    if( ! loc.eof() && ! static_syntax::newline::scan(loc))
+                    {
+                        ctx.report_error(make_syntax_error("toml::parse_file: "
+                            "newline (or EOF) expected",
+                            syntax::newline(ctx.toml_spec()), loc));
+                        skip_until_next_table(loc, ctx);
+                        continue;
+                    }
+                }
+            }
+            else // comment syntax error (rare)
+            {
+                ctx.report_error(com_res.unwrap_err());
+                skip_until_next_table(loc, ctx);
+                continue;
+            }
+
+            const auto selected = match_sections(ctx, no_keys, key);
+            if(selected == section_match::none)
+            {
+                // the comments above the next header belong to it.
+                loc.set_location(skip_table_body(loc, ctx));
+                continue;
+            }
+
+            table_format_info fmt;
+            fmt.fmt = table_format::multiline;
+            fmt.indent_type = indent_char::none;
+            auto tab = value_type(table_type{}, std::move(fmt), std::move(com), reg);
+
+            auto inserted = insert_value(inserting_value_kind::std_table,
+                std::addressof(root.as_table()),
+                key, std::move(reg), std::move(tab), &cursor);
+
+            if(inserted.is_err())
+            {
+                ctx.report_error(inserted.unwrap_err());
+
+                // check errors in the table
+                auto tmp = basic_value<TC>(table_type());
+                auto res = parse_table(loc, ctx, tmp);
+                if(res.is_err())
+                {
+                    ctx.report_error(res.unwrap_err());
+                    skip_until_next_table(loc, ctx);
                 }
+                continue;
             }
 
-            if(auto com_res = parse_comment_line(loc, ctx))
+            auto tab_ptr = inserted.unwrap();
+            assert(tab_ptr);
+
+            const auto tab_res = parse_table(loc, ctx, *tab_ptr,
+                selected == section_match::ancestor ? std::addressof(key) : nullptr);
+            if(tab_res.is_err())
             {
-                if(auto com_opt = com_res.unwrap())
-                {
-                    val.comments().push_back(com_opt.value());
-                    newline_found = true; // comment includes newline at the end
-                }
+                ctx.report_error(tab_res.unwrap_err());
+                skip_until_next_table(loc, ctx);
             }
-            else
+            if(sp.has_value() && sp.value().indent_type != indent_char::none)
             {
-                ctx.report_error(std::move(com_res.unwrap_err()));
+                tab_ptr->as_table_fmt().indent_type = sp.value().indent_type;
+                tab_ptr->as_table_fmt().name_indent = sp.value().indent;
             }
+            continue;
+        }
 
-            auto ins_res = insert_value(inserting_value_kind::dotted_keys,
-                    std::addressof(table.as_table()),
-                    keys, std::move(key_reg), std::move(val));
-            if(ins_res.is_err())
-            {
-                ctx.report_error(std::move(ins_res.unwrap_err()));
-            }
+        // does not match array_table nor std_table. report an error.
+        if(maybe_array_table)
+        {
+            ctx.report_error(make_syntax_error("toml::parse_file: invalid array-table key",
+                syntax::array_table(spec), loc));
         }
         else
         {
-            ctx.report_error(std::move(kv_res.unwrap_err()));
-            skip_key_value_pair(loc, ctx);
+            ctx.report_error(make_syntax_error("toml::parse_file: invalid table key",
+                syntax::std_table(spec), loc));
         }
+        skip_until_next_table(loc, ctx);
     }
 
-    if(num_errors < ctx.errors().size())
+    if( ! ctx.errors().empty())
     {
-        assert(ctx.has_error()); // already reported
-        return err(ctx.pop_last_error());
+        return err(std::move(ctx.errors()));
     }
-    return ok();
+    return ok(std::move(root));
 }
 
+// the input must end with LF or CR, or be empty.
 template<typename TC>
 result<basic_value<TC>, std::vector<error_info>>
-parse_file(location& loc, context<TC>& ctx)
+parse_impl(location::source_ptr src, std::string fname, const spec& s,
+    std::vector<std::vector<typename basic_value<TC>::key_type>> sections = {})
 {
     using value_type = basic_value<TC>;
     using table_type = typename value_type::table_type;
 
-    const auto first = loc;
-    const auto& spec = ctx.toml_spec();
+    // an empty file is a valid toml file.
+    if(src->empty())
+    {
+        location loc(std::move(src), std::move(fname));
+        return ok(value_type(table_type(), table_format_info{}, std::vector<std::string>{}, region(loc)));
+    }
 
-    if(loc.eof())
+    // region stores 32-bit offsets.
+    if((std::numeric_limits<std::uint32_t>::max)() < src->size())
     {
-        return ok(value_type(table_type(), table_format_info{}, {}, region(loc)));
+        std::vector<error_info> e;
+        e.push_back(error_info("toml::parse: the input \"" + fname +
+                    "\" is too large. It must be smaller than 4 GiB.", {}));
+        return err(std::move(e));
     }
+    assert(src->back() == '\n' || src->back() == '\r');
 
-    value_type root(table_type(), table_format_info{}, {}, region(loc));
-    root.as_table_fmt().fmt = table_format::multiline;
-    root.as_table_fmt().indent_type = indent_char::none;
+    location loc(std::move(src), std::move(fname));
 
-    // parse top comment.
-    //
-    // ```toml
-    // # this is a comment for the top-level table.
-    //
-    // key = "the first value"
-    // ```
-    //
-    // ```toml
-    // # this is a comment for "the first value".
-    // key = "the first value"
-    // ```
-    while( ! loc.eof())
+    // skip BOM if found
+    if(loc.source()->size() >= 3)
     {
-        if(auto com_res = parse_comment_line(loc, ctx))
+        auto first = loc.get_location();
+
+        const auto c0 = loc.current(); loc.advance();
+        const auto c1 = loc.current(); loc.advance();
+        const auto c2 = loc.current(); loc.advance();
+
+        const auto bom_found = (c0 == 0xEF) && (c1 == 0xBB) && (c2 == 0xBF);
+        if( ! bom_found)
         {
-            if(auto com_opt = com_res.unwrap())
+            loc.set_location(first);
+        }
+    }
+
+    context<TC> ctx(s);
+    ctx.set_sections(std::move(sections));
+
+    return parse_file(loc, ctx);
+}
+
+template<typename TC>
+result<basic_value<TC>, std::vector<error_info>>
+parse_impl(std::vector<location::char_type> cs, std::string fname, const spec& s,
+    std::vector<std::vector<typename basic_value<TC>::key_type>> sections = {})
+{
+    // to simplify parser, add newline at the end if there is no LF.
+    // But, if it has raw CR, the file is invalid (in TOML, CR is not a valid
+    // newline char). if it ends with CR, do not add LF and report it.
+    if( ! cs.empty() && cs.back() != '\n' && cs.back() != '\r')
+    {
+        cs.push_back('\n');
+    }
+    auto src = std::make_shared<const source_buffer>(
+        std::make_shared<const std::vector<location::char_type>>(std::move(cs)));
+
+    return parse_impl<TC>(std::move(src), std::move(fname), s, std::move(sections));
+}
+
+// parses [first, last) of a source that has already passed parse_impl's
+// checks. `last` must be at the beginning of a line or at the end. The parser
+// reads a view that ends at `last` and keeps the whole source alive, so that
+// the offsets, and the line numbers in errors, are those of the whole input.
+template<typename TC>
+result<basic_value<TC>, std::vector<error_info>>
+parse_range(const location::source_ptr& src, std::string fname,
+    const std::size_t first, const std::size_t last, const spec& s,
+    std::vector<std::vector<typename basic_value<TC>::key_type>> sections = {})
+{
+    assert(first <= last && last <= src->size());
+
+    location loc(std::make_shared<const source_buffer>(src->data(), last, src),
+                 std::move(fname));
+    loc.set_location(first);
+
+    context<TC> ctx(s);
+    ctx.set_sections(std::move(sections));
+
+    return parse_file(loc, ctx);
+}
+
+// reads the rest of the stream. it does not need to be seekable.
+inline std::vector<location::char_type> read_stream(std::istream& is)
+{
+    std::vector<location::char_type> letters;
+
+    const auto beg = is.tellg();
+    if(beg != std::istream::pos_type(-1))
+    {
+        is.seekg(0, std::ios::end);
+        const auto end = is.tellg();
+        const auto fsize = end - beg;
+        is.seekg(beg);
+
+        // read whole file as a sequence of char. +1 for the LF that
+        // parse_impl may append, so that it does not copy the contents.
+        assert(fsize >= 0);
+        letters.reserve(static_cast<std::size_t>(fsize) + 1);
+        letters.resize(static_cast<std::size_t>(fsize), '\0');
+        is.read(reinterpret_cast<char*>(letters.data()), static_cast<std::streamsize>(fsize));
+    }
+    else // not seekable (a pipe, a socket, ...). read chunks until EOF.
+    {
+        std::size_t used = 0;
+        while(true)
+        {
+            if(used == letters.size())
             {
-                root.comments().push_back(std::move(com_opt.value()));
+                letters.resize((std::max)(letters.size() * 2, std::size_t(65536)), '\0');
             }
-            else // no comment found.
+            const auto got = is.rdbuf()->sgetn(
+                reinterpret_cast<char*>(letters.data() + used),
+                static_cast<std::streamsize>(letters.size() - used));
+            if(got <= 0)
             {
-                // if it is not an empty line, clear the root comment.
-                if( ! sequence(syntax::ws(spec), syntax::newline(spec)).scan(loc).is_ok())
-                {
-                    loc = first;
-                    root.comments().clear();
-                }
                 break;
             }
+            used += static_cast<std::size_t>(got);
         }
-        else
+        // the doubling may have left up to twice the input allocated. copy
+        // it into a buffer of the same size as the seekable case reads into.
+        std::vector<location::char_type> exact;
+        exact.reserve(used + 1);
+        exact.assign(letters.begin(), letters.begin() + static_cast<std::ptrdiff_t>(used));
+        letters.swap(exact);
+    }
+    return letters;
+}
+
+} // detail
+
+// -----------------------------------------------------------------------------
+// parse(byte array)
+
+template<typename TC = type_config>
+result<basic_value<TC>, std::vector<error_info>>
+try_parse(std::vector<unsigned char> content, std::string filename,
+          spec s = spec::default_version())
+{
+    return detail::parse_impl<TC>(std::move(content), std::move(filename), std::move(s));
+}
+template<typename TC = type_config>
+basic_value<TC>
+parse(std::vector<unsigned char> content, std::string filename,
+      spec s = spec::default_version())
+{
+    auto res = try_parse<TC>(std::move(content), std::move(filename), std::move(s));
+    if(res.is_ok())
+    {
+        return res.unwrap();
+    }
+    else
+    {
+        std::string msg;
+        for(const auto& err : res.unwrap_err())
         {
-            ctx.report_error(std::move(com_res.unwrap_err()));
-            skip_comment_block(loc, ctx);
+            msg += format_error(err);
+        }
+        throw syntax_error(std::move(msg), std::move(res.unwrap_err()));
+    }
+}
+
+// -----------------------------------------------------------------------------
+// parse(borrowed bytes)
+//
+// parses [first, first+size) in place. `owner` keeps the memory alive while
+// any value or error refers to it. The parser needs a newline at the end, so
+// the input is copied only if it does not end with one.
+
+template<typename TC = type_config>
+result<basic_value<TC>, std::vector<error_info>>
+try_parse(const unsigned char* first, const std::size_t size,
+          std::shared_ptr<const void> owner, std::string filename,
+          spec s = spec::default_version())
+{
+    if(size != 0 && (first[size-1] == '\n' || first[size-1] == '\r'))
+    {
+        auto src = std::make_shared<const detail::source_buffer>(
+                first, size, std::move(owner));
+        return detail::parse_impl<TC>(std::move(src), std::move(filename), std::move(s));
+    }
+    return detail::parse_impl<TC>(std::vector<unsigned char>(first, first + size),
+            std::move(filename), std::move(s));
+}
+template<typename TC = type_config>
+basic_value<TC>
+parse(const unsigned char* first, const std::size_t size,
+      std::shared_ptr<const void> owner, std::string filename,
+      spec s = spec::default_version())
+{
+    auto res = try_parse<TC>(first, size, std::move(owner), std::move(filename), std::move(s));
+    if(res.is_ok())
+    {
+        return res.unwrap();
+    }
+    else
+    {
+        std::string msg;
+        for(const auto& err : res.unwrap_err())
+        {
+            msg += format_error(err);
+        }
+        throw syntax_error(std::move(msg), std::move(res.unwrap_err()));
+    }
+}
+
+// -----------------------------------------------------------------------------
+// parse(istream)
+
+template<typename TC = type_config>
+result<basic_value<TC>, std::vector<error_info>>
+try_parse(std::istream& is, std::string fname = "unknown file", spec s = spec::default_version())
+{
+    return detail::parse_impl<TC>(detail::read_stream(is), std::move(fname), std::move(s));
+}
+
+template<typename TC = type_config>
+basic_value<TC> parse(std::istream& is, std::string fname = "unknown file", spec s = spec::default_version())
+{
+    auto res = try_parse<TC>(is, std::move(fname), std::move(s));
+    if(res.is_ok())
+    {
+        return res.unwrap();
+    }
+    else
+    {
+        std::string msg;
+        for(const auto& err : res.unwrap_err())
+        {
+            msg += format_error(err);
         }
+        throw syntax_error(std::move(msg), std::move(res.unwrap_err()));
     }
+}
+
+// -----------------------------------------------------------------------------
+// parse(filename)
+
+template<typename TC = type_config>
+result<basic_value<TC>, std::vector<error_info>>
+try_parse(std::string fname, spec s = spec::default_version())
+{
+    std::ifstream ifs(fname, std::ios_base::binary);
+    if(!ifs.good())
+    {
+        std::vector<error_info> e;
+        e.push_back(error_info("toml::parse: Error opening file \"" + fname + "\"", {}));
+        return err(std::move(e));
+    }
+    ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
+    return try_parse<TC>(ifs, std::move(fname), std::move(s));
+}
+
+template<typename TC = type_config>
+basic_value<TC> parse(std::string fname, spec s = spec::default_version())
+{
+    std::ifstream ifs(fname, std::ios_base::binary);
+    if(!ifs.good())
+    {
+        throw file_io_error("toml::parse: error opening file", fname);
+    }
+    ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
+    return parse<TC>(ifs, std::move(fname), std::move(s));
+}
 
-    // parse root table
+template<typename TC = type_config, std::size_t N>
+result<basic_value<TC>, std::vector<error_info>>
+try_parse(const char (&fname)[N], spec s = spec::default_version())
+{
+    return try_parse<TC>(std::string(fname), std::move(s));
+}
+
+template<typename TC = type_config, std::size_t N>
+basic_value<TC> parse(const char (&fname)[N], spec s = spec::default_version())
+{
+    return parse<TC>(std::string(fname), std::move(s));
+}
+
+// -----------------------------------------------------------------------------
+// parse_sections(filename or stream, sections)
+//
+// parses only the listed tables and everything under them, e.g. {"tool", "app"}
+// for [tool.app]. the other tables are skipped without being validated, and a
+// table that contains a listed one keeps only the keys that lead to it. an
+// empty list parses the whole file.
+
+template<typename TC = type_config>
+result<basic_value<TC>, std::vector<error_info>>
+try_parse_sections(std::string fname,
+    std::vector<std::vector<typename basic_value<TC>::key_type>> sections,
+    spec s = spec::default_version())
+{
+    std::ifstream ifs(fname, std::ios_base::binary);
+    if(!ifs.good())
     {
-        const auto res = parse_table(loc, ctx, root);
-        if(res.is_err())
-        {
-            ctx.report_error(std::move(res.unwrap_err()));
-            skip_until_next_table(loc, ctx);
-        }
+        std::vector<error_info> e;
+        e.push_back(error_info("toml::parse: Error opening file \"" + fname + "\"", {}));
+        return err(std::move(e));
     }
+    ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
 
-    // parse tables
+    return detail::parse_impl<TC>(detail::read_stream(ifs), std::move(fname), std::move(s),
+                                  std::move(sections));
+}
 
-    while( ! loc.eof())
+template<typename TC = type_config>
+basic_value<TC> parse_sections(std::istream& is, std::string fname,
+    std::vector<std::vector<typename basic_value<TC>::key_type>> sections,
+    spec s = spec::default_version())
+{
+    auto res = detail::parse_impl<TC>(detail::read_stream(is), std::move(fname),
+                                      std::move(s), std::move(sections));
+    if(res.is_ok())
     {
-        auto sp = skip_multiline_spacer(loc, ctx, /*newline_found=*/true);
-
-        if(auto key_res = parse_array_table_key(loc, ctx))
-        {
-            auto key = std::move(std::get<0>(key_res.unwrap()));
-            auto reg = std::move(std::get<1>(key_res.unwrap()));
+        return res.unwrap();
+    }
+    std::string msg;
+    for(const auto& err : res.unwrap_err())
+    {
+        msg += format_error(err);
+    }
+    throw syntax_error(std::move(msg), std::move(res.unwrap_err()));
+}
 
-            std::vector<std::string> com;
-            if(sp.has_value())
-            {
-                for(std::size_t i=0; i<sp.value().comments.size(); ++i)
-                {
-                    com.push_back(std::move(sp.value().comments.at(i)));
-                }
-            }
+template<typename TC = type_config>
+basic_value<TC> parse_sections(std::string fname,
+    std::vector<std::vector<typename basic_value<TC>::key_type>> sections,
+    spec s = spec::default_version())
+{
+    std::ifstream ifs(fname, std::ios_base::binary);
+    if(!ifs.good())
+    {
+        throw file_io_error("toml::parse: error opening file", fname);
+    }
+    ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    return parse_sections<TC>(ifs, std::move(fname), std::move(sections), std::move(s));
+}
 
-            // [table.def] must be followed by one of
-            // - a comment line
-            // - whitespace + newline
-            // - EOF
-            if(auto com_res = parse_comment_line(loc, ctx))
-            {
-                if(auto com_opt = com_res.unwrap())
-                {
-                    com.push_back(com_opt.value());
-                }
-                else // if there is no comment, ws+newline must exist (or EOF)
-                {
-                    skip_whitespace(loc, ctx);
-                    if( ! loc.eof() && ! syntax::newline(ctx.toml_spec()).scan(loc).is_ok())
-                    {
-                        ctx.report_error(make_syntax_error("toml::parse_file: "
-                            "newline (or EOF) expected",
-                            syntax::newline(ctx.toml_spec()), loc));
-                        skip_until_next_table(loc, ctx);
-                        continue;
-                    }
-                }
-            }
-            else // comment syntax error (rare)
-            {
-                ctx.report_error(com_res.unwrap_err());
-                skip_until_next_table(loc, ctx);
-                continue;
-            }
+// -----------------------------------------------------------------------------
+// index_sections(filename) and parse_section
+//
+// reads a file and parses only the key-value pairs of its root table. The
+// other tables are located, but not parsed; each top-level key defined by
+// table headers becomes a section that parse_section reads on demand, e.g.
+// "tool" for [tool.app] and [tool.other]. Until then, the root holds an empty
+// table (or array of tables) in its place, and the contents of the section
+// are not validated.
 
-            table_format_info fmt;
-            fmt.fmt = table_format::multiline;
-            fmt.indent_type = indent_char::none;
-            auto tab = value_type(table_type{}, std::move(fmt), std::move(com), reg);
+template<typename TC = type_config>
+struct section_index
+{
+    using value_type = basic_value<TC>;
+    using key_type   = typename value_type::key_type;
 
-            auto inserted = insert_value(inserting_value_kind::array_table,
-                std::addressof(root.as_table()),
-                key, std::move(reg), std::move(tab));
+    struct section
+    {
+        key_type    key;
+        std::size_t first; // where parsing starts: the comments above its first header
+        std::size_t last;  // where its last table ends
+    };
 
-            if(inserted.is_err())
-            {
-                ctx.report_error(inserted.unwrap_err());
+    value_type                   root;
+    std::vector<section>         sections; // in the order of the root table
+    detail::location::source_ptr source;
+    std::string                  name;
+    spec                         toml_spec = spec::default_version();
+};
 
-                // check errors in the table
-                auto tmp = basic_value<TC>(table_type());
-                auto res = parse_table(loc, ctx, tmp);
-                if(res.is_err())
-                {
-                    ctx.report_error(res.unwrap_err());
-                    skip_until_next_table(loc, ctx);
-                }
-                continue;
-            }
+namespace detail
+{
 
-            auto tab_ptr = inserted.unwrap();
-            assert(tab_ptr);
+template<typename TC>
+result<section_index<TC>, std::vector<error_info>>
+index_impl(location::source_ptr src, std::string fname, const spec& s)
+{
+    using value_type = basic_value<TC>;
+    using table_type = typename value_type::table_type;
+    using array_type = typename value_type::array_type;
+    using key_type   = typename value_type::key_type;
 
-            const auto tab_res = parse_table(loc, ctx, *tab_ptr);
-            if(tab_res.is_err())
-            {
-                ctx.report_error(tab_res.unwrap_err());
-                skip_until_next_table(loc, ctx);
-            }
+    section_index<TC> index;
+    index.toml_spec = s;
 
-            // parse_table first clears `indent_type`.
-            // to keep header indent info, we must store it later.
-            if(sp.has_value() && sp.value().indent_type != indent_char::none)
-            {
-                tab_ptr->as_table_fmt().indent_type = sp.value().indent_type;
-                tab_ptr->as_table_fmt().name_indent = sp.value().indent;
-            }
-            continue;
-        }
-        if(auto key_res = parse_table_key(loc, ctx))
+    // an empty or too large input has no section. parse_impl handles it.
+    if(src->empty() || (std::numeric_limits<std::uint32_t>::max)() < src->size())
+    {
+        auto res = parse_impl<TC>(src, fname, s);
+        if(res.is_err())
         {
-            auto key = std::move(std::get<0>(key_res.unwrap()));
-            auto reg = std::move(std::get<1>(key_res.unwrap()));
-
-            std::vector<std::string> com;
-            if(sp.has_value())
-            {
-                for(std::size_t i=0; i<sp.value().comments.size(); ++i)
-                {
-                    com.push_back(std::move(sp.value().comments.at(i)));
-                }
-            }
-
-            // [table.def] must be followed by one of
-            // - a comment line
-            // - whitespace + newline
-            // - EOF
-            if(auto com_res = parse_comment_line(loc, ctx))
-            {
-                if(auto com_opt = com_res.unwrap())
-                {
-                    com.push_back(com_opt.value());
-                }
-                else // if there is no comment, ws+newline must exist (or EOF)
-                {
-                    skip_whitespace(loc, ctx);
-                    if( ! loc.eof() && ! syntax::newline(ctx.toml_spec()).scan(loc).is_ok())
-                    {
-                        ctx.report_error(make_syntax_error("toml::parse_file: "
-                            "newline (or EOF) expected",
-                            syntax::newline(ctx.toml_spec()), loc));
-                        skip_until_next_table(loc, ctx);
-                        continue;
-                    }
-                }
-            }
-            else // comment syntax error (rare)
-            {
-                ctx.report_error(com_res.unwrap_err());
-                skip_until_next_table(loc, ctx);
-                continue;
-            }
+            return err(std::move(res.unwrap_err()));
+        }
+        index.root   = std::move(res.unwrap());
+        index.source = std::move(src);
+        index.name   = std::move(fname);
+        return ok(std::move(index));
+    }
+    assert(src->back() == '\n' || src->back() == '\r');
 
-            table_format_info fmt;
-            fmt.fmt = table_format::multiline;
-            fmt.indent_type = indent_char::none;
-            auto tab = value_type(table_type{}, std::move(fmt), std::move(com), reg);
+    const std::size_t begin = (src->size() >= 3 && (*src)[0] == 0xEF &&
+        (*src)[1] == 0xBB && (*src)[2] == 0xBF) ? 3 : 0; // skip BOM
 
-            auto inserted = insert_value(inserting_value_kind::std_table,
-                std::addressof(root.as_table()),
-                key, std::move(reg), std::move(tab));
+    location loc(src, fname);
+    loc.set_location(begin);
+    context<TC> ctx(s);
 
-            if(inserted.is_err())
-            {
-                ctx.report_error(inserted.unwrap_err());
+    const auto root_last = skip_table_body(loc, ctx);
 
-                // check errors in the table
-                auto tmp = basic_value<TC>(table_type());
-                auto res = parse_table(loc, ctx, tmp);
-                if(res.is_err())
-                {
-                    ctx.report_error(res.unwrap_err());
-                    skip_until_next_table(loc, ctx);
-                }
-                continue;
-            }
+    std::map<key_type, std::size_t> found; // key -> index in sections
+    std::vector<bool> is_array;
+    auto lead = root_last;
+    while( ! loc.eof())
+    {
+        const auto header_first = lead;
 
-            auto tab_ptr = inserted.unwrap();
-            assert(tab_ptr);
+        skip_whitespace(loc, ctx);
+        const auto keytop = loc;
+        const auto array_table = static_scanner::literal<'[', '['>::scan(loc);
+        loc = keytop;
 
-            const auto tab_res = parse_table(loc, ctx, *tab_ptr);
-            if(tab_res.is_err())
-            {
-                ctx.report_error(tab_res.unwrap_err());
-                skip_until_next_table(loc, ctx);
-            }
-            if(sp.has_value() && sp.value().indent_type != indent_char::none)
-            {
-                tab_ptr->as_table_fmt().indent_type = sp.value().indent_type;
-                tab_ptr->as_table_fmt().name_indent = sp.value().indent;
-            }
+        auto key_res = array_table ? parse_array_table_key(loc, ctx) :
+                                     parse_table_key(loc, ctx);
+        if(key_res.is_err())
+        {
+            ctx.report_error(std::move(key_res.unwrap_err()));
+            skip_logical_line(loc, ctx);
+            loc.advance();
+            lead = skip_table_body(loc, ctx);
             continue;
         }
+        const auto keys = std::move(key_res.unwrap().first);
 
-        // does not match array_table nor std_table. report an error.
-        const auto keytop = loc;
-        const auto maybe_array_of_tables = literal("[[").scan(loc).is_ok();
-        loc = keytop;
+        // [table.def] must be followed by a comment, a newline or EOF.
+        skip_whitespace(loc, ctx);
+        const auto c = loc.current();
+        if( ! loc.eof() && c != '#' && c != '\n' && c != '\r')
+        {
+            ctx.report_error(make_syntax_error("toml::parse_file: "
+                "newline (or EOF) expected", syntax::newline(s), loc));
+        }
+        skip_logical_line(loc, ctx);
+        loc.advance(); // newline
+        lead = skip_table_body(loc, ctx);
 
-        if(maybe_array_of_tables)
+        const auto inserted = found.emplace(keys.front(), index.sections.size());
+        if(inserted.second)
         {
-            ctx.report_error(make_syntax_error("toml::parse_file: invalid array-table key",
-                syntax::array_table(spec), loc));
+            index.sections.push_back({keys.front(), header_first, lead});
+            is_array.push_back(array_table && keys.size() == 1);
         }
         else
         {
-            ctx.report_error(make_syntax_error("toml::parse_file: invalid table key",
-                syntax::std_table(spec), loc));
+            index.sections.at(inserted.first->second).last = lead;
         }
-        skip_until_next_table(loc, ctx);
     }
-
     if( ! ctx.errors().empty())
     {
         return err(std::move(ctx.errors()));
     }
-    return ok(std::move(root));
-}
-
-template<typename TC>
-result<basic_value<TC>, std::vector<error_info>>
-parse_impl(std::vector<location::char_type> cs, std::string fname, const spec& s)
-{
-    using value_type = basic_value<TC>;
-    using table_type = typename value_type::table_type;
-
-    // an empty file is a valid toml file.
-    if(cs.empty())
-    {
-        auto src = std::make_shared<std::vector<location::char_type>>(std::move(cs));
-        location loc(std::move(src), std::move(fname));
-        return ok(value_type(table_type(), table_format_info{}, std::vector<std::string>{}, region(loc)));
-    }
-
-    // to simplify parser, add newline at the end if there is no LF.
-    // But, if it has raw CR, the file is invalid (in TOML, CR is not a valid
-    // newline char). if it ends with CR, do not add LF and report it.
-    if(cs.back() != '\n' && cs.back() != '\r')
-    {
-        cs.push_back('\n');
-    }
 
-    auto src = std::make_shared<std::vector<location::char_type>>(std::move(cs));
-
-    location loc(std::move(src), std::move(fname));
-
-    // skip BOM if found
-    if(loc.source()->size() >= 3)
+    auto res = parse_range<TC>(src, fname, begin, root_last, s);
+    if(res.is_err())
     {
-        auto first = loc.get_location();
-
-        const auto c0 = loc.current(); loc.advance();
-        const auto c1 = loc.current(); loc.advance();
-        const auto c2 = loc.current(); loc.advance();
+        return err(std::move(res.unwrap_err()));
+    }
+    index.root = std::move(res.unwrap());
+    index.root.as_table_fmt().fmt = table_format::multiline;
+    index.root.as_table_fmt().indent_type = indent_char::none;
 
-        const auto bom_found = (c0 == 0xEF) && (c1 == 0xBB) && (c2 == 0xBF);
-        if( ! bom_found)
+    for(std::size_t i=0; i<index.sections.size(); ++i)
+    {
+        auto& sec = index.sections.at(i);
+        if(index.root.as_table().count(sec.key) != 0)
         {
-            loc.set_location(first);
+            // the root has dotted keys under it, e.g. `a.b = 1` and [a.c].
+            // parse them with the rest, to merge them the same way.
+            sec.first = begin;
+        }
+        else if(is_array.at(i))
+        {
+            index.root.as_table().emplace(sec.key, value_type(array_type{}));
+        }
+        else
+        {
+            index.root.as_table().emplace(sec.key, value_type(table_type{}));
         }
     }
-
-    context<TC> ctx(s);
-
-    return parse_file(loc, ctx);
+    index.source = std::move(src);
+    index.name   = std::move(fname);
+    return ok(std::move(index));
 }
 
 } // detail
 
-// -----------------------------------------------------------------------------
-// parse(byte array)
-
-template<typename TC = type_config>
-result<basic_value<TC>, std::vector<error_info>>
-try_parse(std::vector<unsigned char> content, std::string filename,
-          spec s = spec::default_version())
+namespace detail
 {
-    return detail::parse_impl<TC>(std::move(content), std::move(filename), std::move(s));
-}
-template<typename TC = type_config>
-basic_value<TC>
-parse(std::vector<unsigned char> content, std::string filename,
-      spec s = spec::default_version())
+// reads a whole file. returns nullptr if it cannot be opened. A section index
+// parses its sections from this copy, so rewriting the file in the meantime
+// does not affect them.
+inline location::source_ptr read_file(const std::string& fname)
 {
-    auto res = try_parse<TC>(std::move(content), std::move(filename), std::move(s));
-    if(res.is_ok())
+    std::ifstream ifs(fname, std::ios_base::binary);
+    if(!ifs.good())
     {
-        return res.unwrap();
+        return nullptr;
     }
-    else
+    ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
+    auto cs = read_stream(ifs);
+    if( ! cs.empty() && cs.back() != '\n' && cs.back() != '\r')
     {
-        std::string msg;
-        for(const auto& err : res.unwrap_err())
-        {
-            msg += format_error(err);
-        }
-        throw syntax_error(std::move(msg), std::move(res.unwrap_err()));
+        cs.push_back('\n');
     }
+    return std::make_shared<const source_buffer>(
+        std::make_shared<const std::vector<location::char_type>>(std::move(cs)));
 }
-
-// -----------------------------------------------------------------------------
-// parse(istream)
+} // detail
 
 template<typename TC = type_config>
-result<basic_value<TC>, std::vector<error_info>>
-try_parse(std::istream& is, std::string fname = "unknown file", spec s = spec::default_version())
+result<section_index<TC>, std::vector<error_info>>
+try_index_sections(std::string fname, spec s = spec::default_version())
 {
-    const auto beg = is.tellg();
-    is.seekg(0, std::ios::end);
-    const auto end = is.tellg();
-    const auto fsize = end - beg;
-    is.seekg(beg);
-
-    // read whole file as a sequence of char
-    assert(fsize >= 0);
-    std::vector<detail::location::char_type> letters(static_cast<std::size_t>(fsize), '\0');
-    is.read(reinterpret_cast<char*>(letters.data()), static_cast<std::streamsize>(fsize));
-
-    return detail::parse_impl<TC>(std::move(letters), std::move(fname), std::move(s));
+    auto src = detail::read_file(fname);
+    if( ! src)
+    {
+        std::vector<error_info> e;
+        e.push_back(error_info("toml::parse: Error opening file \"" + fname + "\"", {}));
+        return err(std::move(e));
+    }
+    return detail::index_impl<TC>(std::move(src), std::move(fname), s);
 }
 
 template<typename TC = type_config>
-basic_value<TC> parse(std::istream& is, std::string fname = "unknown file", spec s = spec::default_version())
+section_index<TC> index_sections(std::string fname, spec s = spec::default_version())
 {
-    auto res = try_parse<TC>(is, std::move(fname), std::move(s));
+    auto src = detail::read_file(fname);
+    if( ! src)
+    {
+        throw file_io_error("toml::parse: error opening file", fname);
+    }
+    auto res = detail::index_impl<TC>(std::move(src), std::move(fname), s);
     if(res.is_ok())
     {
         return res.unwrap();
     }
-    else
+    std::string msg;
+    for(const auto& err : res.unwrap_err())
     {
-        std::string msg;
-        for(const auto& err : res.unwrap_err())
-        {
-            msg += format_error(err);
-        }
-        throw syntax_error(std::move(msg), std::move(res.unwrap_err()));
+        msg += format_error(err);
     }
+    throw syntax_error(std::move(msg), std::move(res.unwrap_err()));
 }
 
-// -----------------------------------------------------------------------------
-// parse(filename)
-
 template<typename TC = type_config>
 result<basic_value<TC>, std::vector<error_info>>
-try_parse(std::string fname, spec s = spec::default_version())
+try_parse_section(const section_index<TC>& index,
+                  const typename section_index<TC>::section& sec)
 {
-    std::ifstream ifs(fname, std::ios_base::binary);
-    if(!ifs.good())
+    using key_type = typename section_index<TC>::key_type;
+
+    std::vector<std::vector<key_type>> selected(1, std::vector<key_type>(1, sec.key));
+    auto res = detail::parse_range<TC>(index.source, index.name, sec.first, sec.last,
+                                       index.toml_spec, std::move(selected));
+    if(res.is_err())
     {
-        std::vector<error_info> e;
-        e.push_back(error_info("toml::parse: Error opening file \"" + fname + "\"", {}));
-        return err(std::move(e));
+        return err(std::move(res.unwrap_err()));
     }
-    ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-
-    return try_parse<TC>(ifs, std::move(fname), std::move(s));
+    return ok(std::move(res.unwrap().as_table().at(sec.key)));
 }
 
 template<typename TC = type_config>
-basic_value<TC> parse(std::string fname, spec s = spec::default_version())
+basic_value<TC> parse_section(const section_index<TC>& index,
+                              const typename section_index<TC>::section& sec)
 {
-    std::ifstream ifs(fname, std::ios_base::binary);
-    if(!ifs.good())
+    auto res = try_parse_section<TC>(index, sec);
+    if(res.is_ok())
     {
-        throw file_io_error("toml::parse: error opening file", fname);
+        return res.unwrap();
     }
-    ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-
-    return parse<TC>(ifs, std::move(fname), std::move(s));
-}
-
-template<typename TC = type_config, std::size_t N>
-result<basic_value<TC>, std::vector<error_info>>
-try_parse(const char (&fname)[N], spec s = spec::default_version())
-{
-    return try_parse<TC>(std::string(fname), std::move(s));
-}
-
-template<typename TC = type_config, std::size_t N>
-basic_value<TC> parse(const char (&fname)[N], spec s = spec::default_version())
-{
-    return parse<TC>(std::string(fname), std::move(s));
+    std::string msg;
+    for(const auto& err : res.unwrap_err())
+    {
+        msg += format_error(err);
+    }
+    throw syntax_error(std::move(msg), std::move(res.unwrap_err()));
 }
 
 // ----------------------------------------------------------------------------
@@ -15818,12 +18066,12 @@ TOML11_INLINE ::toml::value literal_internal_impl(location loc)
     // "1 = [{}]"_toml;  // json: {"1": [{}]}
     // "[[1,]]"_toml;    // json: [[1]]
     // "[[1],]"_toml;    // json: [[1]]
-    const auto val_start = loc;
+    const auto val_start = loc.get_location();
 
-    const bool is_table_key = syntax::std_table(s).scan(loc).is_ok();
-    loc = val_start;
-    const bool is_aots_key  = syntax::array_table(s).scan(loc).is_ok();
-    loc = val_start;
+    const bool is_table_key = ctx.syntax().std_table(loc);
+    loc.set_location(val_start);
+    const bool is_aots_key  = ctx.syntax().array_table(loc);
+    loc.set_location(val_start);
 
     // If it is neither a table-key or a array-of-table-key, it may be a value.
     if(!is_table_key && !is_aots_key)
@@ -15978,6 +18226,97 @@ struct serialization_error final : public ::toml::exception
 
 namespace detail
 {
+
+// formats a finite floating point value through iostream. It is used if
+// std::to_chars is not available. If `prec == 0`, the default is used.
+template<typename T>
+std::string format_float_stream(const T f, const floating_format fmt, const std::size_t prec)
+{
+    std::ostringstream oss;
+    oss.imbue(std::locale::classic());
+    if(prec != 0)
+    {
+        oss << std::setprecision(static_cast<int>(prec));
+    }
+    switch(fmt)
+    {
+        case floating_format::fixed     : { oss << std::fixed      << f; break; }
+        case floating_format::scientific: { oss << std::scientific << f; break; }
+        case floating_format::hex       : { oss << std::hexfloat   << f; break; }
+        default                         : { oss                    << f; break; }
+    }
+    return oss.str();
+}
+
+// formats a finite floating point value. If `prec == 0`, defaultfloat gives
+// the shortest representation that round-trips, and fixed and scientific use
+// 6 digits as iostream does. hex ignores `prec`.
+#if defined(TOML11_HAS_FLOAT_CHARCONV)
+template<typename T>
+cxx::enable_if_t<std::is_floating_point<T>::value, std::string>
+format_float(const T f, const floating_format fmt, const std::size_t prec)
+{
+    const auto p = static_cast<int>(prec == 0 ? 6 : prec);
+
+    std::string buf(32, '\0');
+    while(true)
+    {
+        char* first = &buf[0];
+        char* last  = first + buf.size();
+
+        std::to_chars_result res;
+        switch(fmt)
+        {
+            case floating_format::fixed:
+            {
+                res = std::to_chars(first, last, f, std::chars_format::fixed, p);
+                break;
+            }
+            case floating_format::scientific:
+            {
+                res = std::to_chars(first, last, f, std::chars_format::scientific, p);
+                break;
+            }
+            case floating_format::hex:
+            {
+                res = std::to_chars(first, last, f, std::chars_format::hex);
+                break;
+            }
+            default:
+            {
+                res = (prec == 0) ? std::to_chars(first, last, f) :
+                    std::to_chars(first, last, f, std::chars_format::general, p);
+                break;
+            }
+        }
+        if(res.ec == std::errc{})
+        {
+            buf.resize(static_cast<std::size_t>(res.ptr - first));
+            break;
+        }
+        buf.resize(buf.size() * 2); // e.g. 1e300 in fixed format
+    }
+
+    if(fmt == floating_format::hex) // std::to_chars omits the prefix
+    {
+        buf.insert(std::signbit(f) ? 1 : 0, "0x");
+    }
+    return buf;
+}
+template<typename T>
+cxx::enable_if_t<cxx::negation<std::is_floating_point<T>>::value, std::string>
+format_float(const T f, const floating_format fmt, const std::size_t prec)
+{
+    return format_float_stream(f, fmt, prec);
+}
+#else
+template<typename T>
+std::string format_float(const T f, const floating_format fmt, const std::size_t prec)
+{
+    return format_float_stream(f, fmt, prec);
+}
+#endif
+
 template<typename TC>
 class serializer
 {
@@ -16003,7 +18342,7 @@ class serializer
   public:
 
     explicit serializer(const spec& sp)
-        : spec_(sp), force_inline_(false), current_indent_(0)
+        : spec_(sp), syntax_(sp), force_inline_(false), current_indent_(0)
     {}
 
     string_type operator()(const std::vector<key_type>& ks, const value_type& v)
@@ -16092,8 +18431,9 @@ class serializer
         const auto insert_spacer = [&fmt](std::string s) -> std::string {
             if(fmt.spacer == 0) {return s;}
 
+            // keep the padding of setw, if any, with the sign.
             std::string sign;
-            if( ! s.empty() && (s.at(0) == '+' || s.at(0) == '-'))
+            while( ! s.empty() && (s.at(0) == ' ' || s.at(0) == '+' || s.at(0) == '-'))
             {
                 sign += s.at(0);
                 s.erase(s.begin());
@@ -16209,114 +18549,72 @@ class serializer
         using std::isinf;
         using std::signbit;
 
-        std::ostringstream oss;
-        this->set_locale(oss);
-
-        if(isnan(f))
-        {
-            if(signbit(f))
-            {
-                oss << '-';
-            }
-            oss << "nan";
-            if(this->spec_.ext_num_suffix && ! fmt.suffix.empty())
-            {
-                oss << '_';
-                oss << fmt.suffix;
-            }
-            return string_conv<string_type>(oss.str());
-        }
-
-        if(isinf(f))
+        std::string s;
+        if(isnan(f) || isinf(f))
         {
             if(signbit(f))
             {
-                oss << '-';
+                s += '-';
             }
-            oss << "inf";
+            s += isnan(f) ? "nan" : "inf";
             if(this->spec_.ext_num_suffix && ! fmt.suffix.empty())
             {
-                oss << '_';
-                oss << fmt.suffix;
+                s += '_';
+                s += fmt.suffix;
             }
-            return string_conv<string_type>(oss.str());
+            return string_conv<string_type>(s);
         }
 
         switch(fmt.fmt)
         {
             case floating_format::defaultfloat:
             {
-                if(fmt.prec != 0)
-                {
-                    oss << std::setprecision(static_cast<int>(fmt.prec));
-                }
-                oss << f;
+                s = format_float(f, floating_format::defaultfloat, fmt.prec);
                 // since defaultfloat may omit point, we need to add it
-                std::string s = oss.str();
                 if (s.find('.') == std::string::npos &&
                     s.find('e') == std::string::npos &&
                     s.find('E') == std::string::npos )
                 {
                     s += ".0";
                 }
-                if(this->spec_.ext_num_suffix && ! fmt.suffix.empty())
-                {
-                    s += '_';
-                    s += fmt.suffix;
-                }
-                return string_conv<string_type>(s);
+                break;
             }
             case floating_format::fixed:
             {
-                if(fmt.prec != 0)
-                {
-                    oss << std::setprecision(static_cast<int>(fmt.prec));
-                }
-                oss << std::fixed << f;
-                if(this->spec_.ext_num_suffix && ! fmt.suffix.empty())
-                {
-                    oss << '_' << fmt.suffix;
-                }
-                return string_conv<string_type>(oss.str());
+                s = format_float(f, floating_format::fixed, fmt.prec);
+                break;
             }
             case floating_format::scientific:
             {
-                if(fmt.prec != 0)
-                {
-                    oss << std::setprecision(static_cast<int>(fmt.prec));
-                }
-                oss << std::scientific << f;
-                if(this->spec_.ext_num_suffix && ! fmt.suffix.empty())
-                {
-                    oss << '_' << fmt.suffix;
-                }
-                return string_conv<string_type>(oss.str());
+                s = format_float(f, floating_format::scientific, fmt.prec);
+                break;
             }
             case floating_format::hex:
             {
+                // suffix is only for decimal numbers.
                 if(this->spec_.ext_hex_float)
                 {
-                    oss << std::hexfloat << f;
-                    // suffix is only for decimal numbers.
-                    return string_conv<string_type>(oss.str());
+                    return string_conv<string_type>(
+                        format_float(f, floating_format::hex, 0));
                 }
                 else // no hex allowed. output with max precision.
                 {
-                    oss << std::setprecision(std::numeric_limits<floating_type>::max_digits10)
-                        << std::scientific << f;
-                    // suffix is only for decimal numbers.
-                    return string_conv<string_type>(oss.str());
+                    return string_conv<string_type>(format_float(f,
+                        floating_format::scientific,
+                        std::numeric_limits<floating_type>::max_digits10));
                 }
             }
             default:
             {
-                if(this->spec_.ext_num_suffix && ! fmt.suffix.empty())
-                {
-                    oss << '_' << fmt.suffix;
-                }
-                return string_conv<string_type>(oss.str());
+                break;
             }
         }
+        if(this->spec_.ext_num_suffix && ! fmt.suffix.empty())
+        {
+            s += '_';
+            s += fmt.suffix;
+        }
+        return string_conv<string_type>(s);
     } // }}}
 
     string_type operator()(string_type s, const string_format_info& fmt, const source_location& loc) // {{{
@@ -16690,7 +18988,61 @@ class serializer
 
   private:
 
-    string_type escape_basic_string(const string_type& s) const // {{{
+    string_type escape_basic_string(const string_type& s) const // {{{
+    {
+        string_type retval;
+        for(const char_type c : s)
+        {
+            switch(c)
+            {
+                case char_type('\\'): {retval += string_conv<string_type>("\\\\"); break;}
+                case char_type('\"'): {retval += string_conv<string_type>("\\\""); break;}
+                case char_type('\b'): {retval += string_conv<string_type>("\\b" ); break;}
+                case char_type('\t'): {retval += string_conv<string_type>("\\t" ); break;}
+                case char_type('\f'): {retval += string_conv<string_type>("\\f" ); break;}
+                case char_type('\n'): {retval += string_conv<string_type>("\\n" ); break;}
+                case char_type('\r'): {retval += string_conv<string_type>("\\r" ); break;}
+                default  :
+                {
+                    if(c == char_type(0x1B) && spec_.v1_1_0_add_escape_sequence_e)
+                    {
+                        retval += string_conv<string_type>("\\e");
+                    }
+                    else if((char_type(0x00) <= c && c <= char_type(0x08)) ||
+                            (char_type(0x0A) <= c && c <= char_type(0x1F)) ||
+                             c == char_type(0x7F))
+                    {
+                        if(spec_.v1_1_0_add_escape_sequence_x)
+                        {
+                            retval += string_conv<string_type>("\\x");
+                        }
+                        else
+                        {
+                            retval += string_conv<string_type>("\\u00");
+                        }
+                        const auto c1 = c / 16;
+                        const auto c2 = c % 16;
+                        retval += static_cast<char_type>('0' + c1);
+                        if(c2 < 10)
+                        {
+                            retval += static_cast<char_type>('0' + c2);
+                        }
+                        else // 10 <= c2
+                        {
+                            retval += static_cast<char_type>('A' + (c2 - 10));
+                        }
+                    }
+                    else
+                    {
+                        retval += c;
+                    }
+                }
+            }
+        }
+        return retval;
+    } // }}}
+
+    string_type escape_ml_basic_string(const string_type& s) // {{{
     {
         string_type retval;
         for(const char_type c : s)
@@ -16698,11 +19050,10 @@ class serializer
             switch(c)
             {
                 case char_type('\\'): {retval += string_conv<string_type>("\\\\"); break;}
-                case char_type('\"'): {retval += string_conv<string_type>("\\\""); break;}
                 case char_type('\b'): {retval += string_conv<string_type>("\\b" ); break;}
                 case char_type('\t'): {retval += string_conv<string_type>("\\t" ); break;}
                 case char_type('\f'): {retval += string_conv<string_type>("\\f" ); break;}
-                case char_type('\n'): {retval += string_conv<string_type>("\\n" ); break;}
+                case char_type('\n'): {retval += string_conv<string_type>("\n"  ); break;}
                 case char_type('\r'): {retval += string_conv<string_type>("\\r" ); break;}
                 default  :
                 {
@@ -16712,7 +19063,7 @@ class serializer
                     }
                     else if((char_type(0x00) <= c && c <= char_type(0x08)) ||
                             (char_type(0x0A) <= c && c <= char_type(0x1F)) ||
-                             c == char_type(0x7F))
+                            c == char_type(0x7F))
                     {
                         if(spec_.v1_1_0_add_escape_sequence_x)
                         {
@@ -16741,477 +19092,1246 @@ class serializer
                 }
             }
         }
+        // Only 1 or 2 consecutive `"`s are allowed in multiline basic string.
+        // 3 consecutive `"`s are considered as a closing delimiter.
+        // We need to check if there are 3 or more consecutive `"`s and insert
+        // backslash to break them down into several short `"`s like the `str6`
+        // in the following example.
+        // ```toml
+        // str4 = """Here are two quotation marks: "". Simple enough."""
+        // # str5 = """Here are three quotation marks: """."""  # INVALID
+        // str5 = """Here are three quotation marks: ""\"."""
+        // str6 = """Here are fifteen quotation marks: ""\"""\"""\"""\"""\"."""
+        // ```
+        auto found_3_quotes = retval.find(string_conv<string_type>("\"\"\""));
+        while(found_3_quotes != string_type::npos)
+        {
+            retval.replace(found_3_quotes, 3, string_conv<string_type>("\"\"\\\""));
+            found_3_quotes = retval.find(string_conv<string_type>("\"\"\""));
+        }
         return retval;
     } // }}}
 
-    string_type escape_ml_basic_string(const string_type& s) // {{{
+    string_type format_local_time(const local_time_type& t, const bool has_seconds, const std::size_t subsec_prec) // {{{
+    {
+        std::ostringstream oss;
+        oss << std::setfill('0') << std::setw(2) << static_cast<int>(t.hour);
+        oss << ':';
+        oss << std::setfill('0') << std::setw(2) << static_cast<int>(t.minute);
+        if(has_seconds)
+        {
+            oss << ':';
+            oss << std::setfill('0') << std::setw(2) << static_cast<int>(t.second);
+            if(subsec_prec != 0)
+            {
+                std::ostringstream subsec;
+                subsec << std::setfill('0') << std::setw(3) << static_cast<int>(t.millisecond);
+                subsec << std::setfill('0') << std::setw(3) << static_cast<int>(t.microsecond);
+                subsec << std::setfill('0') << std::setw(3) << static_cast<int>(t.nanosecond);
+                std::string subsec_str = subsec.str();
+                oss << '.' << subsec_str.substr(0, subsec_prec);
+            }
+        }
+        return string_conv<string_type>(oss.str());
+    } // }}}
+
+    string_type format_ml_table(const table_type& t, const table_format_info& fmt) // {{{
+    {
+        const auto format_later = [](const value_type& v) -> bool {
+
+            const bool is_ml_table = v.is_table() &&
+                v.as_table_fmt().fmt != table_format::oneline           &&
+                v.as_table_fmt().fmt != table_format::multiline_oneline &&
+                v.as_table_fmt().fmt != table_format::dotted ;
+
+            const bool is_ml_array_table = v.is_array_of_tables() &&
+                v.as_array_fmt().fmt != array_format::oneline &&
+                v.as_array_fmt().fmt != array_format::multiline;
+
+            return is_ml_table || is_ml_array_table;
+        };
+
+        string_type retval;
+        this->current_indent_ += fmt.body_indent;
+        for(const auto& kv : t)
+        {
+            const auto& key = kv.first;
+            const auto& val = kv.second;
+            if(format_later(val))
+            {
+                continue;
+            }
+            this->keys_.push_back(key);
+
+            retval += format_comments(val.comments(), fmt.indent_type);
+            retval += format_indent(fmt.indent_type);
+            if(val.is_table() && val.as_table_fmt().fmt == table_format::dotted)
+            {
+                retval += (*this)(val);
+            }
+            else
+            {
+                retval += format_key(key);
+                retval += string_conv<string_type>(" = ");
+                retval += (*this)(val);
+                retval += char_type('\n');
+            }
+            this->keys_.pop_back();
+        }
+        this->current_indent_ -= fmt.body_indent;
+
+        if( ! retval.empty())
+        {
+            retval += char_type('\n'); // for readability, add empty line between tables
+        }
+        for(const auto& kv : t)
+        {
+            if( ! format_later(kv.second))
+            {
+                continue;
+            }
+            // must be a [multiline.table] or [[multiline.array.of.tables]].
+            // comments will be generated inside it.
+            this->keys_.push_back(kv.first);
+            retval += (*this)(kv.second);
+            this->keys_.pop_back();
+        }
+        return retval;
+    } // }}}
+
+    string_type format_inline_table(const table_type& t, const table_format_info&) // {{{
     {
+        // comments are ignored because we cannot write without newline
         string_type retval;
-        for(const char_type c : s)
+        retval += char_type('{');
+        for(const auto& kv : t)
+        {
+            this->force_inline_ = true;
+            retval += this->format_key(kv.first);
+            retval += string_conv<string_type>(" = ");
+            retval += (*this)(kv.second);
+            retval += string_conv<string_type>(", ");
+        }
+        if( ! t.empty())
+        {
+            retval.pop_back(); // ' '
+            retval.pop_back(); // ','
+        }
+        retval += char_type('}');
+        this->force_inline_ = false;
+        return retval;
+    } // }}}
+
+    string_type format_ml_inline_table(const table_type& t, const table_format_info& fmt) // {{{
+    {
+        string_type retval;
+        retval += string_conv<string_type>("{\n");
+        this->current_indent_ += fmt.body_indent;
+        for(const auto& kv : t)
+        {
+            this->force_inline_ = true;
+            retval += format_comments(kv.second.comments(), fmt.indent_type);
+            retval += format_indent(fmt.indent_type);
+            retval += this->format_key(kv.first);
+            retval += string_conv<string_type>(" = ");
+
+            this->force_inline_ = true;
+            retval += (*this)(kv.second);
+
+            retval += string_conv<string_type>(",\n");
+        }
+        if( ! t.empty())
+        {
+            retval.pop_back(); // '\n'
+            retval.pop_back(); // ','
+        }
+        this->current_indent_ -= fmt.body_indent;
+        this->force_inline_ = false;
+
+        this->current_indent_ += fmt.closing_indent;
+        retval += format_indent(fmt.indent_type);
+        this->current_indent_ -= fmt.closing_indent;
+
+        retval += char_type('}');
+        return retval;
+    } // }}}
+
+    string_type format_dotted_table(const table_type& t, const table_format_info& fmt, // {{{
+            const source_location&, std::vector<string_type>& keys)
+    {
+        // lets say we have: `{"a": {"b": {"c": {"d": "foo", "e": "bar"} } }`
+        // and `a` and `b` are `dotted`.
+        //
+        // - in case if `c` is `oneline`:
+        // ```toml
+        // a.b.c = {d = "foo", e = "bar"}
+        // ```
+        //
+        // - in case if and `c` is `dotted`:
+        // ```toml
+        // a.b.c.d = "foo"
+        // a.b.c.e = "bar"
+        // ```
+
+        string_type retval;
+
+        for(const auto& kv : t)
+        {
+            const auto& key = kv.first;
+            const auto& val = kv.second;
+
+            keys.push_back(key);
+
+            // format recursive dotted table?
+            if (val.is_table() &&
+                val.as_table_fmt().fmt != table_format::oneline &&
+                val.as_table_fmt().fmt != table_format::multiline_oneline)
+            {
+                retval += this->format_dotted_table(val.as_table(), val.as_table_fmt(), val.location(), keys);
+            }
+            else // non-table or inline tables. format normally
+            {
+                retval += format_comments(val.comments(), fmt.indent_type);
+                retval += format_indent(fmt.indent_type);
+                retval += format_keys(keys).value();
+                retval += string_conv<string_type>(" = ");
+                this->force_inline_ = true; // sub-table must be inlined
+                retval += (*this)(val);
+                retval += char_type('\n');
+                this->force_inline_ = false;
+            }
+            keys.pop_back();
+        }
+        return retval;
+    } // }}}
+
+    string_type format_key(const key_type& key) // {{{
+    {
+        if(key.empty())
+        {
+            return string_conv<string_type>("\"\"");
+        }
+
+        // check the key can be a bare (unquoted) key
+        auto loc = detail::make_temporary_location(string_conv<std::string>(key));
+        if(this->syntax_.unquoted_key(loc) && loc.eof())
+        {
+            return key;
+        }
+
+        //if it includes special characters, then format it in a "quoted" key.
+        string_type formatted = string_conv<string_type>("\"");
+        for(const char_type c : key)
         {
             switch(c)
             {
-                case char_type('\\'): {retval += string_conv<string_type>("\\\\"); break;}
-                case char_type('\b'): {retval += string_conv<string_type>("\\b" ); break;}
-                case char_type('\t'): {retval += string_conv<string_type>("\\t" ); break;}
-                case char_type('\f'): {retval += string_conv<string_type>("\\f" ); break;}
-                case char_type('\n'): {retval += string_conv<string_type>("\n"  ); break;}
-                case char_type('\r'): {retval += string_conv<string_type>("\\r" ); break;}
-                default  :
-                {
-                    if(c == char_type(0x1B) && spec_.v1_1_0_add_escape_sequence_e)
-                    {
-                        retval += string_conv<string_type>("\\e");
-                    }
-                    else if((char_type(0x00) <= c && c <= char_type(0x08)) ||
-                            (char_type(0x0A) <= c && c <= char_type(0x1F)) ||
-                            c == char_type(0x7F))
+                case char_type('\\'): {formatted += string_conv<string_type>("\\\\"); break;}
+                case char_type('\"'): {formatted += string_conv<string_type>("\\\""); break;}
+                case char_type('\b'): {formatted += string_conv<string_type>("\\b" ); break;}
+                case char_type('\t'): {formatted += string_conv<string_type>("\\t" ); break;}
+                case char_type('\f'): {formatted += string_conv<string_type>("\\f" ); break;}
+                case char_type('\n'): {formatted += string_conv<string_type>("\\n" ); break;}
+                case char_type('\r'): {formatted += string_conv<string_type>("\\r" ); break;}
+                default  :
+                {
+                    // ASCII ctrl char
+                    if( (char_type(0x00) <= c && c <= char_type(0x08)) ||
+                        (char_type(0x0A) <= c && c <= char_type(0x1F)) ||
+                        c == char_type(0x7F))
                     {
                         if(spec_.v1_1_0_add_escape_sequence_x)
                         {
-                            retval += string_conv<string_type>("\\x");
+                            formatted += string_conv<string_type>("\\x");
                         }
                         else
                         {
-                            retval += string_conv<string_type>("\\u00");
+                            formatted += string_conv<string_type>("\\u00");
                         }
                         const auto c1 = c / 16;
                         const auto c2 = c % 16;
-                        retval += static_cast<char_type>('0' + c1);
+                        formatted += static_cast<char_type>('0' + c1);
                         if(c2 < 10)
                         {
-                            retval += static_cast<char_type>('0' + c2);
+                            formatted += static_cast<char_type>('0' + c2);
                         }
                         else // 10 <= c2
                         {
-                            retval += static_cast<char_type>('A' + (c2 - 10));
+                            formatted += static_cast<char_type>('A' + (c2 - 10));
                         }
                     }
                     else
                     {
-                        retval += c;
+                        formatted += c;
                     }
+                    break;
                 }
             }
         }
-        // Only 1 or 2 consecutive `"`s are allowed in multiline basic string.
-        // 3 consecutive `"`s are considered as a closing delimiter.
-        // We need to check if there are 3 or more consecutive `"`s and insert
-        // backslash to break them down into several short `"`s like the `str6`
-        // in the following example.
-        // ```toml
-        // str4 = """Here are two quotation marks: "". Simple enough."""
-        // # str5 = """Here are three quotation marks: """."""  # INVALID
-        // str5 = """Here are three quotation marks: ""\"."""
-        // str6 = """Here are fifteen quotation marks: ""\"""\"""\"""\"""\"."""
-        // ```
-        auto found_3_quotes = retval.find(string_conv<string_type>("\"\"\""));
-        while(found_3_quotes != string_type::npos)
+        formatted += string_conv<string_type>("\"");
+        return formatted;
+    } // }}}
+    cxx::optional<string_type> format_keys(const std::vector<key_type>& keys) // {{{
+    {
+        if(keys.empty())
         {
-            retval.replace(found_3_quotes, 3, string_conv<string_type>("\"\"\\\""));
-            found_3_quotes = retval.find(string_conv<string_type>("\"\"\""));
+            return cxx::make_nullopt();
+        }
+
+        string_type formatted;
+        for(const auto& ky : keys)
+        {
+            formatted += format_key(ky);
+            formatted += char_type('.');
+        }
+        formatted.pop_back(); // remove the last dot '.'
+        return formatted;
+    } // }}}
+
+    string_type format_comments(const discard_comments&, const indent_char) const // {{{
+    {
+        return string_conv<string_type>("");
+    } // }}}
+    string_type format_comments(const preserve_comments& comments, const indent_char indent_type) const // {{{
+    {
+        string_type retval;
+        for(const auto& c : comments)
+        {
+            if(c.empty()) {continue;}
+            retval += format_indent(indent_type);
+            if(c.front() != '#') {retval += char_type('#');}
+            retval += string_conv<string_type>(c);
+            if(c.back() != '\n') {retval += char_type('\n');}
         }
         return retval;
     } // }}}
 
-    string_type format_local_time(const local_time_type& t, const bool has_seconds, const std::size_t subsec_prec) // {{{
+    string_type format_indent(const indent_char indent_type) const // {{{
     {
-        std::ostringstream oss;
-        oss << std::setfill('0') << std::setw(2) << static_cast<int>(t.hour);
-        oss << ':';
-        oss << std::setfill('0') << std::setw(2) << static_cast<int>(t.minute);
-        if(has_seconds)
+        const auto indent = static_cast<std::size_t>((std::max)(0, this->current_indent_));
+        if(indent_type == indent_char::space)
         {
-            oss << ':';
-            oss << std::setfill('0') << std::setw(2) << static_cast<int>(t.second);
-            if(subsec_prec != 0)
+            return string_conv<string_type>(make_string(indent, ' '));
+        }
+        else if(indent_type == indent_char::tab)
+        {
+            return string_conv<string_type>(make_string(indent, '\t'));
+        }
+        else
+        {
+            return string_type{};
+        }
+    } // }}}
+
+    std::locale set_locale(std::ostream& os) const
+    {
+        return os.imbue(std::locale::classic());
+    }
+
+  private:
+
+    spec spec_;
+    spec_syntax syntax_;
+    bool force_inline_; // table inside an array without fmt specification
+    std::int32_t current_indent_;
+    std::vector<key_type> keys_;
+};
+} // detail
+
+template<typename TC>
+typename basic_value<TC>::string_type
+format(const basic_value<TC>& v, const spec s = spec::default_version())
+{
+    detail::serializer<TC> ser(s);
+    return ser(v);
+}
+template<typename TC>
+typename basic_value<TC>::string_type
+format(const typename basic_value<TC>::key_type& k,
+       const basic_value<TC>& v,
+       const spec s = spec::default_version())
+{
+    detail::serializer<TC> ser(s);
+    return ser(k, v);
+}
+template<typename TC>
+typename basic_value<TC>::string_type
+format(const std::vector<typename basic_value<TC>::key_type>& ks,
+       const basic_value<TC>& v,
+       const spec s = spec::default_version())
+{
+    detail::serializer<TC> ser(s);
+    return ser(ks, v);
+}
+
+template<typename TC>
+std::ostream& operator<<(std::ostream& os, const basic_value<TC>& v)
+{
+    os << format(v);
+    return os;
+}
+
+} // toml
+
+#if defined(TOML11_COMPILE_SOURCES)
+namespace toml
+{
+struct type_config;
+struct ordered_type_config;
+
+extern template typename basic_value<type_config>::string_type
+format<type_config>(const basic_value<type_config>&, const spec);
+
+extern template typename basic_value<type_config>::string_type
+format<type_config>(const typename basic_value<type_config>::key_type& k,
+                    const basic_value<type_config>& v, const spec);
+
+extern template typename basic_value<type_config>::string_type
+format<type_config>(const std::vector<typename basic_value<type_config>::key_type>& ks,
+                    const basic_value<type_config>& v, const spec s);
+
+extern template typename basic_value<type_config>::string_type
+format<ordered_type_config>(const basic_value<ordered_type_config>&, const spec);
+
+extern template typename basic_value<type_config>::string_type
+format<ordered_type_config>(const typename basic_value<ordered_type_config>::key_type& k,
+                            const basic_value<ordered_type_config>& v, const spec);
+
+extern template typename basic_value<type_config>::string_type
+format<ordered_type_config>(const std::vector<typename basic_value<ordered_type_config>::key_type>& ks,
+                            const basic_value<ordered_type_config>& v, const spec s);
+
+namespace detail
+{
+extern template class serializer<::toml::type_config>;
+extern template class serializer<::toml::ordered_type_config>;
+} // detail
+} // toml
+#endif // TOML11_COMPILE_SOURCES
+
+
+#endif // TOML11_SERIALIZER_HPP
+#ifndef TOML11_BINARY_HPP
+#define TOML11_BINARY_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace toml
+{
+
+// ----------------------------------------------------------------------------
+// binary encoding
+//
+// A compact snapshot of a basic_value that keeps everything `format` needs to
+// reproduce the original text: values, key order, comments and format_info.
+//
+//   document := magic("T11B") version(u8) value
+//   value    := type(u8) comments format payload
+//   comments := count(varint) string*
+//   string   := size(varint) bytes
+//
+// Sizes and unsigned fields are LEB128 varints, signed ones are zigzag
+// varints, and floating point values are the 8 bytes of their IEEE 754
+// binary64 representation in little endian. `format` and `payload` depend on
+// the type and follow the member order of the *_format_info structs and the
+// datetime structs. Arrays store their elements, tables store key-value pairs.
+// The version is bumped whenever the layout changes; a decoder rejects any
+// version other than its own.
+
+struct binary_format_error final : public ::toml::exception
+{
+  public:
+    explicit binary_format_error(std::string what_arg)
+        : what_(std::move(what_arg))
+    {}
+    ~binary_format_error() noexcept override = default;
+
+    const char* what() const noexcept override {return what_.c_str();}
+
+  private:
+    std::string what_;
+};
+
+namespace detail
+{
+
+constexpr std::uint8_t binary_format_version = 1;
+
+// the decoder recurses once per nested table or array.
+constexpr std::size_t binary_max_depth = 256;
+
+inline bool is_binary_magic(const unsigned char* p) noexcept
+{
+    return p[0] == 'T' && p[1] == '1' && p[2] == '1' && p[3] == 'B';
+}
+
+class binary_writer
+{
+  public:
+
+    explicit binary_writer(std::vector<unsigned char>& buf): buf_(buf) {}
+
+    void byte(const std::uint8_t b) {buf_.push_back(b);}
+    void flag(const bool b) {buf_.push_back(b ? 1 : 0);}
+
+    void varint(std::uint64_t x)
+    {
+        while(0x80 <= x)
+        {
+            buf_.push_back(static_cast<unsigned char>((x & 0x7F) | 0x80));
+            x >>= 7;
+        }
+        buf_.push_back(static_cast<unsigned char>(x));
+    }
+    void zigzag(const std::int64_t x)
+    {
+        const auto u = static_cast<std::uint64_t>(x);
+        this->varint(x < 0 ? ~(u << 1) : (u << 1));
+    }
+    void binary64(const double x)
+    {
+        std::uint64_t u = 0;
+        std::memcpy(std::addressof(u), std::addressof(x), sizeof(u));
+        for(std::size_t i=0; i<8; ++i)
+        {
+            buf_.push_back(static_cast<unsigned char>((u >> (i * 8)) & 0xFF));
+        }
+    }
+    template<typename S>
+    void string(const S& s)
+    {
+        this->varint(s.size());
+        buf_.insert(buf_.end(), s.begin(), s.end());
+    }
+
+  private:
+    std::vector<unsigned char>& buf_;
+};
+
+class binary_reader
+{
+  public:
+
+    binary_reader(const unsigned char* first, const unsigned char* last) noexcept
+        : iter_(first), last_(last)
+    {}
+
+    std::uint8_t byte()
+    {
+        this->require(1);
+        return *iter_++;
+    }
+    bool flag()
+    {
+        const auto b = this->byte();
+        if(1 < b)
+        {
+            this->fail("invalid boolean");
+        }
+        return b == 1;
+    }
+    template<typename E>
+    E enumeration(const E max)
+    {
+        const auto b = this->byte();
+        if(static_cast<std::uint8_t>(max) < b)
+        {
+            this->fail("invalid format");
+        }
+        return static_cast<E>(b);
+    }
+
+    std::uint64_t varint()
+    {
+        std::uint64_t x = 0;
+        for(unsigned int shift=0; shift<64; shift+=7)
+        {
+            const auto b = this->byte();
+            x |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if((b & 0x80) == 0)
             {
-                std::ostringstream subsec;
-                subsec << std::setfill('0') << std::setw(3) << static_cast<int>(t.millisecond);
-                subsec << std::setfill('0') << std::setw(3) << static_cast<int>(t.microsecond);
-                subsec << std::setfill('0') << std::setw(3) << static_cast<int>(t.nanosecond);
-                std::string subsec_str = subsec.str();
-                oss << '.' << subsec_str.substr(0, subsec_prec);
+                return x;
             }
         }
-        return string_conv<string_type>(oss.str());
-    } // }}}
+        this->fail("varint too long");
+    }
+    std::int64_t zigzag()
+    {
+        const auto u = this->varint();
+        return static_cast<std::int64_t>((u & 1) ? ~(u >> 1) : (u >> 1));
+    }
+    double binary64()
+    {
+        this->require(8);
+        std::uint64_t u = 0;
+        for(std::size_t i=0; i<8; ++i)
+        {
+            u |= static_cast<std::uint64_t>(*iter_++) << (i * 8);
+        }
+        double x = 0.0;
+        std::memcpy(std::addressof(x), std::addressof(u), sizeof(x));
+        return x;
+    }
 
-    string_type format_ml_table(const table_type& t, const table_format_info& fmt) // {{{
+    // the number of elements that follow. each takes at least one byte, so a
+    // count larger than the rest of the input is rejected before allocating.
+    std::size_t count()
     {
-        const auto format_later = [](const value_type& v) -> bool {
+        const auto n = this->varint();
+        if(static_cast<std::uint64_t>(last_ - iter_) < n)
+        {
+            this->fail("unexpected end of input");
+        }
+        return static_cast<std::size_t>(n);
+    }
+    template<typename S>
+    S string()
+    {
+        const auto n = this->count();
+        const char* first = reinterpret_cast<const char*>(iter_);
+        iter_ += n;
+        return S(first, n);
+    }
 
-            const bool is_ml_table = v.is_table() &&
-                v.as_table_fmt().fmt != table_format::oneline           &&
-                v.as_table_fmt().fmt != table_format::multiline_oneline &&
-                v.as_table_fmt().fmt != table_format::dotted ;
+    bool eof() const noexcept {return iter_ == last_;}
 
-            const bool is_ml_array_table = v.is_array_of_tables() &&
-                v.as_array_fmt().fmt != array_format::oneline &&
-                v.as_array_fmt().fmt != array_format::multiline;
+    [[noreturn]] void fail(const std::string& msg) const
+    {
+        throw binary_format_error("toml::decode_binary: " + msg);
+    }
 
-            return is_ml_table || is_ml_array_table;
-        };
+  private:
 
-        string_type retval;
-        this->current_indent_ += fmt.body_indent;
-        for(const auto& kv : t)
+    void require(const std::size_t n) const
+    {
+        if(static_cast<std::size_t>(last_ - iter_) < n)
         {
-            const auto& key = kv.first;
-            const auto& val = kv.second;
-            if(format_later(val))
-            {
-                continue;
-            }
-            this->keys_.push_back(key);
+            this->fail("unexpected end of input");
+        }
+    }
 
-            retval += format_comments(val.comments(), fmt.indent_type);
-            retval += format_indent(fmt.indent_type);
-            if(val.is_table() && val.as_table_fmt().fmt == table_format::dotted)
+  private:
+    const unsigned char* iter_;
+    const unsigned char* last_;
+};
+
+inline void encode_binary_date(binary_writer& w, const local_date& d)
+{
+    w.zigzag(d.year);
+    w.byte(d.month);
+    w.byte(d.day);
+}
+inline void encode_binary_time(binary_writer& w, const local_time& t)
+{
+    w.byte(t.hour);
+    w.byte(t.minute);
+    w.byte(t.second);
+    w.varint(t.millisecond);
+    w.varint(t.microsecond);
+    w.varint(t.nanosecond);
+}
+
+inline local_date decode_binary_date(binary_reader& r)
+{
+    const auto y = r.zigzag();
+    const auto m = r.byte();
+    const auto d = r.byte();
+    // the serializer writes the year in 4 digits, as TOML requires.
+    if(y < 0 || 9999 < y ||
+       ! is_valid_local_date(static_cast<int>(y), static_cast<int>(m) + 1, d))
+    {
+        r.fail("invalid date");
+    }
+    return local_date(static_cast<int>(y), static_cast<month_t>(m), d);
+}
+inline local_time decode_binary_time(binary_reader& r)
+{
+    const auto h  = r.byte();
+    const auto m  = r.byte();
+    const auto s  = r.byte();
+    const auto ms = r.varint();
+    const auto us = r.varint();
+    const auto ns = r.varint();
+    if(23 < h || 59 < m || 60 < s || 999 < ms || 999 < us || 999 < ns)
+    {
+        r.fail("invalid time");
+    }
+    return local_time(h, m, s, static_cast<int>(ms), static_cast<int>(us),
+                      static_cast<int>(ns));
+}
+
+template<typename TC>
+void encode_binary_value(binary_writer& w, const basic_value<TC>& v)
+{
+    w.byte(static_cast<std::uint8_t>(v.type()));
+    w.varint(v.comments().size());
+    for(const auto& c : v.comments())
+    {
+        w.string(c);
+    }
+    switch(v.type())
+    {
+        case value_t::boolean:
+        {
+            w.flag(v.as_boolean());
+            break;
+        }
+        case value_t::integer:
+        {
+            const auto& f = v.as_integer_fmt();
+            w.byte(static_cast<std::uint8_t>(f.fmt));
+            w.flag(f.uppercase);
+            w.varint(f.width);
+            w.varint(f.spacer);
+            w.string(f.suffix);
+            w.zigzag(static_cast<std::int64_t>(v.as_integer()));
+            break;
+        }
+        case value_t::floating:
+        {
+            const auto& f = v.as_floating_fmt();
+            w.byte(static_cast<std::uint8_t>(f.fmt));
+            w.varint(f.prec);
+            w.string(f.suffix);
+            w.binary64(static_cast<double>(v.as_floating()));
+            break;
+        }
+        case value_t::string:
+        {
+            const auto& f = v.as_string_fmt();
+            w.byte(static_cast<std::uint8_t>(f.fmt));
+            w.flag(f.start_with_newline);
+            w.string(v.as_string());
+            break;
+        }
+        case value_t::offset_datetime:
+        {
+            const auto& f = v.as_offset_datetime_fmt();
+            w.byte(static_cast<std::uint8_t>(f.delimiter));
+            w.flag(f.has_seconds);
+            w.varint(f.subsecond_precision);
+            const auto& dt = v.as_offset_datetime();
+            encode_binary_date(w, dt.date);
+            encode_binary_time(w, dt.time);
+            w.zigzag(dt.offset.hour);
+            w.zigzag(dt.offset.minute);
+            break;
+        }
+        case value_t::local_datetime:
+        {
+            const auto& f = v.as_local_datetime_fmt();
+            w.byte(static_cast<std::uint8_t>(f.delimiter));
+            w.flag(f.has_seconds);
+            w.varint(f.subsecond_precision);
+            const auto& dt = v.as_local_datetime();
+            encode_binary_date(w, dt.date);
+            encode_binary_time(w, dt.time);
+            break;
+        }
+        case value_t::local_date:
+        {
+            encode_binary_date(w, v.as_local_date());
+            break;
+        }
+        case value_t::local_time:
+        {
+            const auto& f = v.as_local_time_fmt();
+            w.flag(f.has_seconds);
+            w.varint(f.subsecond_precision);
+            encode_binary_time(w, v.as_local_time());
+            break;
+        }
+        case value_t::array:
+        {
+            const auto& f = v.as_array_fmt();
+            w.byte(static_cast<std::uint8_t>(f.fmt));
+            w.byte(static_cast<std::uint8_t>(f.indent_type));
+            w.zigzag(f.body_indent);
+            w.zigzag(f.closing_indent);
+            const auto& a = v.as_array();
+            w.varint(a.size());
+            for(const auto& e : a)
             {
-                retval += (*this)(val);
+                encode_binary_value(w, e);
             }
-            else
+            break;
+        }
+        case value_t::table:
+        {
+            const auto& f = v.as_table_fmt();
+            w.byte(static_cast<std::uint8_t>(f.fmt));
+            w.byte(static_cast<std::uint8_t>(f.indent_type));
+            w.zigzag(f.body_indent);
+            w.zigzag(f.name_indent);
+            w.zigzag(f.closing_indent);
+            const auto& t = v.as_table();
+            w.varint(t.size());
+            for(const auto& kv : t)
             {
-                retval += format_key(key);
-                retval += string_conv<string_type>(" = ");
-                retval += (*this)(val);
-                retval += char_type('\n');
+                w.string(kv.first);
+                encode_binary_value(w, kv.second);
             }
-            this->keys_.pop_back();
+            break;
         }
-        this->current_indent_ -= fmt.body_indent;
+        default: // empty
+        {
+            break;
+        }
+    }
+}
 
-        if( ! retval.empty())
+// the serializer writes strings, keys and comments as they are, so anything
+// that is not UTF-8 would make the output invalid.
+template<typename String>
+bool is_binary_utf8(const String& str) noexcept
+{
+    const auto in = [](const unsigned char c, const unsigned char lo,
+                       const unsigned char hi) noexcept {return lo <= c && c <= hi;};
+
+    const auto* p    = reinterpret_cast<const unsigned char*>(str.data());
+    const auto* last = p + str.size();
+    while(p != last)
+    {
+        const auto rest = static_cast<std::size_t>(last - p);
+        if(p[0] < 0x80)
         {
-            retval += char_type('\n'); // for readability, add empty line between tables
+            p += 1;
         }
-        for(const auto& kv : t)
+        else if(in(p[0], 0xC2, 0xDF) && 2 <= rest && in(p[1], 0x80, 0xBF))
         {
-            if( ! format_later(kv.second))
-            {
-                continue;
-            }
-            // must be a [multiline.table] or [[multiline.array.of.tables]].
-            // comments will be generated inside it.
-            this->keys_.push_back(kv.first);
-            retval += (*this)(kv.second);
-            this->keys_.pop_back();
+            p += 2;
         }
-        return retval;
-    } // }}}
-
-    string_type format_inline_table(const table_type& t, const table_format_info&) // {{{
-    {
-        // comments are ignored because we cannot write without newline
-        string_type retval;
-        retval += char_type('{');
-        for(const auto& kv : t)
+        else if(3 <= rest && in(p[2], 0x80, 0xBF) &&
+                ((p[0] == 0xE0 && in(p[1], 0xA0, 0xBF)) ||
+                 (in(p[0], 0xE1, 0xEC) && in(p[1], 0x80, 0xBF)) ||
+                 (p[0] == 0xED && in(p[1], 0x80, 0x9F)) ||
+                 (in(p[0], 0xEE, 0xEF) && in(p[1], 0x80, 0xBF))))
         {
-            this->force_inline_ = true;
-            retval += this->format_key(kv.first);
-            retval += string_conv<string_type>(" = ");
-            retval += (*this)(kv.second);
-            retval += string_conv<string_type>(", ");
+            p += 3;
         }
-        if( ! t.empty())
+        else if(4 <= rest && in(p[2], 0x80, 0xBF) && in(p[3], 0x80, 0xBF) &&
+                ((p[0] == 0xF0 && in(p[1], 0x90, 0xBF)) ||
+                 (in(p[0], 0xF1, 0xF3) && in(p[1], 0x80, 0xBF)) ||
+                 (p[0] == 0xF4 && in(p[1], 0x80, 0x8F))))
         {
-            retval.pop_back(); // ' '
-            retval.pop_back(); // ','
+            p += 4;
         }
-        retval += char_type('}');
-        this->force_inline_ = false;
-        return retval;
-    } // }}}
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
 
-    string_type format_ml_inline_table(const table_type& t, const table_format_info& fmt) // {{{
+// a comment is written after a `#` (added unless it starts with one) and
+// ends at the end of the line. TOML v1.1.0 allows the other control chars.
+inline bool is_binary_comment(const std::string& c) noexcept
+{
+    for(std::size_t i=0; i<c.size(); ++i)
     {
-        string_type retval;
-        retval += string_conv<string_type>("{\n");
-        this->current_indent_ += fmt.body_indent;
-        for(const auto& kv : t)
+        const auto x = static_cast<unsigned char>(c[i]);
+        if(x == 0x00 || (0x0A <= x && x <= 0x0D))
         {
-            this->force_inline_ = true;
-            retval += format_comments(kv.second.comments(), fmt.indent_type);
-            retval += format_indent(fmt.indent_type);
-            retval += kv.first;
-            retval += string_conv<string_type>(" = ");
-
-            this->force_inline_ = true;
-            retval += (*this)(kv.second);
+            // format_comments does not add another newline after this one.
+            if( ! (x == 0x0A && i + 1 == c.size()))
+            {
+                return false;
+            }
+        }
+    }
+    return is_binary_utf8(c);
+}
 
-            retval += string_conv<string_type>(",\n");
+// whether a string written as is, e.g. in a literal string, would contain
+// a control char that TOML does not allow there. `allow_newline` accepts
+// LF and CRLF, as in multiline strings.
+template<typename String>
+bool has_binary_control_char(const String& s, const bool allow_newline) noexcept
+{
+    for(std::size_t i=0; i<s.size(); ++i)
+    {
+        const auto x = static_cast<unsigned char>(s[i]);
+        if(x == 0x09 || (0x20 <= x && x != 0x7F))
+        {
+            continue;
         }
-        if( ! t.empty())
+        if(allow_newline && (x == 0x0A ||
+                    (x == 0x0D && i + 1 < s.size() && s[i+1] == '\n')))
         {
-            retval.pop_back(); // '\n'
-            retval.pop_back(); // ','
+            continue;
         }
-        this->current_indent_ -= fmt.body_indent;
-        this->force_inline_ = false;
+        return true;
+    }
+    return false;
+}
 
-        this->current_indent_ += fmt.closing_indent;
-        retval += format_indent(fmt.indent_type);
-        this->current_indent_ -= fmt.closing_indent;
+// a suffix is written after `_` when spec::ext_num_suffix is on. it has to
+// start with a non-digit and must not have consecutive or trailing `_`.
+inline bool is_binary_suffix(const std::string& suffix)
+{
+    if(suffix.empty())
+    {
+        return true;
+    }
+    auto loc = make_temporary_location("_" + suffix);
+    return syntax::num_suffix(spec::default_version()).scan(loc).is_ok() && loc.eof();
+}
 
-        retval += char_type('}');
-        return retval;
-    } // }}}
+template<typename T>
+std::size_t binary_decimal_digits(T x) noexcept
+{
+    std::size_t n = 1;
+    while(x <= -10 || 10 <= x)
+    {
+        x /= 10;
+        n += 1;
+    }
+    return n;
+}
 
-    string_type format_dotted_table(const table_type& t, const table_format_info& fmt, // {{{
-            const source_location&, std::vector<string_type>& keys)
+// a literal string cannot escape anything, and a multiline basic string does
+// not escape `"`. strings that those cannot hold fall back to the basic forms.
+template<typename String>
+void fix_binary_string_format(const String& s, string_format_info& f)
+{
+    const auto contains = [&s](const char* needle) {
+        const auto n = std::char_traits<char>::length(needle);
+        return std::search(s.begin(), s.end(), needle, needle + n) != s.end();
+    };
+    if(f.fmt == string_format::literal &&
+       (contains("'") || has_binary_control_char(s, false)))
     {
-        // lets say we have: `{"a": {"b": {"c": {"d": "foo", "e": "bar"} } }`
-        // and `a` and `b` are `dotted`.
-        //
-        // - in case if `c` is `oneline`:
-        // ```toml
-        // a.b.c = {d = "foo", e = "bar"}
-        // ```
-        //
-        // - in case if and `c` is `dotted`:
-        // ```toml
-        // a.b.c.d = "foo"
-        // a.b.c.e = "bar"
-        // ```
+        f.fmt = string_format::basic;
+    }
+    else if(f.fmt == string_format::multiline_literal &&
+            (contains("'''") || has_binary_control_char(s, true)))
+    {
+        f.fmt = string_format::multiline_basic;
+    }
+    if(f.fmt == string_format::multiline_basic && contains("\"\"\""))
+    {
+        f.fmt = string_format::basic;
+    }
+    // a newline right after the opening delimiter is not a part of the value.
+    if((f.fmt == string_format::multiline_basic ||
+        f.fmt == string_format::multiline_literal) && ! s.empty() &&
+       (s[0] == '\n' || (s[0] == '\r' && 2 <= s.size() && s[1] == '\n')))
+    {
+        f.start_with_newline = true;
+    }
+}
 
-        string_type retval;
+// the serializer relies on the formats being those the parser produces. an
+// implicit table, i.e. one without its own header, can only hold tables
+// written with a header and arrays of tables.
+template<typename TC>
+bool can_be_implicit(const typename basic_value<TC>::table_type& t)
+{
+    for(const auto& kv : t)
+    {
+        const auto& v = kv.second;
+        if(v.is_table())
+        {
+            if(v.as_table_fmt().fmt != table_format::multiline &&
+               v.as_table_fmt().fmt != table_format::implicit)
+            {
+                return false;
+            }
+        }
+        else if(v.is_array_of_tables() &&
+                (v.as_array_fmt().fmt == array_format::array_of_tables ||
+                 (v.as_array_fmt().fmt == array_format::default_format &&
+                  v.comments().empty())))
+        {
+            for(const auto& e : v.as_array())
+            {
+                if(e.as_table_fmt().fmt != table_format::multiline)
+                {
+                    return false;
+                }
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename TC>
+basic_value<TC> decode_binary_value(binary_reader& r, const std::size_t depth)
+{
+    using value_type = basic_value<TC>;
+    using string_type = typename value_type::string_type;
+    using key_type    = typename value_type::key_type;
 
-        for(const auto& kv : t)
+    const auto tag = r.byte();
+    if(static_cast<std::uint8_t>(value_t::table) < tag)
+    {
+        r.fail("unknown value type");
+    }
+    if((tag == static_cast<std::uint8_t>(value_t::array) ||
+        tag == static_cast<std::uint8_t>(value_t::table)) && binary_max_depth <= depth)
+    {
+        r.fail("too deeply nested");
+    }
+    std::vector<std::string> com(r.count());
+    for(auto& c : com)
+    {
+        c = r.string<std::string>();
+        if( ! is_binary_comment(c))
         {
-            const auto& key = kv.first;
-            const auto& val = kv.second;
-
-            keys.push_back(key);
+            r.fail("invalid comment");
+        }
+    }
 
-            // format recursive dotted table?
-            if (val.is_table() &&
-                val.as_table_fmt().fmt != table_format::oneline &&
-                val.as_table_fmt().fmt != table_format::multiline_oneline)
+    switch(static_cast<value_t>(tag))
+    {
+        case value_t::boolean:
+        {
+            const bool b = r.flag();
+            return value_type(b, boolean_format_info{}, std::move(com));
+        }
+        case value_t::integer:
+        {
+            integer_format_info f;
+            f.fmt       = r.enumeration(integer_format::hex);
+            f.uppercase = r.flag();
+            f.width     = static_cast<std::size_t>(r.varint());
+            f.spacer    = static_cast<std::size_t>(r.varint());
+            f.suffix    = r.string<std::string>();
+            const auto x = static_cast<typename value_type::integer_type>(r.zigzag());
+            if(f.fmt != integer_format::dec && x < 0)
             {
-                retval += this->format_dotted_table(val.as_table(), val.as_table_fmt(), val.location(), keys);
+                f.fmt = integer_format::dec;
             }
-            else // non-table or inline tables. format normally
+            if(f.fmt == integer_format::dec)
             {
-                retval += format_comments(val.comments(), fmt.indent_type);
-                retval += format_indent(fmt.indent_type);
-                retval += format_keys(keys).value();
-                retval += string_conv<string_type>(" = ");
-                this->force_inline_ = true; // sub-table must be inlined
-                retval += (*this)(val);
-                retval += char_type('\n');
-                this->force_inline_ = false;
+                // the parser counts the digits and the sign. anything wider
+                // only pads with spaces.
+                f.width = (std::min)(f.width, binary_decimal_digits(x) + 1);
             }
-            keys.pop_back();
+            else if(f.fmt == integer_format::bin)
+            {
+                f.width = (std::max)(f.width, std::size_t(1)); // 0 writes no digit
+            }
+            if( ! is_binary_suffix(f.suffix))
+            {
+                f.suffix.clear();
+            }
+            return value_type(x, std::move(f), std::move(com));
         }
-        return retval;
-    } // }}}
-
-    string_type format_key(const key_type& key) // {{{
-    {
-        if(key.empty())
+        case value_t::floating:
         {
-            return string_conv<string_type>("\"\"");
+            floating_format_info f;
+            f.fmt    = r.enumeration(floating_format::hex);
+            f.prec   = static_cast<std::size_t>(r.varint());
+            f.suffix = r.string<std::string>();
+            if( ! is_binary_suffix(f.suffix))
+            {
+                f.suffix.clear();
+            }
+            const auto x = static_cast<typename value_type::floating_type>(r.binary64());
+            return value_type(x, std::move(f), std::move(com));
         }
-
-        // check the key can be a bare (unquoted) key
-        auto loc = detail::make_temporary_location(string_conv<std::string>(key));
-        auto reg = detail::syntax::unquoted_key(this->spec_).scan(loc);
-        if(reg.is_ok() && loc.eof())
+        case value_t::string:
         {
-            return key;
+            string_format_info f;
+            f.fmt                = r.enumeration(string_format::multiline_literal);
+            f.start_with_newline = r.flag();
+            auto s = r.string<string_type>();
+            if( ! is_binary_utf8(s))
+            {
+                r.fail("invalid string");
+            }
+            fix_binary_string_format(s, f);
+            return value_type(std::move(s), f, std::move(com));
         }
-
-        //if it includes special characters, then format it in a "quoted" key.
-        string_type formatted = string_conv<string_type>("\"");
-        for(const char_type c : key)
+        case value_t::offset_datetime:
         {
-            switch(c)
+            offset_datetime_format_info f;
+            f.delimiter           = r.enumeration(datetime_delimiter_kind::space);
+            f.has_seconds         = r.flag();
+            f.subsecond_precision = static_cast<std::size_t>(r.varint());
+            const auto d = decode_binary_date(r);
+            const auto t = decode_binary_time(r);
+            const auto oh = r.zigzag();
+            const auto om = r.zigzag();
+            if(oh < -24 || 24 < oh || om < -59 || 59 < om)
             {
-                case char_type('\\'): {formatted += string_conv<string_type>("\\\\"); break;}
-                case char_type('\"'): {formatted += string_conv<string_type>("\\\""); break;}
-                case char_type('\b'): {formatted += string_conv<string_type>("\\b" ); break;}
-                case char_type('\t'): {formatted += string_conv<string_type>("\\t" ); break;}
-                case char_type('\f'): {formatted += string_conv<string_type>("\\f" ); break;}
-                case char_type('\n'): {formatted += string_conv<string_type>("\\n" ); break;}
-                case char_type('\r'): {formatted += string_conv<string_type>("\\r" ); break;}
-                default  :
-                {
-                    // ASCII ctrl char
-                    if( (char_type(0x00) <= c && c <= char_type(0x08)) ||
-                        (char_type(0x0A) <= c && c <= char_type(0x1F)) ||
-                        c == char_type(0x7F))
-                    {
-                        if(spec_.v1_1_0_add_escape_sequence_x)
-                        {
-                            formatted += string_conv<string_type>("\\x");
-                        }
-                        else
-                        {
-                            formatted += string_conv<string_type>("\\u00");
-                        }
-                        const auto c1 = c / 16;
-                        const auto c2 = c % 16;
-                        formatted += static_cast<char_type>('0' + c1);
-                        if(c2 < 10)
-                        {
-                            formatted += static_cast<char_type>('0' + c2);
-                        }
-                        else // 10 <= c2
-                        {
-                            formatted += static_cast<char_type>('A' + (c2 - 10));
-                        }
-                    }
-                    else
-                    {
-                        formatted += c;
-                    }
-                    break;
-                }
+                r.fail("invalid time offset");
             }
+            const time_offset o(static_cast<int>(oh), static_cast<int>(om));
+            return value_type(offset_datetime(d, t, o), f, std::move(com));
         }
-        formatted += string_conv<string_type>("\"");
-        return formatted;
-    } // }}}
-    cxx::optional<string_type> format_keys(const std::vector<key_type>& keys) // {{{
-    {
-        if(keys.empty())
+        case value_t::local_datetime:
         {
-            return cxx::make_nullopt();
+            local_datetime_format_info f;
+            f.delimiter           = r.enumeration(datetime_delimiter_kind::space);
+            f.has_seconds         = r.flag();
+            f.subsecond_precision = static_cast<std::size_t>(r.varint());
+            const auto d = decode_binary_date(r);
+            const auto t = decode_binary_time(r);
+            return value_type(local_datetime(d, t), f, std::move(com));
         }
-
-        string_type formatted;
-        for(const auto& ky : keys)
+        case value_t::local_date:
         {
-            formatted += format_key(ky);
-            formatted += char_type('.');
+            return value_type(decode_binary_date(r), local_date_format_info{},
+                              std::move(com));
         }
-        formatted.pop_back(); // remove the last dot '.'
-        return formatted;
-    } // }}}
-
-    string_type format_comments(const discard_comments&, const indent_char) const // {{{
-    {
-        return string_conv<string_type>("");
-    } // }}}
-    string_type format_comments(const preserve_comments& comments, const indent_char indent_type) const // {{{
-    {
-        string_type retval;
-        for(const auto& c : comments)
+        case value_t::local_time:
         {
-            if(c.empty()) {continue;}
-            retval += format_indent(indent_type);
-            if(c.front() != '#') {retval += char_type('#');}
-            retval += string_conv<string_type>(c);
-            if(c.back() != '\n') {retval += char_type('\n');}
+            local_time_format_info f;
+            f.has_seconds         = r.flag();
+            f.subsecond_precision = static_cast<std::size_t>(r.varint());
+            return value_type(decode_binary_time(r), f, std::move(com));
         }
-        return retval;
-    } // }}}
-
-    string_type format_indent(const indent_char indent_type) const // {{{
-    {
-        const auto indent = static_cast<std::size_t>((std::max)(0, this->current_indent_));
-        if(indent_type == indent_char::space)
+        case value_t::array:
         {
-            return string_conv<string_type>(make_string(indent, ' '));
+            array_format_info f;
+            f.fmt            = r.enumeration(array_format::array_of_tables);
+            f.indent_type    = r.enumeration(indent_char::none);
+            f.body_indent    = static_cast<std::int32_t>(r.zigzag());
+            f.closing_indent = static_cast<std::int32_t>(r.zigzag());
+
+            typename value_type::array_type a;
+            const auto n = r.count();
+            a.reserve(n);
+            for(std::size_t i=0; i<n; ++i)
+            {
+                a.push_back(decode_binary_value<TC>(r, depth + 1));
+            }
+            // formats that the serializer cannot write fall back to those
+            // that it can, rather than failing: they do not change the value.
+            if(f.fmt == array_format::array_of_tables &&
+               ! std::all_of(a.begin(), a.end(), [](const value_type& e) {return e.is_table();}))
+            {
+                f.fmt = array_format::default_format;
+            }
+            return value_type(std::move(a), f, std::move(com));
         }
-        else if(indent_type == indent_char::tab)
+        case value_t::table:
         {
-            return string_conv<string_type>(make_string(indent, '\t'));
+            table_format_info f;
+            f.fmt            = r.enumeration(table_format::implicit);
+            f.indent_type    = r.enumeration(indent_char::none);
+            f.body_indent    = static_cast<std::int32_t>(r.zigzag());
+            f.name_indent    = static_cast<std::int32_t>(r.zigzag());
+            f.closing_indent = static_cast<std::int32_t>(r.zigzag());
+
+            typename value_type::table_type t;
+            const auto n = r.count();
+            t.reserve(n);
+            for(std::size_t i=0; i<n; ++i)
+            {
+                auto k = r.string<key_type>();
+                if( ! is_binary_utf8(k))
+                {
+                    r.fail("invalid key");
+                }
+                if(t.count(k) != 0)
+                {
+                    r.fail("duplicate key");
+                }
+                auto x = decode_binary_value<TC>(r, depth + 1);
+                t.emplace(std::move(k), std::move(x));
+            }
+            if(f.fmt == table_format::implicit && ! can_be_implicit<TC>(t))
+            {
+                f.fmt = table_format::multiline;
+            }
+            else if(depth == 0 && f.fmt != table_format::implicit)
+            {
+                // the root has no key to write an inline or dotted table with.
+                f.fmt = table_format::multiline;
+            }
+            else if(f.fmt == table_format::dotted && t.empty())
+            {
+                // a dotted table needs at least one key-value pair.
+                f.fmt = table_format::oneline;
+            }
+            return value_type(std::move(t), f, std::move(com));
         }
-        else
+        default: // empty
         {
-            return string_type{};
+            value_type v;
+            v.comments() = typename value_type::comment_type(std::move(com));
+            return v;
         }
-    } // }}}
-
-    std::locale set_locale(std::ostream& os) const
-    {
-        return os.imbue(std::locale::classic());
     }
+}
 
-  private:
-
-    spec spec_;
-    bool force_inline_; // table inside an array without fmt specification
-    std::int32_t current_indent_;
-    std::vector<key_type> keys_;
-};
 } // detail
 
+// ----------------------------------------------------------------------------
+// encode_binary
+
 template<typename TC>
-typename basic_value<TC>::string_type
-format(const basic_value<TC>& v, const spec s = spec::default_version())
-{
-    detail::serializer<TC> ser(s);
-    return ser(v);
-}
-template<typename TC>
-typename basic_value<TC>::string_type
-format(const typename basic_value<TC>::key_type& k,
-       const basic_value<TC>& v,
-       const spec s = spec::default_version())
+std::vector<unsigned char> encode_binary(const basic_value<TC>& v)
 {
-    detail::serializer<TC> ser(s);
-    return ser(k, v);
+    std::vector<unsigned char> buf{'T', '1', '1', 'B', detail::binary_format_version};
+    detail::binary_writer w(buf);
+    detail::encode_binary_value(w, v);
+    return buf;
 }
-template<typename TC>
-typename basic_value<TC>::string_type
-format(const std::vector<typename basic_value<TC>::key_type>& ks,
-       const basic_value<TC>& v,
-       const spec s = spec::default_version())
+
+// ----------------------------------------------------------------------------
+// decode_binary
+
+template<typename TC = type_config>
+result<basic_value<TC>, std::string>
+try_decode_binary(const unsigned char* first, const std::size_t size)
 {
-    detail::serializer<TC> ser(s);
-    return ser(ks, v);
+    if(size < 5 || ! detail::is_binary_magic(first))
+    {
+        return err(std::string("toml::decode_binary: not a binary TOML document"));
+    }
+    if(first[4] != detail::binary_format_version)
+    {
+        return err("toml::decode_binary: unsupported format version " +
+                   std::to_string(static_cast<int>(first[4])) + ", expected " +
+                   std::to_string(static_cast<int>(detail::binary_format_version)));
+    }
+    try
+    {
+        detail::binary_reader r(first + 5, first + size);
+        auto v = detail::decode_binary_value<TC>(r, 0);
+        if( ! r.eof())
+        {
+            return err(std::string("toml::decode_binary: trailing data after the document"));
+        }
+        return ok(std::move(v));
+    }
+    catch(const binary_format_error& e)
+    {
+        return err(std::string(e.what()));
+    }
 }
 
-template<typename TC>
-std::ostream& operator<<(std::ostream& os, const basic_value<TC>& v)
+template<typename TC = type_config>
+basic_value<TC>
+decode_binary(const unsigned char* first, const std::size_t size)
 {
-    os << format(v);
-    return os;
+    auto res = try_decode_binary<TC>(first, size);
+    if(res.is_ok())
+    {
+        return std::move(res.unwrap());
+    }
+    throw binary_format_error(std::move(res.unwrap_err()));
 }
 
-} // toml
-
-#if defined(TOML11_COMPILE_SOURCES)
-namespace toml
+template<typename TC = type_config>
+basic_value<TC> decode_binary(const std::vector<unsigned char>& buf)
 {
-struct type_config;
-struct ordered_type_config;
-
-extern template typename basic_value<type_config>::string_type
-format<type_config>(const basic_value<type_config>&, const spec);
-
-extern template typename basic_value<type_config>::string_type
-format<type_config>(const typename basic_value<type_config>::key_type& k,
-                    const basic_value<type_config>& v, const spec);
-
-extern template typename basic_value<type_config>::string_type
-format<type_config>(const std::vector<typename basic_value<type_config>::key_type>& ks,
-                    const basic_value<type_config>& v, const spec s);
-
-extern template typename basic_value<type_config>::string_type
-format<ordered_type_config>(const basic_value<ordered_type_config>&, const spec);
-
-extern template typename basic_value<type_config>::string_type
-format<ordered_type_config>(const typename basic_value<ordered_type_config>::key_type& k,
-                            const basic_value<ordered_type_config>& v, const spec);
-
-extern template typename basic_value<type_config>::string_type
-format<ordered_type_config>(const std::vector<typename basic_value<ordered_type_config>::key_type>& ks,
-                            const basic_value<ordered_type_config>& v, const spec s);
+    return decode_binary<TC>(buf.data(), buf.size());
+}
 
-namespace detail
-{
-extern template class serializer<::toml::type_config>;
-extern template class serializer<::toml::ordered_type_config>;
-} // detail
 } // toml
-#endif // TOML11_COMPILE_SOURCES
-
-
-#endif // TOML11_SERIALIZER_HPP
+#endif // TOML11_BINARY_HPP
 #ifndef TOML11_TOML_HPP
 #define TOML11_TOML_HPP
 
@@ -1,4 +1,6 @@
-from pytoml11 import Array, Boolean, Integer, String
+import pytest
+
+from pytoml11 import Array, Boolean, Integer, String, Table
 
 
 def test_init_array():
@@ -120,3 +122,55 @@ def test_array_contains():
     assert String("world") not in array
     assert Array([]) not in array
     assert Array([Integer(2)]) not in array
+
+
+def test_array_children_survive_structural_changes():
+    array = Array([Table({"v": Integer(i)}) for i in range(3)])
+    first = array[0]["v"]
+    last = array[2]["v"]
+
+    for i in range(3, 100):
+        array.append(Table({"v": Integer(i)}))
+    array.insert(0, Integer(-1))
+    assert (first.value, last.value) == (0, 2)
+
+    array.pop(0)
+    array.pop(1)
+    assert (first.value, last.value) == (0, 2)
+    assert array[1]["v"] is last
+
+
+def test_array_nested_children_follow_shifts():
+    array = Array([Array([Table({"v": Integer(i)})]) for i in range(5)])
+    deep = [array[i][0]["v"] for i in range(5)]
+
+    array.insert(0, Integer(-1))
+    array.insert(3, Integer(-2))
+    popped = array.pop(1)
+
+    assert popped.owned is False
+    assert popped[0]["v"] is deep[0]
+    assert [item.value for item in deep] == [0, 1, 2, 3, 4]
+    assert array[1][0]["v"] is deep[1]
+    assert array[3][0]["v"] is deep[2]
+    assert array[5][0]["v"] is deep[4]
+
+
+def test_array_rejects_inserting_itself():
+    array = Array([Integer(1)])
+    with pytest.raises(ValueError):
+        array.append(array)
+    with pytest.raises(ValueError):
+        array.insert(0, array)
+    with pytest.raises(ValueError):
+        array.extend([array])
+    assert len(array) == 1
+    assert array[0].value == 1
+
+
+def test_array_rejects_inserting_into_descendant():
+    array = Array([Array([Integer(1)])])
+    with pytest.raises(ValueError):
+        array[0].append(array)
+    assert array.owned is False
+    assert len(array[0]) == 1
@@ -0,0 +1,47 @@
+import asyncio
+from pathlib import Path
+
+import pytest
+
+from pytoml11 import Table, TomlError, dump_async, dumps, load_async, loads, loads_async
+
+
+def test_load_async(tmp_path: Path):
+    path = tmp_path / "config.toml"
+    path.write_text('name = "pytoml11"\n[server]\nport = 8080\n')
+
+    table = asyncio.run(load_async(path))
+    assert isinstance(table, Table)
+    assert table["server"]["port"].value == 8080
+
+
+@pytest.mark.parametrize("data", ["a = 1\nb = [1, 2]\n", b"a = 1\nb = [1, 2]\n"])
+def test_loads_async(data):
+    assert dumps(asyncio.run(loads_async(data))) == dumps(loads("a = 1\nb = [1, 2]\n"))
+
+
+def test_dump_async(tmp_path: Path):
+    path = tmp_path / "config.toml"
+    table = loads("a = 1\n[b]\nc = 'd'\n")
+
+    asyncio.run(dump_async(table, path))
+    assert path.read_text() == dumps(table)
+
+
+def test_load_async_error(tmp_path: Path):
+    with pytest.raises(TomlError):
+        asyncio.run(loads_async("a = \n"))
+    with pytest.raises(TomlError):
+        asyncio.run(load_async(tmp_path / "missing.toml"))
+
+
+def test_async_concurrent():
+    async def main():
+        return await asyncio.gather(*(loads_async(f"index = {i}\n") for i in range(50)))
+
+    assert [t["index"].value for t in asyncio.run(main())] == list(range(50))
+
+
+def test_async_requires_running_loop():
+    with pytest.raises(RuntimeError):
+        loads_async("a = 1\n")
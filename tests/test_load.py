@@ -0,0 +1,512 @@
+import io
+import os
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+
+import pytest
+
+from pytoml11 import (
+    Integer,
+    Table,
+    TomlError,
+    cache_info,
+    clear_cache,
+    dump_binary,
+    dumps,
+    load,
+    load_binary,
+    load_many,
+    loads,
+    set_cache_limit,
+)
+
+
+def test_load_path(tmp_path: Path):
+    path = tmp_path / "config.toml"
+    path.write_text('name = "pytoml11"\n[server]\nport = 8080\n')
+
+    table = load(path)
+    assert isinstance(table, Table)
+    assert table["name"].value == "pytoml11"
+    assert table["server"]["port"].value == 8080
+
+
+def test_load_str(tmp_path: Path):
+    path = tmp_path / "config.toml"
+    path.write_text("a = 1\n")
+
+    assert load(str(path))["a"].value == 1
+
+
+def test_load_without_trailing_newline(tmp_path: Path):
+    path = tmp_path / "config.toml"
+    path.write_text("a = 1")
+
+    assert load(path)["a"].value == 1
+
+
+def test_load_empty_file(tmp_path: Path):
+    path = tmp_path / "config.toml"
+    path.write_text("")
+
+    assert len(load(path)) == 0
+
+
+def test_load_matches_loads(tmp_path: Path):
+    text = '# top\n[a]\nb = [1, 2.5, "c"]  # array\n\n[[d]]\ne = 1979-05-27\n'
+    path = tmp_path / "config.toml"
+    path.write_text(text)
+
+    assert dumps(load(path)) == dumps(loads(text))
+
+
+def test_load_value_outlives_document(tmp_path: Path):
+    path = tmp_path / "config.toml"
+    path.write_text("[a]\nb = 1\n")
+
+    inner = load(path)["a"]
+    path.unlink()
+    assert inner["b"].value == 1
+
+
+def test_load_value_outlives_truncated_file(tmp_path: Path):
+    text = "# top\n[a]\nb = 1  # one\n"
+    path = tmp_path / "config.toml"
+    path.write_text(text)
+
+    table = load(path)
+    path.write_text("")
+    assert table["a"]["b"].value == 1
+    assert dumps(table) == dumps(loads(text))
+
+
+def test_load_error(tmp_path: Path):
+    path = tmp_path / "config.toml"
+    path.write_text("a = \n")
+
+    with pytest.raises(TomlError):
+        load(path)
+
+
+def test_load_error_on_line_9():
+    text = "".join(f"k{i} = 1\n" for i in range(1, 9)) + "i = \n"
+
+    with pytest.raises(TomlError) as e:
+        loads(text)
+    assert "\n   |\n 9 | i = \n   |     ^-- here" in str(e.value)
+
+
+@pytest.mark.parametrize("wrap", [bytes, bytearray, memoryview])
+def test_loads_buffer(wrap):
+    text = '# top\n[a]\nb = [1, 2.5, "c"]\n'
+    assert dumps(loads(wrap(text.encode()))) == dumps(loads(text))
+
+
+def test_loads_buffer_without_trailing_newline():
+    assert loads(b"a = 1")["a"].value == 1
+
+
+def test_loads_buffer_releases_writable_buffers():
+    data = bytearray(b"[a]\nb = 1\n")
+    inner = loads(data)["a"]
+    data.clear()
+    data.extend(b"[a]\nb = 2\n")
+    assert inner["b"].value == 1
+    assert loads(memoryview(data))["a"]["b"].value == 2
+    data.clear()
+
+
+def test_loads_buffer_error():
+    with pytest.raises(TomlError):
+        loads(b"a = \n")
+    with pytest.raises(TomlError):
+        loads(b"a = \"\xff\"\n")
+
+
+def test_concurrent_loads_and_dumps():
+    text = "".join(f"[section{i}]\nname = \"s{i}\"\nvalues = [1, 2, 3]\n" for i in range(200))
+    table = loads(text)
+
+    def mutate():
+        for i in range(200):
+            table[f"section{i}"]["extra"] = Integer(i)
+            del table[f"section{i}"]["values"]
+
+    with ThreadPoolExecutor(max_workers=4) as pool:
+        writer = pool.submit(mutate)
+        parsed = list(pool.map(loads, [text] * 16))
+        dumped = [pool.submit(dumps, table) for _ in range(16)]
+        writer.result()
+
+    assert all(dumps(t) == dumps(parsed[0]) for t in parsed)
+    for d in dumped:
+        assert loads(d.result())["section0"]["name"].value == "s0"
+    assert "values" not in table["section199"]
+    assert table["section199"]["extra"].value == 199
+
+
+def test_load_many(tmp_path: Path):
+    paths = []
+    for i in range(20):
+        path = tmp_path / f"config{i}.toml"
+        path.write_text(f"index = {i}\n")
+        paths.append(path if i % 2 else str(path))
+
+    tables = load_many(paths, threads=4)
+    assert [t["index"].value for t in tables] == list(range(20))
+    assert all(isinstance(t, Table) for t in tables)
+
+
+def test_load_many_errors_in_place(tmp_path: Path):
+    good = tmp_path / "good.toml"
+    good.write_text("a = 1\n")
+    bad = tmp_path / "bad.toml"
+    bad.write_text("a = \n")
+
+    result = load_many([good, bad, tmp_path / "missing.toml", tmp_path, good])
+    assert result[0]["a"].value == 1
+    assert isinstance(result[1], TomlError)
+    assert isinstance(result[2], TomlError)
+    assert isinstance(result[3], TomlError)
+    assert result[4]["a"].value == 1
+
+
+def test_load_many_empty():
+    assert load_many([]) == []
+
+
+def test_load_many_threads_must_be_positive():
+    with pytest.raises(ValueError):
+        load_many([], threads=0)
+
+
+def test_load_binary_file_object(tmp_path: Path):
+    path = tmp_path / "config.toml"
+    path.write_text('name = "pytoml11"\n[server]\nport = 8080\n')
+
+    with path.open("rb") as f:
+        table = load(f)
+    assert dumps(table) == dumps(load(path))
+
+
+def test_load_text_file_object():
+    table = load(io.StringIO('name = "pytöml11"\nport = 8080'))
+    assert table["name"].value == "pytöml11"
+    assert table["port"].value == 8080
+
+
+def test_load_file_object_in_small_chunks():
+    class Trickle(io.RawIOBase):
+        def __init__(self, data):
+            self.data = data
+
+        def readable(self):
+            return True
+
+        def readinto(self, b):
+            n = min(len(b), 3, len(self.data))
+            b[:n] = self.data[:n]
+            self.data = self.data[n:]
+            return n
+
+    text = "".join(f"key{i} = {i}\n" for i in range(1000))
+    assert dumps(load(Trickle(text.encode()))) == dumps(loads(text))
+
+
+def test_load_pipe():
+    read_fd, write_fd = os.pipe()
+    with os.fdopen(write_fd, "wb") as w:
+        w.write(b"a = 1\n")
+    with os.fdopen(read_fd, "rb") as r:
+        assert load(r)["a"].value == 1
+
+
+def test_load_file_object_error():
+    with pytest.raises(TomlError, match="<stream>"):
+        load(io.BytesIO(b"a = \n"))
+
+
+def test_load_rejects_non_file():
+    with pytest.raises(TypeError):
+        load(42)
+
+
+PYPROJECT = '''\
+[project]
+name = "shared"
+
+[tool.black]
+line-length = 88
+text = """
+[tool.ourapp]
+"""
+matrix = [
+  [ "a" ],
+]
+
+[tool.ourapp]
+key = "value"
+
+[[tool.ourapp.plugins]]
+name = "p1"
+
+[database]
+url = "db"
+'''
+
+
+def test_load_only(tmp_path: Path):
+    path = tmp_path / "pyproject.toml"
+    path.write_text(PYPROJECT)
+
+    table = load(path, only=["tool.ourapp", "database"])
+    assert list(table.value) == ["tool", "database"]
+    assert list(table["tool"].value) == ["ourapp"]
+    assert table["tool"]["ourapp"]["key"].value == "value"
+    assert table["tool"]["ourapp"]["plugins"][0]["name"].value == "p1"
+    assert table["database"]["url"].value == "db"
+    assert load(str(path), only=["project"])["project"]["name"].value == "shared"
+
+
+def test_load_only_from_file_object(tmp_path: Path):
+    path = tmp_path / "pyproject.toml"
+    path.write_text(PYPROJECT)
+
+    with path.open("rb") as f:
+        table = load(f, only=["tool.ourapp"])
+    assert list(table.value) == ["tool"]
+    assert table["tool"]["ourapp"]["key"].value == "value"
+    assert load(io.StringIO(PYPROJECT), only=["database"])["database"]["url"].value == "db"
+    with pytest.raises(TypeError):
+        load(io.StringIO(PYPROJECT), lazy=True)
+
+
+def test_load_only_dotted_keys(tmp_path: Path):
+    path = tmp_path / "config.toml"
+    path.write_text('a.x = 1\na.y = 2\n[b]\nc."d.e" = 3\nf = 4\n')
+
+    assert dumps(load(path, only=["a.y", 'b.c."d.e"'])) == dumps(loads('a.y = 2\n[b]\nc."d.e" = 3\n'))
+
+
+def test_load_only_keeps_comments_after_skipped_tables(tmp_path: Path):
+    path = tmp_path / "config.toml"
+    path.write_text("[skipped]\na = 1\n\n# comment for wanted\n[wanted]\nx = 1\n")
+
+    expected = dumps(loads("# comment for wanted\n[wanted]\nx = 1\n"))
+    assert dumps(load(path, only=["wanted"])) == expected
+
+
+def test_load_only_skips_invalid_sections(tmp_path: Path):
+    path = tmp_path / "config.toml"
+    path.write_text("[broken]\nx = = 1\n[wanted]\nx = 1\n")
+
+    assert load(path, only=["wanted"])["wanted"]["x"].value == 1
+    with pytest.raises(TomlError):
+        load(path)
+
+
+def test_load_only_rejects_bad_keys(tmp_path: Path):
+    path = tmp_path / "config.toml"
+    path.write_text("a = 1\n")
+
+    with pytest.raises(ValueError):
+        load(path, only=[])
+    with pytest.raises(ValueError):
+        load(path, only=["not a key"])
+
+
+def test_load_lazy(tmp_path: Path):
+    path = tmp_path / "pyproject.toml"
+    path.write_text(PYPROJECT)
+
+    table = load(path, lazy=True)
+    assert len(table) == len(load(path))
+    assert "tool" in table
+    assert table["tool"]["ourapp"]["key"].value == "value"
+    assert table["database"]["url"].value == "db"
+    assert dumps(table) == dumps(load(path))
+
+
+def test_load_lazy_keeps_comments_and_order(tmp_path: Path):
+    path = tmp_path / "config.toml"
+    path.write_text('# top\n\na.x = 1\n# for b\n[b]\ny = 2\n[a.z]\nw = 3\n[[c]]\nv = 4\n')
+
+    table = load(path, lazy=True)
+    assert table["c"][0]["v"].value == 4
+    assert dumps(table) == dumps(load(path))
+    assert table == load(path)
+
+
+def test_load_lazy_reports_errors_when_read(tmp_path: Path):
+    path = tmp_path / "config.toml"
+    path.write_text("[broken]\nx = = 1\n[good]\nx = 1\n")
+
+    table = load(path, lazy=True)
+    assert table["good"]["x"].value == 1
+    with pytest.raises(TomlError):
+        table["broken"]
+    with pytest.raises(ValueError):
+        load(path, lazy=True, only=["good"])
+
+
+def test_load_lazy_ignores_rewritten_file(tmp_path: Path):
+    path = tmp_path / "config.toml"
+    path.write_text("[a]\nx = 1\n[b]\ny = 2\n")
+
+    table = load(path, lazy=True)
+    path.write_text("")
+    assert table["a"]["x"].value == 1
+    path.write_text("[a]\nx = 3\n[b]\ny = 4\n")
+    assert table["b"]["y"].value == 2
+
+
+def test_load_lazy_replaces_unread_sections(tmp_path: Path):
+    path = tmp_path / "config.toml"
+    path.write_text("[a]\nx = 1\n[b]\ny = 2\n[c]\nz = 3\n")
+
+    table = load(path, lazy=True)
+    table["a"] = Integer(5)
+    del table["b"]
+    assert dumps(table) == dumps(loads("a = 5\n[c]\nz = 3\n"))
+
+
+def test_update_with_lazy_values_from_threads(tmp_path: Path):
+    path = tmp_path / "pyproject.toml"
+    path.write_text(PYPROJECT)
+
+    def update(_: int) -> str:
+        table = Table({"other": Integer(1)})
+        table.update({"doc": load(path, lazy=True)})
+        return dumps(table)
+
+    with ThreadPoolExecutor(max_workers=4) as pool:
+        dumped = list(pool.map(update, range(32)))
+
+    assert all(d == dumps(Table({"other": Integer(1), "doc": load(path)})) for d in dumped)
+
+
+def test_dump_binary_round_trip():
+    text = (
+        "# header\n\n"
+        "hex = 0xDEAD_BEEF # trailing\n"
+        "big = -9_223_372_036_854_775_808\n"
+        "f = 6.25e-3\n"
+        "s = 'literal'\n"
+        'ml = """\nline\n"""\n'
+        "when = 1979-05-27 07:32:00.250-08:00\n"
+        "t = 07:32:00.5\n"
+        "inline = { a = 1, b = [1, 2] }\n"
+        "a.dotted = true\n"
+        "[server]\n"
+        "  port = 8080\n"
+        "[[rows]]\n"
+        "x = []\n"
+    )
+    table = loads(text)
+    data = dump_binary(table)
+    assert isinstance(data, bytes)
+
+    for buf in (data, bytearray(data), memoryview(data)):
+        copy = load_binary(buf)
+        assert dumps(copy) == dumps(table)
+        assert copy == table
+    assert load_binary(data)["when"].value == table["when"].value
+    assert dump_binary(load_binary(data)) == data
+    assert dump_binary(obj=load_binary(b=data)) == data
+
+
+def test_dump_binary_lazy(tmp_path: Path):
+    path = tmp_path / "pyproject.toml"
+    path.write_text(PYPROJECT)
+
+    assert dump_binary(load(path, lazy=True)) == dump_binary(load(path))
+
+
+def test_load_binary_rejects_bad_input():
+    data = dump_binary(loads("a = [1, 2, 3]\n"))
+
+    for bad in (b"", b"a = 1\n", data[:-1], data + b"\0", data[:4] + b"\x7f" + data[5:]):
+        with pytest.raises(TomlError):
+            load_binary(bad)
+
+
+def test_load_binary_corrupted_formats():
+    header = dump_binary(loads(""))[:5]
+    # a = [1], with the array marked as an array of tables
+    aot_of_int = header + bytes(
+        [10, 0, 0, 0, 0, 0, 0, 1, 1, ord("a"), 9, 0, 3, 0, 0, 0, 1, 2, 0, 0, 0, 0, 0, 0, 2]
+    )
+    assert dumps(load_binary(aot_of_int)) == dumps(loads("a = [1]\n"))
+
+    nested = header + bytes([9, 0, 0, 0, 0, 0, 1]) * 100_000 + bytes([9, 0, 0, 0, 0, 0, 0])
+    with pytest.raises(TomlError):
+        load_binary(nested)
+
+
+def test_load_binary_formats_that_cannot_be_written():
+    header = dump_binary(loads(""))[:5]
+
+    def root(key: bytes, value: list[int], fmt: int = 0) -> bytes:
+        return header + bytes([10, 0, fmt, 0, 0, 0, 0, 1, len(key)]) + key + bytes(value)
+
+    # the root as an inline table, and a negative hex integer
+    assert dumps(load_binary(root(b"a", [2, 0, 0, 0, 0, 0, 0, 2], fmt=1))) == dumps(loads("a = 1"))
+    assert load_binary(root(b"a", [2, 0, 3, 0, 0, 0, 0, 1]))["a"].value == -1
+    assert "a = -1" in dumps(load_binary(root(b"a", [2, 0, 3, 0, 0, 0, 0, 1])))
+    # a literal string with a quote, a multiline basic one with three
+    for fmt, s in ((1, b"i's"), (2, b'"""')):
+        table = load_binary(root(b"s", [4, 0, fmt, 0, len(s), *s]))
+        assert loads(dumps(table))["s"].value == s.decode()
+    # a key with a space in a multiline inline table
+    table = load_binary(root(b"t", [10, 0, 3, 0, 0, 0, 0, 1, 3, *b"a b", 2, 0, 0, 0, 0, 0, 0, 2]))
+    assert loads(dumps(table))["t"]["a b"].value == 1
+
+    # a comment with a newline, and a key that is not UTF-8
+    with pytest.raises(TomlError):
+        load_binary(header + bytes([10, 1, 3, *b"x\ny", 0, 0, 0, 0, 0, 0]))
+    with pytest.raises(TomlError):
+        load_binary(root(b"\xff", [2, 0, 0, 0, 0, 0, 0, 2]))
+
+
+@pytest.fixture
+def parse_cache():
+    set_cache_limit(1 << 20)
+    clear_cache()
+    yield
+    set_cache_limit(0)
+    clear_cache()
+
+
+def test_load_cache(tmp_path: Path, parse_cache):
+    path = tmp_path / "config.toml"
+    path.write_text('a = 1\n[t]\nx = "hello"\n')
+
+    first = load(path)
+    second = load(str(path))
+    assert (cache_info().hits, cache_info().misses, cache_info().entries) == (1, 1, 1)
+    assert first == second
+
+    first["a"] = Integer(5)
+    assert load(path)["a"].value == 1
+
+    path.write_text("a = 22\n")
+    assert load(path)["a"].value == 22
+    assert cache_info().misses == 2
+
+
+def test_load_cache_invalidation_and_limit(tmp_path: Path, parse_cache):
+    path = tmp_path / "config.toml"
+    path.write_text("a = 1\n")
+
+    load(path)
+    clear_cache(path)
+    load(path)
+    assert (cache_info().hits, cache_info().misses) == (0, 2)
+
+    set_cache_limit(1)
+    assert cache_info().entries == 0
+    load(path)
+    assert (cache_info().entries, cache_info().bytes) == (0, 0)
+
+    clear_cache()
+    assert (cache_info().hits, cache_info().misses) == (0, 0)
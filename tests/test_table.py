@@ -1,3 +1,5 @@
+import pytest
+
 from pytoml11 import Boolean, Integer, String, Table, dumps
 
 
@@ -177,3 +179,104 @@ def test_table_get_value():
     assert table.get("key").value == 42
     assert table.get("missing_key") is None
     assert table.get("missing_key", Integer(42)).value == 42
+
+
+def test_large_table_lookup_after_delete():
+    table = Table({f"key{i}": Integer(i) for i in range(1000)})
+
+    for i in range(0, 1000, 3):
+        del table[f"key{i}"]
+
+    assert len(table) == 666
+    assert "key0" not in table
+    assert table["key1"].value == 1
+    assert table["key998"].value == 998
+    assert list(table.value.keys()) == [f"key{i}" for i in range(1000) if i % 3]
+
+
+def test_table_children_survive_structural_changes():
+    table = Table({"a": Table({"b": Table({"c": Integer(1)})}), "x": Integer(2)})
+    deep = table["a"]["b"]["c"]
+    x = table["x"]
+    assert deep.value == 1
+
+    for i in range(100):
+        table[f"k{i}"] = Integer(i)
+    table["a"]["b"]["d"] = String("new")
+    del table["k0"]
+    table["x"] = Integer(3)
+
+    assert deep.value == 1
+    assert table["a"]["b"]["d"].value == "new"
+    assert x.value == 2
+    assert x.owned is False
+    assert table["x"].value == 3
+
+
+def test_table_setitem_replaces_in_place():
+    table = Table({f"key{i}": Table({"v": Integer(i)}) for i in range(1000)})
+    sibling = table["key501"]["v"]
+    old = table["key500"]
+
+    table["key500"] = Integer(-1)
+
+    assert list(table.value.keys()) == [f"key{i}" for i in range(1000)]
+    assert table["key500"].value == -1
+    assert old.owned is False
+    assert old["v"].value == 500
+    assert sibling.value == 501
+
+
+def test_table_pop_moves_value_out():
+    table = Table({f"key{i}": Table({"v": Integer(i)}) for i in range(100)})
+    later = table["key60"]["v"]
+
+    popped = table.pop("key50")
+    del table["key10"]
+
+    assert popped.owned is False
+    assert popped["v"].value == 50
+    assert later.value == 60
+    assert table["key61"]["v"].value == 61
+    assert list(table.value.keys()) == [f"key{i}" for i in range(100) if i not in (10, 50)]
+
+
+def test_table_subtree_moves_between_documents():
+    source = Table({"sub": Table({f"k{i}": Table({"v": Integer(i)}) for i in range(50)})})
+    target = Table({"other": Integer(0)})
+    sub = source["sub"]
+    leaves = [sub[f"k{i}"]["v"] for i in range(50)]
+
+    moved = source.pop("sub")
+    assert moved is sub
+    assert all(leaf.value == i for i, leaf in enumerate(leaves))
+
+    target["moved"] = moved
+    assert target["moved"] is sub
+    assert target["moved"]["k7"]["v"] is leaves[7]
+    assert all(leaf.value == i for i, leaf in enumerate(leaves))
+
+    target["moved"]["k7"]["v"] = Integer(-7)
+    assert target["moved"]["k7"]["v"].value == -7
+    assert leaves[7].owned is False
+    assert leaves[8].value == 8
+    assert list(source.value.keys()) == []
+    assert target["other"].value == 0
+
+
+def test_table_rejects_inserting_itself():
+    table = Table({"a": Integer(1)})
+    with pytest.raises(ValueError):
+        table["self"] = table
+    with pytest.raises(ValueError):
+        table.update({"self": table})
+    assert list(table.value.keys()) == ["a"]
+    assert dumps(table) == "a = 1\n\n"
+
+
+def test_table_rejects_inserting_into_descendant():
+    root = Table({"child": Table({"grandchild": Table({})})})
+    with pytest.raises(ValueError):
+        root["child"]["grandchild"]["root"] = root
+    assert root.owned is False
+    assert list(root["child"]["grandchild"].value.keys()) == []